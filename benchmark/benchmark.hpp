@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <string_view>
+
+// Run `function` `iterations` times and print the mean duration of one iteration.
+template <class FunctionType>
+double run_benchmark(std::string_view name, std::uint64_t iterations, FunctionType&& function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        function(i);
+    const std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+    const double ns_per_iteration = duration.count() / static_cast<double>(iterations);
+    std::cout << std::format("{:<48} {:>10.2f} ns/op", name, ns_per_iteration) << std::endl;
+    return ns_per_iteration;
+}
+
+// Prevent the compiler from optimizing away a computed value.
+template <class ValueType>
+inline void do_not_optimize(const ValueType& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
@@ -0,0 +1,42 @@
+#include <arba/plug/safe_plugin.hpp>
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+// A plugin with several MB of code: calling its functions in a random order stresses the iTLB.
+
+namespace
+{
+constexpr std::size_t function_count = 8192;
+
+template <std::size_t Index>
+std::uint64_t step(std::uint64_t value)
+{
+    // Pad each function with 512 bytes of code, so the functions are spread over many pages.
+    asm volatile(".fill 512, 1, 0x90");
+    return value * 6364136223846793005ULL + Index;
+}
+
+using step_function = std::uint64_t (*)(std::uint64_t);
+
+template <std::size_t... Indexes>
+constexpr std::array<step_function, sizeof...(Indexes)> make_steps(std::index_sequence<Indexes...>)
+{
+    return { &step<Indexes>... };
+}
+
+const std::array<step_function, function_count> steps = make_steps(std::make_index_sequence<function_count>());
+} // namespace
+
+extern "C" std::uint64_t run_steps(std::uint64_t iterations, std::uint64_t seed)
+{
+    std::uint64_t value = seed;
+    for (std::uint64_t i = 0; i < iterations; ++i)
+        value = steps[(value >> 17) % function_count](value);
+    return value;
+}
+
+ARBA_PLUG_BEGIN_SAFE_PLUGIN_FUNCTION_REGISTER()
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(run_steps)
+ARBA_PLUG_END_SAFE_PLUGIN_FUNCTION_REGISTER()
@@ -0,0 +1,101 @@
+#include "benchmark.hpp"
+
+#include <arba/plug/plugin.hpp>
+
+#include <cstdlib>
+#include <optional>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Count the iTLB misses of the calling thread, if perf events are available.
+class itlb_miss_counter
+{
+public:
+    itlb_miss_counter()
+    {
+#if defined(__linux__)
+        perf_event_attr attributes{};
+        attributes.type = PERF_TYPE_HW_CACHE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_CACHE_ITLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        file_descriptor_ = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+    }
+
+    ~itlb_miss_counter()
+    {
+#if defined(__linux__)
+        if (file_descriptor_ >= 0)
+            close(file_descriptor_);
+#endif
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (file_descriptor_ >= 0)
+        {
+            ioctl(file_descriptor_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(file_descriptor_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    std::optional<std::uint64_t> stop()
+    {
+#if defined(__linux__)
+        std::uint64_t count = 0;
+        if (file_descriptor_ >= 0)
+        {
+            ioctl(file_descriptor_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(file_descriptor_, &count, sizeof(count)) == sizeof(count))
+                return count;
+        }
+#endif
+        return std::nullopt;
+    }
+
+private:
+    int file_descriptor_ = -1;
+};
+
+void run(std::string_view name, std::uint64_t (*run_steps)(std::uint64_t, std::uint64_t))
+{
+    constexpr std::uint64_t call_count = 10'000'000;
+    constexpr std::uint64_t batch_size = 1'000;
+    itlb_miss_counter counter;
+    counter.start();
+    const double ns_per_batch = run_benchmark(std::format("{} ({} calls per op)", name, batch_size),
+                                              call_count / batch_size,
+                                              [&](std::uint64_t i) { do_not_optimize(run_steps(batch_size, i)); });
+    const std::optional<std::uint64_t> itlb_misses = counter.stop();
+    std::cout << std::format("{:<48} {:>10.2f} Mcalls/s", name, 1e3 * batch_size / ns_per_batch) << std::endl;
+    if (itlb_misses)
+        std::cout << std::format("{:<48} {:>10} iTLB misses", name, *itlb_misses) << std::endl;
+    else
+        std::cout << std::format("{:<48} {:>10} iTLB misses", name, "n/a") << std::endl;
+}
+} // namespace
+
+int main()
+{
+    plug::plugin plugin(PLUGIN_PATH);
+    auto run_steps = plugin.find_function_ptr<std::uint64_t (*)(std::uint64_t, std::uint64_t)>("run_steps");
+    run("file backed text", run_steps);
+
+    const std::size_t remapped_bytes = plugin.remap_text_to_huge_pages();
+    std::cout << std::format("{} bytes of text remapped onto huge pages", remapped_bytes) << std::endl;
+    run("huge page backed text", run_steps);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,48 @@
+#include "benchmark.hpp"
+
+#include <arba/plug/out_of_process_plugin.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+int main()
+{
+    constexpr std::uint64_t in_process_iterations = 10'000'000;
+    constexpr std::uint64_t remote_iterations = 100'000;
+    constexpr std::size_t batch_size = 32;
+    using next_value_function = std::uint64_t (*)(std::uint64_t);
+
+    // The helper process is forked first, before the plugin is loaded in the host.
+    plug::out_of_process_plugin remote_plugin(PLUGIN_PATH);
+    plug::remote_function remote_next_value = remote_plugin.find_function<next_value_function>("next_value");
+    plug::plugin plugin(PLUGIN_PATH);
+    next_value_function next_value = plugin.find_function_ptr<next_value_function>("next_value");
+
+    std::uint64_t value = 0;
+    run_benchmark("in-process call", in_process_iterations, [&](std::uint64_t) {
+        value = next_value(value);
+        do_not_optimize(value);
+    });
+    run_benchmark("out-of-process call (round trip)", remote_iterations, [&](std::uint64_t) {
+        value = remote_next_value(value);
+        do_not_optimize(value);
+    });
+
+    // Throughput: batches of calls submitted before waiting for their results.
+    std::vector<plug::pending_call<std::uint64_t>> calls;
+    calls.reserve(batch_size);
+    const double batch_ns = run_benchmark(std::format("out-of-process calls (batches of {})", batch_size),
+                                          remote_iterations / batch_size, [&](std::uint64_t i) {
+                                              for (std::size_t j = 0; j < batch_size; ++j)
+                                                  calls.push_back(remote_next_value.submit(i + j));
+                                              for (plug::pending_call<std::uint64_t>& call : calls)
+                                                  value += call.get();
+                                              calls.clear();
+                                              do_not_optimize(value);
+                                          });
+    std::cout << std::format("{:<48} {:>10.2f} ns/op", "out-of-process call (batched, per call)",
+                             batch_ns / batch_size)
+              << std::endl;
+
+    return EXIT_SUCCESS;
+}
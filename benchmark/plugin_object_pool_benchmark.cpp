@@ -0,0 +1,27 @@
+#include "benchmark.hpp"
+
+#include <arba/plug/plugin.hpp>
+#include <arba/plug/plugin_object_pool.hpp>
+
+#include <workload_interface/workload_interface.hpp>
+
+#include <cstdlib>
+
+int main()
+{
+    constexpr std::uint64_t iterations = 1'000'000;
+    plug::plugin plugin(PLUGIN_PATH);
+
+    run_benchmark("make_unique_instance + destroy", iterations, [&](std::uint64_t i) {
+        std::unique_ptr instance = plugin.make_unique_instance<WorkloadInterface>();
+        do_not_optimize(instance->run(i));
+    });
+
+    plug::plugin_object_pool<WorkloadInterface, plug::plugin> pool(plugin);
+    run_benchmark("plugin_object_pool acquire + release", iterations, [&](std::uint64_t i) {
+        auto instance = pool.acquire();
+        do_not_optimize(instance->run(i));
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+#include "benchmark.hpp"
+
+#include <arba/plug/plugin.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    constexpr std::uint64_t iterations = 10'000'000;
+    using next_value_function = std::uint64_t (*)(std::uint64_t);
+    plug::plugin plugin(PLUGIN_PATH);
+    next_value_function next_value = plugin.find_function_ptr<next_value_function>("next_value");
+    plug::bound_function bound_next_value = plugin.bind_function<next_value_function>("next_value");
+    plug::tracked_function tracked_next_value = plugin.bind_tracked_function<next_value_function>("next_value");
+
+    std::uint64_t value = 0;
+    const double pointer_ns = run_benchmark("function pointer call", iterations, [&](std::uint64_t) {
+        value = next_value(value);
+        do_not_optimize(value);
+    });
+    run_benchmark("bound_function call", iterations, [&](std::uint64_t) {
+        value = bound_next_value(value);
+        do_not_optimize(value);
+    });
+    const double tracked_ns = run_benchmark("tracked_function call", iterations, [&](std::uint64_t) {
+        value = tracked_next_value(value);
+        do_not_optimize(value);
+    });
+    std::cout << std::format("{:<48} {:>10.2f} ns/op", "tracking overhead", tracked_ns - pointer_ns) << std::endl;
+
+    // The same tracked calls, made by several threads at once.
+    const unsigned thread_count = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    std::atomic<double> slowest_ns = 0;
+    for (unsigned i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back([&] {
+            std::uint64_t local_value = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (std::uint64_t j = 0; j < iterations; ++j)
+            {
+                local_value = tracked_next_value(local_value);
+                do_not_optimize(local_value);
+            }
+            const std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+            const double ns = duration.count() / static_cast<double>(iterations);
+            double current = slowest_ns.load();
+            while (ns > current && !slowest_ns.compare_exchange_weak(current, ns))
+                ;
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    std::cout << std::format("{:<48} {:>10.2f} ns/op",
+                             std::format("tracked_function call ({} threads, slowest)", thread_count),
+                             slowest_ns.load())
+              << std::endl;
+
+    return EXIT_SUCCESS;
+}
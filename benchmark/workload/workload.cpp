@@ -0,0 +1,48 @@
+#include <workload_interface/workload_interface.hpp>
+
+#include <arba/plug/safe_plugin.hpp>
+
+#include <array>
+#include <memory>
+#include <numeric>
+
+// A class which is expensive to construct: it fills a lookup table.
+class Workload : public WorkloadInterface
+{
+public:
+    Workload() { std::iota(table_.begin(), table_.end(), std::uint64_t(1)); }
+
+    virtual std::uint64_t run(std::uint64_t input) override
+    {
+        accumulator_ += table_[input % table_.size()];
+        return accumulator_;
+    }
+
+    void reset() { accumulator_ = 0; }
+
+private:
+    std::array<std::uint64_t, 1024> table_;
+    std::uint64_t accumulator_ = 0;
+};
+
+extern "C" std::unique_ptr<WorkloadInterface> make_unique_instance()
+{
+    return std::make_unique<Workload>();
+}
+
+extern "C" void reset_instance(WorkloadInterface& instance)
+{
+    static_cast<Workload&>(instance).reset();
+}
+
+// A cheap function, to measure the cost of a call.
+extern "C" std::uint64_t next_value(std::uint64_t value)
+{
+    return value * 6364136223846793005ULL + 1442695040888963407ULL;
+}
+
+ARBA_PLUG_BEGIN_SAFE_PLUGIN_FUNCTION_REGISTER()
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(make_unique_instance)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(reset_instance)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(next_value)
+ARBA_PLUG_END_SAFE_PLUGIN_FUNCTION_REGISTER()
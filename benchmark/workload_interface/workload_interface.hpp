@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// The class interface used by the benchmarks.
+
+class WorkloadInterface
+{
+public:
+    virtual ~WorkloadInterface() = default;
+    virtual std::uint64_t run(std::uint64_t input) = 0;
+};
@@ -26,12 +26,14 @@ class ArbaPlugRecipe(ConanFile):
     options = {
         "shared": [True, False],
         "fPIC": [True, False],
-        "test": [True, False]
+        "test": [True, False],
+        "instrumentation": [True, False]
     }
     default_options = {
         "shared": True,
         "fPIC": True,
-        "test": False
+        "test": False,
+        "instrumentation": False
     }
 
     # Build
@@ -69,6 +71,7 @@ class ArbaPlugRecipe(ConanFile):
         tc.variables[f"{upper_name}_LIBRARY_TYPE"] = "SHARED" if self.options.shared else "STATIC"
         if self.options.test:
             tc.variables[f"BUILD_{upper_name}_TESTS"] = "TRUE"
+        tc.variables[f"{upper_name}_ENABLE_INSTRUMENTATION"] = "ON" if self.options.instrumentation else "OFF"
         tc.generate()
 
     def build(self):
@@ -91,3 +94,5 @@ class ArbaPlugRecipe(ConanFile):
         if self.settings.build_type == "Debug":
             name += "-d"
         self.cpp_info.libs = [name]
+        if self.options.instrumentation:
+            self.cpp_info.defines = ["ARBA_PLUG_ENABLE_INSTRUMENTATION"]
@@ -0,0 +1,77 @@
+#pragma once
+
+#ifdef ARBA_PLUG_ENABLE_INSTRUMENTATION
+#include "call_stats.hpp"
+#include "plugin_trace.hpp"
+#endif
+
+#include <chrono>
+#include <type_traits>
+#include <utility>
+
+inline namespace arba
+{
+namespace plug
+{
+
+template <typename FunctionSignatureType>
+class bound_function;
+
+/**
+ * @brief The bound_function class is a callable holding a function found in a plugin.
+ * @tparam ReturnType The return type of the function.
+ * @tparam ArgsT... The parameter types of the function.
+ * @details When the library is built with ARBA_PLUG_ENABLE_INSTRUMENTATION, each call is counted and timed in the
+ * symbol_call_stats of the function, and recorded as a "call" trace event while tracing (see start_tracing()).
+ * Otherwise, a bound_function is only a function pointer.
+ */
+template <typename ReturnType, typename... ArgsT>
+class bound_function<ReturnType (*)(ArgsT...)>
+{
+public:
+    using function_pointer_type = ReturnType (*)(ArgsT...);
+
+    bound_function() = default;
+
+#ifdef ARBA_PLUG_ENABLE_INSTRUMENTATION
+    bound_function(function_pointer_type function, symbol_call_stats* stats) : function_(function), stats_(stats) {}
+#else
+    explicit bound_function(function_pointer_type function) : function_(function) {}
+#endif
+
+    inline ReturnType operator()(ArgsT... args) const
+    {
+#ifdef ARBA_PLUG_ENABLE_INSTRUMENTATION
+        struct call_recorder
+        {
+            symbol_call_stats* stats;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            ~call_recorder()
+            {
+                const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+                stats->record(end - start);
+                if (is_tracing()) [[unlikely]]
+                    private_::record_trace_event("call", stats->symbol_name(), stats->plugin_path(), start, end);
+            }
+        };
+        call_recorder recorder{ stats_ };
+#endif
+        return function_(std::forward<ArgsT>(args)...);
+    }
+
+    /**
+     * @brief get The function pointer found in the plugin.
+     */
+    [[nodiscard]] inline function_pointer_type get() const noexcept { return function_; }
+
+    [[nodiscard]] inline explicit operator bool() const noexcept { return function_ != nullptr; }
+
+private:
+    function_pointer_type function_ = nullptr;
+#ifdef ARBA_PLUG_ENABLE_INSTRUMENTATION
+    symbol_call_stats* stats_ = nullptr;
+#endif
+};
+
+} // namespace plug
+} // namespace arba
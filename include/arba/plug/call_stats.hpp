@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The symbol_call_stats_snapshot struct is a copy of the statistics of one plugin function.
+ */
+struct symbol_call_stats_snapshot
+{
+    // Bucket i counts the calls which lasted in [2^i, 2^(i+1)) ns (bucket 0 also counts calls shorter than 1 ns).
+    static constexpr std::size_t histogram_size = 40;
+
+    std::string symbol_name;
+    std::uint64_t call_count = 0;
+    std::chrono::nanoseconds total_duration{ 0 };
+    std::array<std::uint64_t, histogram_size> latency_histogram{};
+
+    /**
+     * @brief mean_duration The mean duration of one call.
+     */
+    [[nodiscard]] std::chrono::nanoseconds mean_duration() const noexcept;
+
+    /**
+     * @brief latency_percentile An upper bound of the given latency percentile, at the histogram precision.
+     * @param ratio The percentile, in [0, 1] (ex: 0.99 for p99).
+     */
+    [[nodiscard]] std::chrono::nanoseconds latency_percentile(double ratio) const noexcept;
+};
+
+/**
+ * @brief The plugin_call_stats_snapshot struct is a copy of the statistics of the functions of one plugin.
+ */
+struct plugin_call_stats_snapshot
+{
+    std::filesystem::path plugin_path;
+    std::vector<symbol_call_stats_snapshot> symbols;
+};
+
+/**
+ * @brief The symbol_call_stats class records the calls of one plugin function.
+ * @details The counters are sharded by thread: each thread writes to its own cache line, with relaxed atomic
+ * operations, so recording a call never takes a lock and rarely shares a cache line with another thread.
+ */
+class symbol_call_stats
+{
+public:
+    static constexpr std::size_t shard_count = 16;
+
+    symbol_call_stats() = default;
+
+    /**
+     * @param plugin_path The generic path of the plugin.
+     * @param symbol_name The name of the function.
+     * @warning The names must live as long as the statistics (they name the calls in the trace, see plugin_trace.hpp).
+     */
+    symbol_call_stats(std::string_view plugin_path, std::string_view symbol_name) noexcept
+        : plugin_path_(plugin_path), symbol_name_(symbol_name)
+    {
+    }
+
+    inline void record(std::chrono::nanoseconds duration) noexcept
+    {
+        const std::uint64_t duration_ns = static_cast<std::uint64_t>(duration.count() > 0 ? duration.count() : 0);
+        shard_& shard = shards_[local_shard_index_()];
+        shard.call_count.fetch_add(1, std::memory_order_relaxed);
+        shard.total_duration_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+        shard.latency_histogram[histogram_index_(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief snapshot Sum the shards.
+     * @details The snapshot is not atomic: calls recorded concurrently may be partially counted.
+     */
+    [[nodiscard]] symbol_call_stats_snapshot snapshot(std::string_view symbol_name) const;
+
+    void reset() noexcept;
+
+    [[nodiscard]] inline std::string_view plugin_path() const noexcept { return plugin_path_; }
+    [[nodiscard]] inline std::string_view symbol_name() const noexcept { return symbol_name_; }
+
+private:
+    struct alignas(64) shard_
+    {
+        std::atomic<std::uint64_t> call_count = 0;
+        std::atomic<std::uint64_t> total_duration_ns = 0;
+        std::array<std::atomic<std::uint64_t>, symbol_call_stats_snapshot::histogram_size> latency_histogram{};
+    };
+
+    static std::size_t local_shard_index_() noexcept;
+
+    static constexpr std::size_t histogram_index_(std::uint64_t duration_ns) noexcept
+    {
+        const std::size_t index = duration_ns == 0 ? 0 : static_cast<std::size_t>(std::bit_width(duration_ns) - 1);
+        return index < symbol_call_stats_snapshot::histogram_size ? index
+                                                                  : symbol_call_stats_snapshot::histogram_size - 1;
+    }
+
+    std::array<shard_, shard_count> shards_;
+    std::string_view plugin_path_;
+    std::string_view symbol_name_;
+};
+
+/**
+ * @brief register_symbol_call_stats Get the statistics of a plugin function, creating them if needed.
+ * @param plugin_path The path of the plugin.
+ * @param symbol_name The name of the function.
+ * @return The statistics, which stay valid until the end of the program (they survive unloads and reloads of the
+ * plugin, so the calls of all the loads of a plugin are accumulated).
+ */
+symbol_call_stats& register_symbol_call_stats(const std::filesystem::path& plugin_path, std::string_view symbol_name);
+
+/**
+ * @brief snapshot_call_stats Take a snapshot of the statistics of all the instrumented functions of all plugins.
+ * @return An empty vector if the library is built without ARBA_PLUG_ENABLE_INSTRUMENTATION.
+ */
+[[nodiscard]] std::vector<plugin_call_stats_snapshot> snapshot_call_stats();
+
+/**
+ * @brief reset_call_stats Reset the statistics of all the instrumented functions of all plugins.
+ */
+void reset_call_stats();
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "exception.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+/**
+ * @brief The call_thread_slot struct identifies the counters of a thread in the call trackers.
+ */
+struct call_thread_slot
+{
+    static constexpr std::size_t no_index = std::numeric_limits<std::size_t>::max();
+
+    // Unique among the living threads.
+    std::size_t index = no_index;
+    // True if heavy_barrier() makes the light barriers of the other threads only compiler barriers.
+    bool asymmetric_barrier = false;
+};
+
+/**
+ * @brief acquire_call_thread_slot Give the calling thread a slot unused by the other threads, released when the
+ * thread exits.
+ */
+call_thread_slot acquire_call_thread_slot();
+
+inline const call_thread_slot& local_call_thread_slot()
+{
+    thread_local call_thread_slot slot;
+    if (slot.index == call_thread_slot::no_index) [[unlikely]]
+        slot = acquire_call_thread_slot();
+    return slot;
+}
+
+/**
+ * @brief heavy_barrier Act as a full memory barrier executed by all the threads of the process (membarrier() on Linux,
+ * FlushProcessWriteBuffers() on Windows).
+ */
+void heavy_barrier() noexcept;
+} // namespace private_
+
+/**
+ * @brief The call_tracker class counts the calls in flight in a loaded plugin, so that the plugin is not closed while
+ * one of its functions is executed.
+ * @details Each thread counts its calls in its own slot, with plain loads and stores: entering a call only costs a
+ * compiler barrier, and the full barrier is paid by close(), for all the threads at once. The threads beyond
+ * slot_count share an overflow counter, updated with atomic read-modify-write operations.
+ * When the plugin is unloaded, the tracker is closed: the new calls are refused, and the plugin is closed once the
+ * calls in flight are finished, and its release callbacks are called.
+ */
+class call_tracker
+{
+public:
+    static constexpr std::size_t slot_count = 64;
+
+    /**
+     * @brief The call_scope class tracks a call during its scope.
+     */
+    class call_scope
+    {
+    public:
+        /**
+         * @throw plugin_unloaded_error If the tracker is closed.
+         */
+        inline explicit call_scope(call_tracker& tracker)
+            : tracker_(tracker), slot_(private_::local_call_thread_slot())
+        {
+            if (!tracker_.try_enter(slot_)) [[unlikely]]
+                throw plugin_unloaded_error("The plugin of the called function is unloaded.");
+        }
+
+        inline ~call_scope() { tracker_.leave(slot_); }
+
+        call_scope(const call_scope&) = delete;
+        call_scope& operator=(const call_scope&) = delete;
+
+    private:
+        call_tracker& tracker_;
+        const private_::call_thread_slot& slot_;
+    };
+
+    /**
+     * @brief try_enter Count a new call in flight.
+     * @return false if the tracker is closed (the call is then not counted).
+     */
+    [[nodiscard]] inline bool try_enter(const private_::call_thread_slot& slot) noexcept
+    {
+        if (slot.index < slot_count) [[likely]]
+        {
+            std::atomic<std::int64_t>& count = slots_[slot.index].call_count;
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            // Either close() sees this call, or this call sees the tracker closed.
+            if (slot.asymmetric_barrier) [[likely]]
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            else
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        else
+        {
+            overflow_call_count_.fetch_add(1);
+        }
+        if (closed_.load(std::memory_order_relaxed)) [[unlikely]]
+        {
+            leave(slot);
+            return false;
+        }
+        return true;
+    }
+
+    inline void leave(const private_::call_thread_slot& slot) noexcept
+    {
+        if (slot.index < slot_count) [[likely]]
+        {
+            std::atomic<std::int64_t>& count = slots_[slot.index].call_count;
+            count.store(count.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+        }
+        else
+        {
+            overflow_call_count_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief close Refuse the new calls.
+     */
+    void close() noexcept;
+
+    [[nodiscard]] inline bool is_closed() const noexcept { return closed_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief is_idle Indicate if no call is in flight.
+     */
+    [[nodiscard]] bool is_idle() const noexcept;
+
+    /**
+     * @brief wait_idle Wait for the end of the calls in flight.
+     * @warning A call in flight waiting for the unload of its own plugin never ends.
+     */
+    void wait_idle() const noexcept;
+
+    /**
+     * @brief add_release_callback Register a function called when the plugin is released: once the calls in flight
+     * are finished, before the unload hook of the plugin and the close of its library.
+     * @details The callbacks are called once, whatever the unload policy, by the thread releasing the plugin (which
+     * is the reaper thread for a background close), without lock held. A callback added after the release is never
+     * called. Used to destroy the objects made by the plugin while its code is still mapped.
+     * @warning The callbacks must not throw.
+     */
+    void add_release_callback(std::function<void()> callback);
+
+    /**
+     * @brief has_release_callbacks Indicate if release callbacks are waiting to be called.
+     */
+    [[nodiscard]] bool has_release_callbacks() const;
+
+    /**
+     * @brief run_release_callbacks Call the release callbacks, then refuse the new ones.
+     */
+    void run_release_callbacks() noexcept;
+
+private:
+    struct alignas(64) slot_
+    {
+        std::atomic<std::int64_t> call_count = 0;
+    };
+
+    std::array<slot_, slot_count> slots_;
+    alignas(64) std::atomic<std::int64_t> overflow_call_count_ = 0;
+    std::atomic_bool closed_ = false;
+    mutable std::mutex release_mutex_;
+    std::vector<std::function<void()>> release_callbacks_;
+    bool released_ = false;
+};
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The cpu_variant enum lists the instruction sets a plugin can be built for, from the most portable one.
+ * @details The variant of a plugin is a file named after the plugin with the name of the variant before its
+ * extension (ex: concat.avx2.so for the avx2 variant of concat.so). The baseline variant is the plugin file itself.
+ */
+enum class cpu_variant : std::uint8_t
+{
+    // No instruction set extension: runs on any CPU.
+    baseline,
+    // x86-64-v3: AVX2, FMA and BMI2.
+    avx2,
+    // x86-64-v4: AVX-512 F, BW, DQ and VL.
+    avx512,
+};
+
+/**
+ * @brief cpu_variant_name The name of a variant, as written in the name of its file ("baseline" for the baseline).
+ */
+[[nodiscard]] std::string_view cpu_variant_name(cpu_variant variant) noexcept;
+
+/**
+ * @brief is_cpu_variant_supported Indicate if the CPU running the process supports the instructions of a variant.
+ * @details Detected with cpuid, through __builtin_cpu_supports(). Only the baseline is supported on the other
+ * architectures and compilers.
+ */
+[[nodiscard]] bool is_cpu_variant_supported(cpu_variant variant) noexcept;
+
+/**
+ * @brief best_cpu_variant The most specialized variant supported by the CPU running the process.
+ */
+[[nodiscard]] cpu_variant best_cpu_variant() noexcept;
+
+/**
+ * @brief The plugin_variant_selection struct describes the variant of a plugin selected for the CPU.
+ */
+struct plugin_variant_selection
+{
+    // The file of the selected variant.
+    std::filesystem::path plugin_path;
+    cpu_variant variant = cpu_variant::baseline;
+    // The variants whose file exists, supported by the CPU or not, from the most portable one.
+    std::vector<cpu_variant> available_variants;
+};
+
+/**
+ * @brief select_plugin_variant Select the best variant of a plugin which the CPU supports.
+ * @param plugin_path The path to the baseline plugin (extension of the file is optional).
+ * @param forced_variant The variant to select instead of the best one (ex: to compare variants, or to work around a
+ * faulty one).
+ * @return The selected variant, and the variants found.
+ * @throw plugin_load_error If no variant supported by the CPU exists, or if the forced variant does not exist or is
+ * not supported by the CPU.
+ */
+[[nodiscard]] plugin_variant_selection select_plugin_variant(const std::filesystem::path& plugin_path,
+                                                             std::optional<cpu_variant> forced_variant = std::nullopt);
+
+} // namespace plug
+} // namespace arba
@@ -1,9 +1,8 @@
 #pragma once
 
+#include <stdexcept>
 #if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
 #include <system_error>
-#else
-#include <stdexcept>
 #endif
 
 inline namespace arba
@@ -47,5 +46,20 @@ class plugin_find_symbol_error : public
 #endif
 };
 
+class plugin_unloaded_error : public std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+class plugin_process_error : public std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+class plugin_integrity_error : public std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
 } // namespace plug
 } // namespace arba
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "signature_hash.hpp"
+
+#include <concepts>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+static constexpr std::string_view function_table_fname_prefix = "arba_plug_function_table_";
+} // namespace private_
+
+/**
+ * @brief The function_table_header struct identifies a function table exported by a plugin.
+ */
+struct function_table_header
+{
+    std::uint32_t version;
+    std::uint32_t table_size;
+    std::uint64_t signature_hash;
+};
+
+/**
+ * @brief The function_table struct is the object exported by a plugin: a header followed by the function pointers.
+ * @tparam FunctionTableType A table type declared with ARBA_PLUG_DECLARE_FUNCTION_TABLE().
+ */
+template <class FunctionTableType>
+struct function_table
+{
+    function_table_header header;
+    FunctionTableType functions;
+};
+
+template <class FunctionTableType>
+concept function_table_type = requires {
+    {
+        FunctionTableType::table_name
+    } -> std::convertible_to<std::string_view>;
+    {
+        FunctionTableType::version
+    } -> std::convertible_to<std::uint32_t>;
+    {
+        FunctionTableType::signature_hash
+    } -> std::convertible_to<std::uint64_t>;
+} && std::is_standard_layout_v<function_table<FunctionTableType>>;
+
+} // namespace plug
+} // namespace arba
+
+#define ARBA_PLUG_PRIVATE_FUNCTION_TABLE_MEMBER(function_, ...) std::type_identity_t<__VA_ARGS__> function_;
+#define ARBA_PLUG_PRIVATE_FUNCTION_TABLE_SIGNATURE(function_, ...) #function_ ":" #__VA_ARGS__ ";"
+#define ARBA_PLUG_PRIVATE_FUNCTION_TABLE_INITIALIZER(function_, ...) .function_ = &function_,
+
+/**
+ * Declare a function table type, to be shared by the plugin and the host.
+ * @param table_ The name of the table type.
+ * @param version_ The version of the table, to increase when its functions change.
+ * @param functions_ A macro taking a macro ENTRY and calling ENTRY(function_name, function_pointer_type) for each
+ * function of the table. (ex: #define MY_FUNCTIONS(ENTRY) ENTRY(run, int (*)(int)) ENTRY(stop, void (*)()))
+ * The signature hash is computed from the names and the spelling of the types of the functions.
+ */
+#define ARBA_PLUG_DECLARE_FUNCTION_TABLE(table_, version_, functions_)                                                 \
+    struct table_                                                                                                      \
+    {                                                                                                                  \
+        static constexpr std::string_view table_name = #table_;                                                       \
+        static constexpr std::uint32_t version = version_;                                                             \
+        static constexpr std::uint64_t signature_hash =                                                                \
+            ::arba::plug::private_::fnv1a_hash(functions_(ARBA_PLUG_PRIVATE_FUNCTION_TABLE_SIGNATURE));                \
+        functions_(ARBA_PLUG_PRIVATE_FUNCTION_TABLE_MEMBER)                                                            \
+    };
+
+/**
+ * Define, in a plugin, the function exporting a function table filled with the functions of the plugin having the
+ * names of the table functions.
+ * @param table_ The name of the table type, declared with ARBA_PLUG_DECLARE_FUNCTION_TABLE().
+ * @param functions_ The macro listing the functions of the table, given to ARBA_PLUG_DECLARE_FUNCTION_TABLE().
+ */
+#define ARBA_PLUG_DEFINE_FUNCTION_TABLE(table_, functions_)                                                            \
+    extern "C" const ::arba::plug::function_table_header* arba_plug_function_table_##table_()                          \
+    {                                                                                                                  \
+        static_assert(::arba::plug::function_table_type<table_>);                                                     \
+        static constexpr ::arba::plug::function_table<table_> table{                                                   \
+            .header = { .version = table_::version,                                                                    \
+                        .table_size = sizeof(table_),                                                                  \
+                        .signature_hash = table_::signature_hash },                                                    \
+            .functions = { functions_(ARBA_PLUG_PRIVATE_FUNCTION_TABLE_INITIALIZER) }                                  \
+        };                                                                                                             \
+        return &table.header;                                                                                          \
+    }
+
+#ifndef PLUG_DECLARE_FUNCTION_TABLE
+#define PLUG_DECLARE_FUNCTION_TABLE(table_, version_, functions_)                                                      \
+    ARBA_PLUG_DECLARE_FUNCTION_TABLE(table_, version_, functions_)
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message "PLUG_DECLARE_FUNCTION_TABLE already exists. You must use ARBA_PLUG_DECLARE_FUNCTION_TABLE."
+#endif
+#endif
+
+#ifndef PLUG_DEFINE_FUNCTION_TABLE
+#define PLUG_DEFINE_FUNCTION_TABLE(table_, functions_) ARBA_PLUG_DEFINE_FUNCTION_TABLE(table_, functions_)
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message "PLUG_DEFINE_FUNCTION_TABLE already exists. You must use ARBA_PLUG_DEFINE_FUNCTION_TABLE."
+#endif
+#endif
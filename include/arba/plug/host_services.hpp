@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+
+inline namespace arba
+{
+namespace plug
+{
+
+enum class host_log_level : std::uint8_t
+{
+    debug,
+    info,
+    warning,
+    error
+};
+
+/**
+ * @brief The host_services struct is a table of services of the host, given to the plugins at their load (see
+ * ARBA_PLUG_BIND_HOST()), so that they call back into the host through direct pointers.
+ * @details The table is versioned: the new services are appended at its end, with a new version. A plugin must check
+ * the version of the table before reading a service added after the first version, since it may be bound to an older
+ * host. Every service is optional (nullptr if the host does not provide it).
+ * @warning The table, and what it points to, must outlive the plugins bound to it.
+ */
+struct host_services
+{
+    static constexpr std::uint32_t current_version = 1;
+
+    // The version of the table filled by the host.
+    std::uint32_t version = current_version;
+    // The size of the table filled by the host.
+    std::uint32_t size = sizeof(host_services);
+    // An opaque pointer given back to the services of the host.
+    void* context = nullptr;
+    // Version 1:
+    void (*log)(void* context, host_log_level level, std::string_view message) noexcept = nullptr;
+    void (*record_metric)(void* context, std::string_view name, double value) noexcept = nullptr;
+    // The memory resource the plugins should allocate from, so their allocations go into the arenas of the host.
+    std::pmr::memory_resource* memory_resource = nullptr;
+
+    /**
+     * @brief write_log Write a message in the log of the host, if it provides one.
+     */
+    inline void write_log(host_log_level level, std::string_view message) const noexcept
+    {
+        if (log)
+            log(context, level, message);
+    }
+
+    /**
+     * @brief add_metric Record a metric in the host, if it provides a recorder.
+     */
+    inline void add_metric(std::string_view name, double value) const noexcept
+    {
+        if (record_metric)
+            record_metric(context, name, value);
+    }
+
+    /**
+     * @brief resource The memory resource of the host, or the default memory resource if it does not provide one.
+     */
+    [[nodiscard]] inline std::pmr::memory_resource* resource() const noexcept
+    {
+        return memory_resource ? memory_resource : std::pmr::get_default_resource();
+    }
+};
+
+namespace private_
+{
+using bind_host_type = bool (*)(const host_services&);
+static constexpr std::string_view bind_host_fname = "arba_plug_bind_host";
+} // namespace private_
+
+} // namespace plug
+} // namespace arba
+
+/**
+ * Export a function bool(const host_services&) of a plugin as its host binding entry, called by
+ * plugin_base::bind_host() with the service table of the host. The function usually keeps a pointer to the table,
+ * and returns false to reject a table it cannot use (ex: a too old version).
+ */
+#define ARBA_PLUG_BIND_HOST(function_)                                                                                 \
+    extern "C" bool arba_plug_bind_host(const ::arba::plug::host_services& services)                                   \
+    {                                                                                                                  \
+        static_assert(::arba::plug::private_::bind_host_fname == __func__);                                            \
+        return function_(services);                                                                                    \
+    }
+
+#ifndef PLUG_BIND_HOST
+#define PLUG_BIND_HOST(function_) ARBA_PLUG_BIND_HOST(function_)
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message "PLUG_BIND_HOST already exists. You must use ARBA_PLUG_BIND_HOST."
+#endif
+#endif
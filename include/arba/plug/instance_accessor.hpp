@@ -0,0 +1,248 @@
+#pragma once
+
+#include "call_tracker.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The basic_instance_accessor class caches the reference to a global instance of a plugin, returned by a
+ * getter function of the plugin (see plugin_impl::instance_ref()).
+ * @tparam PluginType The plugin class used to find the getter (plugin, safe_plugin, ...).
+ * @tparam InstanceType The type of the global instance, const qualified for a getter returning a const reference.
+ * @details The getter is found and called once per load of the plugin: an access only compares the load identifier
+ * of the plugin (see plugin_base::load_id()) with the cached one, without symbol lookup or call into the plugin.
+ * When the plugin is unloaded or reloaded, the cache is invalidated and the next access finds the getter again.
+ * The accesses can be called concurrently.
+ * @warning The plugin must outlive the accessor and must not be moved.
+ */
+template <class PluginType, class InstanceType>
+class basic_instance_accessor
+{
+public:
+    using getter_type = InstanceType& (*)();
+
+    /**
+     * @brief basic_instance_accessor Find the getter in the plugin and cache the reference it returns.
+     * @param plugin The plugin defining the global instance.
+     * @param getter_function_name The name of the getter function to find in the plugin.
+     * @throw plugin_find_symbol_error If the getter is not found, or if no plugin is loaded.
+     */
+    basic_instance_accessor(PluginType& plugin, std::string_view getter_function_name)
+        : plugin_(&plugin), getter_function_name_(getter_function_name)
+    {
+        refresh_();
+    }
+
+    /**
+     * @brief get The reference to the global instance of the current load of the plugin.
+     * @throw plugin_find_symbol_error If the plugin was reloaded without the getter, or if it is unloaded.
+     */
+    [[nodiscard]] inline InstanceType& get()
+    {
+        if (plugin_->load_id() != load_id_.load(std::memory_order_acquire)) [[unlikely]]
+            refresh_();
+        return *instance_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline InstanceType& operator*() { return get(); }
+    [[nodiscard]] inline InstanceType* operator->() { return &get(); }
+
+private:
+    void refresh_()
+    {
+        std::scoped_lock lock(mutex_);
+        const std::uint64_t load_id = plugin_->load_id();
+        if (load_id != 0 && load_id == load_id_.load(std::memory_order_relaxed))
+            return;
+        getter_type getter = plugin_->template find_function_ptr<getter_type>(getter_function_name_);
+        instance_.store(&getter(), std::memory_order_relaxed);
+        load_id_.store(load_id, std::memory_order_release);
+    }
+
+    PluginType* plugin_;
+    std::string getter_function_name_;
+    std::mutex mutex_;
+    std::atomic<InstanceType*> instance_ = nullptr;
+    std::atomic<std::uint64_t> load_id_ = 0;
+};
+
+/**
+ * @brief The basic_thread_instance_accessor class gives each thread its own instance made by a maker function of a
+ * plugin, for a state used without contention between the threads (see plugin_impl::bind_thread_instance()).
+ * @tparam PluginType The plugin class used to find the maker (plugin, safe_plugin, ...).
+ * @tparam ClassType The type of the made instances.
+ * @details The signature of the maker function is expected to be std::unique_ptr<ClassType>(*)(). The first access
+ * of a thread makes its instance under a lock, then the next accesses find it in a small cache of the thread, without
+ * lock nor call into the plugin. The instances are owned by the accessor: they are destroyed by reset(), by the
+ * destructor, and when the plugin making them is released (see call_tracker::add_release_callback()), while its code
+ * is still mapped. After an unload or a reload, the next access of a thread makes a new instance.
+ * @warning The references to the instances must not be used once the plugin is unloaded or reloaded, and get() and
+ * reset() must not be called concurrently with reset(), unload() or load_from_file(). The plugin must outlive the
+ * accessor and must not be moved.
+ */
+template <class PluginType, class ClassType>
+class basic_thread_instance_accessor
+{
+public:
+    using maker_type = std::unique_ptr<ClassType> (*)();
+
+    /**
+     * @brief basic_thread_instance_accessor Find the maker function in the plugin.
+     * @param plugin The plugin making the instances.
+     * @param maker_function_name The name of the maker function to find in the plugin.
+     * @throw plugin_find_symbol_error If the maker is not found, or if no plugin is loaded.
+     */
+    basic_thread_instance_accessor(PluginType& plugin, std::string_view maker_function_name)
+        : plugin_(&plugin), maker_function_name_(maker_function_name), state_(std::make_shared<state_type_>())
+    {
+        std::scoped_lock lock(state_->mutex);
+        bind_load_();
+    }
+
+    basic_thread_instance_accessor(const basic_thread_instance_accessor&) = delete;
+    basic_thread_instance_accessor& operator=(const basic_thread_instance_accessor&) = delete;
+
+    ~basic_thread_instance_accessor() { reset(); }
+
+    /**
+     * @brief get The instance of the calling thread, made at its first access.
+     * @throw plugin_find_symbol_error If the plugin was reloaded without the maker, or if it is unloaded.
+     * @throw Any exception thrown by the maker function.
+     */
+    [[nodiscard]] inline ClassType& get()
+    {
+        // The key is read after the load identifier, so that it is the key of this load.
+        if (plugin_->load_id() == state_->load_id.load(std::memory_order_acquire)) [[likely]]
+        {
+            const std::uint64_t key = state_->key.load(std::memory_order_acquire);
+            for (const thread_entry_& entry : thread_entries_())
+                if (entry.key == key)
+                    return *entry.instance;
+        }
+        return make_thread_instance_();
+    }
+
+    [[nodiscard]] inline ClassType& operator*() { return get(); }
+    [[nodiscard]] inline ClassType* operator->() { return &get(); }
+
+    /**
+     * @brief reset Destroy the instances of all the threads. The next access of a thread makes a new instance.
+     */
+    void reset()
+    {
+        std::scoped_lock lock(state_->mutex);
+        state_->clear();
+    }
+
+    /**
+     * @brief instance_count The number of instances made for the threads since the last reset, unload or reload.
+     */
+    [[nodiscard]] std::size_t instance_count() const
+    {
+        std::scoped_lock lock(state_->mutex);
+        return state_->instances.size();
+    }
+
+private:
+    // The state is shared with the release callbacks of the plugin, which may be called after the accessor is
+    // destroyed (ex: by the reaper thread of unload_in_background()).
+    struct state_type_
+    {
+        void clear()
+        {
+            instances.clear();
+            key.store(next_key_.fetch_add(1, std::memory_order_relaxed), std::memory_order_release);
+        }
+
+        mutable std::mutex mutex;
+        maker_type maker = nullptr;
+        std::vector<std::unique_ptr<ClassType>> instances;
+        std::atomic<std::uint64_t> key = next_key_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic<std::uint64_t> load_id = 0;
+    };
+
+    struct thread_entry_
+    {
+        const state_type_* owner;
+        std::weak_ptr<const state_type_> owner_alive;
+        std::uint64_t key;
+        ClassType* instance;
+    };
+
+    // The instances of the accessors used by the calling thread. An entry is identified by the key of its accessor,
+    // which changes at each reset, unload and reload, so the entries of the destroyed instances are never matched.
+    // The entries of the destroyed accessors are removed when the thread makes a new instance.
+    static std::vector<thread_entry_>& thread_entries_()
+    {
+        thread_local std::vector<thread_entry_> entries;
+        return entries;
+    }
+
+    // Find the maker in the current load of the plugin, and destroy the instances of this load when the plugin is
+    // released. The mutex of the state must be locked.
+    void bind_load_()
+    {
+        const std::uint64_t load_id = plugin_->load_id();
+        state_->clear();
+        state_->maker = plugin_->template find_function_ptr<maker_type>(maker_function_name_);
+        if (std::shared_ptr<call_tracker> tracker = plugin_->find_call_tracker())
+        {
+            tracker->add_release_callback([weak_state = std::weak_ptr<state_type_>(state_), load_id] {
+                if (std::shared_ptr<state_type_> state = weak_state.lock())
+                {
+                    std::scoped_lock lock(state->mutex);
+                    if (state->load_id.load(std::memory_order_relaxed) == load_id)
+                    {
+                        state->clear();
+                        state->load_id.store(0, std::memory_order_release);
+                    }
+                }
+            });
+        }
+        state_->load_id.store(load_id, std::memory_order_release);
+    }
+
+    ClassType& make_thread_instance_()
+    {
+        std::scoped_lock lock(state_->mutex);
+        const std::uint64_t load_id = plugin_->load_id();
+        if (load_id == 0 || load_id != state_->load_id.load(std::memory_order_relaxed))
+            bind_load_();
+        ClassType* instance = state_->instances.emplace_back(state_->maker()).get();
+        const thread_entry_ new_entry{ .owner = state_.get(),
+                                       .owner_alive = state_,
+                                       .key = state_->key.load(std::memory_order_relaxed),
+                                       .instance = instance };
+        std::vector<thread_entry_>& entries = thread_entries_();
+        std::erase_if(entries, [](const thread_entry_& entry) { return entry.owner_alive.expired(); });
+        for (thread_entry_& entry : entries)
+        {
+            if (entry.owner == new_entry.owner)
+            {
+                entry = new_entry;
+                return *instance;
+            }
+        }
+        entries.push_back(new_entry);
+        return *instance;
+    }
+
+    inline static std::atomic<std::uint64_t> next_key_ = 1;
+
+    PluginType* plugin_;
+    std::string maker_function_name_;
+    std::shared_ptr<state_type_> state_;
+};
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The instance_batch class holds a batch of instances sharing a single storage.
+ * @tparam ClassType The type of the instances (the interface class known by the host).
+ * @details A plugin batch maker builds all the instances in one contiguous storage
+ * (see make_contiguous_instance_batch()). When the plugin does not provide a batch maker, the batch holds instances
+ * made one by one.
+ * @warning The batch must be destroyed before the plugin which made it is unloaded.
+ */
+template <class ClassType>
+    requires std::has_virtual_destructor_v<ClassType>
+class instance_batch
+{
+public:
+    instance_batch() = default;
+
+    /**
+     * @brief Batch constructor.
+     * @param storage The owner of the instances.
+     * @param instances The addresses of the instances owned by storage.
+     */
+    instance_batch(std::shared_ptr<void> storage, std::vector<ClassType*> instances)
+        : storage_(std::move(storage)), instances_(std::move(instances))
+    {
+    }
+
+    [[nodiscard]] inline std::size_t size() const noexcept { return instances_.size(); }
+    [[nodiscard]] inline bool empty() const noexcept { return instances_.empty(); }
+
+    [[nodiscard]] inline ClassType& operator[](std::size_t index) const
+    {
+        assert(index < instances_.size());
+        return *instances_[index];
+    }
+
+    /**
+     * @brief instances The addresses of all the instances of the batch.
+     */
+    [[nodiscard]] inline std::span<ClassType* const> instances() const noexcept { return instances_; }
+
+    /**
+     * @brief shared_instance Return a std::shared_ptr to one instance, which keeps the whole batch alive.
+     * @param index The index of the instance in the batch.
+     */
+    [[nodiscard]] std::shared_ptr<ClassType> shared_instance(std::size_t index) const
+    {
+        assert(index < instances_.size());
+        return std::shared_ptr<ClassType>(storage_, instances_[index]);
+    }
+
+private:
+    std::shared_ptr<void> storage_;
+    std::vector<ClassType*> instances_;
+};
+
+/**
+ * @brief make_contiguous_instance_batch Build count instances of ConcreteType in one contiguous storage.
+ * @tparam ConcreteType The concrete type of the instances (defined in the plugin).
+ * @tparam ClassType The type of the instances known by the host.
+ * @param count The number of instances to build.
+ * @param args The arguments passed to the constructor of each instance.
+ * @return The batch of instances.
+ * @details This function is meant to be called by the batch makers exported by plugins:
+ * extern "C" instance_batch<ClassType> make_instances(std::size_t count).
+ */
+template <class ConcreteType, class ClassType, class... ArgsT>
+    requires std::is_base_of_v<ClassType, ConcreteType> && std::is_constructible_v<ConcreteType, const ArgsT&...>
+instance_batch<ClassType> make_contiguous_instance_batch(std::size_t count, const ArgsT&... args)
+{
+    std::allocator<ConcreteType> allocator;
+    ConcreteType* const first = allocator.allocate(count);
+    std::size_t constructed_count = 0;
+    try
+    {
+        for (; constructed_count < count; ++constructed_count)
+            std::construct_at(first + constructed_count, args...);
+    }
+    catch (...)
+    {
+        std::destroy_n(first, constructed_count);
+        allocator.deallocate(first, count);
+        throw;
+    }
+
+    std::shared_ptr<void> storage(first, [count](void* storage_ptr) {
+        ConcreteType* const storage_first = static_cast<ConcreteType*>(storage_ptr);
+        std::destroy_n(storage_first, count);
+        std::allocator<ConcreteType>().deallocate(storage_first, count);
+    });
+    std::vector<ClassType*> instances;
+    instances.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        instances.push_back(first + i);
+    return instance_batch<ClassType>(std::move(storage), std::move(instances));
+}
+
+} // namespace plug
+} // namespace arba
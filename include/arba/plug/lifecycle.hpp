@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string_view>
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+static constexpr std::string_view on_load_fname = "arba_plug_on_load";
+static constexpr std::string_view on_unload_fname = "arba_plug_on_unload";
+} // namespace private_
+
+} // namespace plug
+} // namespace arba
+
+/**
+ * Export a function void() of a plugin as its load hook, called by plugin_base::initialize().
+ * The hook may throw to report a failed initialization: the plugin is then left uninitialized.
+ */
+#define ARBA_PLUG_ON_LOAD(function_)                                                                                   \
+    extern "C" void arba_plug_on_load()                                                                                \
+    {                                                                                                                  \
+        function_();                                                                                                   \
+    }
+
+/**
+ * Export a function void() of a plugin as its unload hook, called before the plugin is unloaded if it was initialized
+ * (see plugin_base::initialize()). The hook must not throw: the program is terminated if it does.
+ */
+#define ARBA_PLUG_ON_UNLOAD(function_)                                                                                 \
+    extern "C" void arba_plug_on_unload()                                                                              \
+    {                                                                                                                  \
+        function_();                                                                                                   \
+    }
+
+#ifndef PLUG_ON_LOAD
+#define PLUG_ON_LOAD(function_) ARBA_PLUG_ON_LOAD(function_)
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message "PLUG_ON_LOAD already exists. You must use ARBA_PLUG_ON_LOAD."
+#endif
+#endif
+
+#ifndef PLUG_ON_UNLOAD
+#define PLUG_ON_UNLOAD(function_) ARBA_PLUG_ON_UNLOAD(function_)
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message "PLUG_ON_UNLOAD already exists. You must use ARBA_PLUG_ON_UNLOAD."
+#endif
+#endif
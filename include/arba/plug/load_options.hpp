@@ -0,0 +1,57 @@
+#pragma once
+
+#include "cpu_variant.hpp"
+#include "host_services.hpp"
+#include "unload_policy.hpp"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+inline namespace arba
+{
+namespace plug
+{
+
+class plugin_integrity_verifier;
+
+/**
+ * @brief The plugin_load_options struct gathers the optional steps of the load of a plugin.
+ */
+struct plugin_load_options
+{
+    static constexpr std::string_view default_warm_up_func_name = "warmup";
+
+    // Copy the executable segment of the plugin onto anonymous memory backed by transparent huge pages, to reduce
+    // iTLB misses when calling into large plugins (see plugin_base::remap_text_to_huge_pages()).
+    bool remap_text_to_huge_pages = false;
+    // Prefault the pages of the loadable segments of the plugin right after its load, so the first calls into the
+    // plugin do not take page faults (see plugin_base::warm_up()).
+    bool warm_up = false;
+    // Name of a function void(*)() exported by the plugin and called after prefaulting (when warm_up is true).
+    // Nothing is called if the name is empty or if the plugin does not export it.
+    std::string warm_up_function_name = std::string(default_warm_up_func_name);
+    // Call the load hook of the plugin at the end of the load (see plugin_base::initialize()).
+    bool initialize = false;
+    // Make the symbols of the plugin available to resolve the symbols of the plugins loaded after it (RTLD_GLOBAL).
+    // Ignored on Windows.
+    bool export_symbols_globally = false;
+    // What unload() and the destructor do with the library of the plugin. If empty, default_unload_policy() is used
+    // at the unload, so setting a policy opts the plugin out of the default one (ex: to keep closing it at shutdown).
+    std::optional<plugin_unload_policy> unload_policy = std::nullopt;
+    // Load the best variant of the plugin supported by the CPU (see select_plugin_variant()) rather than the plugin
+    // file itself. The selected variant is reported in plugin_load_stats::variant.
+    bool select_cpu_variant = false;
+    // Load this variant of the plugin rather than the best one (implies select_cpu_variant).
+    std::optional<cpu_variant> forced_cpu_variant = std::nullopt;
+    // Give this service table to the plugin right after opening it, before the other steps of the load which may call
+    // the plugin (see plugin_base::bind_host()). If the plugin rejects the table, it is unloaded and plugin_load_error
+    // is thrown. Nothing is bound if it is nullptr. The table must outlive the plugin.
+    const host_services* host = nullptr;
+    // Check the content hash of the plugin file with this verifier before opening it. A plugin path without directory
+    // is then opened from the current directory, rather than searched in the library paths.
+    plugin_integrity_verifier* integrity_verifier = nullptr;
+};
+
+} // namespace plug
+} // namespace arba
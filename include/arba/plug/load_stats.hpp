@@ -0,0 +1,43 @@
+#pragma once
+
+#include "cpu_variant.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The plugin_load_stats struct describes the cost of the last load of a plugin.
+ * @details The operating system loader does not expose its phases, so the time spent in file I/O, relocations
+ * and static constructors is not split. Major page faults mostly come from reading the file, minor page faults
+ * from relocations and first writes to the data segments.
+ * Page faults and mapped segments are only measured on Linux.
+ */
+struct plugin_load_stats
+{
+    // Wall time of the load (dlopen or LoadLibrary call, static constructors included).
+    std::chrono::nanoseconds load_duration{ 0 };
+    // Page faults which were resolved without I/O, taken by the loading thread during the load.
+    std::uint64_t minor_page_faults = 0;
+    // Page faults which required I/O, taken by the loading thread during the load.
+    std::uint64_t major_page_faults = 0;
+    // Size of the loadable segments of the plugin, rounded to whole pages.
+    std::size_t mapped_bytes = 0;
+    // Number of loadable segments of the plugin.
+    std::size_t mapped_segment_count = 0;
+    // Bytes of the executable segment remapped onto huge pages (see plugin_base::remap_text_to_huge_pages()).
+    std::size_t huge_page_text_bytes = 0;
+    // Wall time of the last warm up of the plugin (see plugin_base::warm_up()).
+    std::chrono::nanoseconds warm_up_duration{ 0 };
+    // Wall time of the load hook of the plugin (see plugin_base::initialize()).
+    std::chrono::nanoseconds initialize_duration{ 0 };
+    // The variant of the plugin which was loaded (see plugin_load_options::select_cpu_variant).
+    cpu_variant variant = cpu_variant::baseline;
+};
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+class plugin_base;
+
+/**
+ * @brief The segment_footprint struct describes the memory used by one loadable segment of a plugin.
+ */
+struct segment_footprint
+{
+    // Page aligned address of the segment.
+    std::uintptr_t address = 0;
+    // Size of the segment, rounded to whole pages.
+    std::size_t mapped_bytes = 0;
+    // Bytes of the segment which are in RAM (mincore).
+    std::size_t resident_bytes = 0;
+    // Bytes of the segment which were written (private and shared dirty pages of /proc/self/smaps).
+    std::size_t dirty_bytes = 0;
+    bool readable = false;
+    bool writable = false;
+    bool executable = false;
+};
+
+/**
+ * @brief The plugin_memory_footprint struct describes the memory used by the segments of a plugin.
+ * @details Memory allocated on the heap by the plugin is not accounted: it cannot be told apart from the memory
+ * allocated by the host.
+ */
+struct plugin_memory_footprint
+{
+    std::vector<segment_footprint> segments;
+
+    [[nodiscard]] std::size_t mapped_bytes() const noexcept;
+    [[nodiscard]] std::size_t resident_bytes() const noexcept;
+    [[nodiscard]] std::size_t dirty_bytes() const noexcept;
+};
+
+/**
+ * @brief memory_footprints Measure the memory footprint of several plugins at once.
+ * @param plugins The plugins to measure.
+ * @return The footprints, in the order of plugins (empty footprints for the plugins which are not loaded, and on
+ * platforms where they cannot be measured).
+ * @details /proc/self/smaps is read once for all the plugins.
+ */
+[[nodiscard]] std::vector<plugin_memory_footprint> memory_footprints(std::span<const plugin_base* const> plugins);
+
+/**
+ * @brief The plugin_memory_sharing struct splits the resident memory of a plugin in a process between the pages
+ * shared with other processes (ex: inherited from a zygote and not written since) and the private ones.
+ */
+struct plugin_memory_sharing
+{
+    // Resident bytes of the plugin mapped by several processes (shared clean and dirty pages of smaps).
+    std::size_t shared_bytes = 0;
+    // Resident bytes of the plugin mapped by the process only (private clean and dirty pages of smaps).
+    std::size_t private_bytes = 0;
+};
+
+/**
+ * @brief memory_sharings Split the resident memory of plugins in another process between shared and private pages.
+ * @param process_id The process to inspect. The plugins must be mapped at the same addresses in this process as in
+ * the calling one, like in a process forked after their load.
+ * @param plugins The plugins, loaded in the calling process.
+ * @return The memory sharing of each plugin, at the index of the plugin (empty for the unloaded plugins).
+ * @details Read from /proc/<process_id>/smaps: only measured on Linux.
+ */
+[[nodiscard]] std::vector<plugin_memory_sharing> memory_sharings(int process_id,
+                                                                 std::span<const plugin_base* const> plugins);
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "plugin.hpp"
+#include "process_channel.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+// The arguments of a remote call are copied one after the other, without padding.
+template <typename... ArgsT>
+inline constexpr std::array<std::size_t, sizeof...(ArgsT) + 1> remote_argument_offsets = [] {
+    std::array<std::size_t, sizeof...(ArgsT) + 1> offsets{};
+    std::size_t index = 0;
+    ((offsets[index + 1] = offsets[index] + sizeof(ArgsT), ++index), ...);
+    return offsets;
+}();
+
+template <typename Type>
+Type read_remote_value(const std::byte* buffer)
+{
+    std::array<std::byte, sizeof(Type)> bytes;
+    std::memcpy(bytes.data(), buffer, sizeof(Type));
+    return std::bit_cast<Type>(bytes);
+}
+
+template <typename ReturnType, typename... ArgsT, std::size_t... Indexes>
+void invoke_remote_function(void* function, std::byte* buffer, std::index_sequence<Indexes...>)
+{
+    using function_type = ReturnType (*)(ArgsT...);
+    constexpr auto& offsets = remote_argument_offsets<ArgsT...>;
+    std::tuple<ArgsT...> arguments{ read_remote_value<ArgsT>(buffer + offsets[Indexes])... };
+    if constexpr (std::is_void_v<ReturnType>)
+        std::apply(reinterpret_cast<function_type>(function), arguments);
+    else
+    {
+        const ReturnType result = std::apply(reinterpret_cast<function_type>(function), arguments);
+        std::memcpy(buffer, &result, sizeof(ReturnType));
+    }
+}
+
+template <typename ReturnType, typename... ArgsT>
+void remote_function_invoker(void*, void* function, std::byte* buffer)
+{
+    invoke_remote_function<ReturnType, ArgsT...>(function, buffer, std::index_sequence_for<ArgsT...>{});
+}
+
+template <class PluginType, typename FunctionSignatureType>
+void remote_function_finder(void* context, void*, std::byte* buffer)
+{
+    PluginType& plugin = *static_cast<PluginType*>(context);
+    const std::string_view function_name(reinterpret_cast<const char*>(buffer));
+    void* function =
+        reinterpret_cast<void*>(plugin.template find_function_ptr<FunctionSignatureType>(function_name));
+    std::memcpy(buffer, &function, sizeof(function));
+}
+
+template <typename Type>
+concept remote_value_type = std::is_trivially_copyable_v<Type> && !std::is_pointer_v<Type>
+                            && !std::is_reference_v<Type>;
+} // namespace private_
+
+/**
+ * @brief The pending_call class is the result of a remote call submitted to a plugin process.
+ * @details If the result is not retrieved with get(), the destructor waits for the end of the call.
+ */
+template <typename ReturnType>
+class pending_call
+{
+public:
+    pending_call(std::shared_ptr<private_::process_channel> channel, std::uint32_t slot_index)
+        : channel_(std::move(channel)), slot_index_(slot_index)
+    {
+    }
+
+    pending_call(pending_call&& other) noexcept
+        : channel_(std::move(other.channel_)), slot_index_(other.slot_index_)
+    {
+    }
+
+    pending_call& operator=(pending_call&&) = delete;
+
+    ~pending_call()
+    {
+        if (channel_)
+        {
+            try
+            {
+                get();
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+    }
+
+    /**
+     * @brief get Wait for the end of the call and return its result.
+     * @throw std::runtime_error If the function threw an exception in the plugin process.
+     * @throw plugin_process_error If the plugin process ended during the call.
+     * @warning get() must be called once.
+     */
+    ReturnType get()
+    {
+        std::shared_ptr<private_::process_channel> channel = std::move(channel_);
+        if constexpr (std::is_void_v<ReturnType>)
+            channel->wait(slot_index_, {});
+        else
+        {
+            std::array<std::byte, sizeof(ReturnType)> result;
+            channel->wait(slot_index_, result);
+            return std::bit_cast<ReturnType>(result);
+        }
+    }
+
+private:
+    std::shared_ptr<private_::process_channel> channel_;
+    std::uint32_t slot_index_;
+};
+
+template <typename FunctionSignatureType>
+class remote_function;
+
+/**
+ * @brief The remote_function class calls a function of a plugin loaded in another process.
+ * @tparam ReturnType The return type of the function.
+ * @tparam ArgsT The types of the arguments of the function.
+ * @details The arguments and the result are copied through the memory shared with the plugin process: they must be
+ * trivially copyable, and must not be pointers, which would point to the memory of the host process.
+ */
+template <typename ReturnType, typename... ArgsT>
+    requires(std::is_void_v<ReturnType> || private_::remote_value_type<ReturnType>)
+            && (private_::remote_value_type<ArgsT> && ...)
+class remote_function<ReturnType (*)(ArgsT...)>
+{
+    static_assert(private_::remote_argument_offsets<ArgsT...>.back() <= private_::process_channel::buffer_size,
+                  "The arguments of a remote function are too large.");
+    static_assert(sizeof(std::conditional_t<std::is_void_v<ReturnType>, char, ReturnType>)
+                      <= private_::process_channel::buffer_size,
+                  "The result of a remote function is too large.");
+
+public:
+    using function_pointer_type = ReturnType (*)(ArgsT...);
+
+    remote_function() = default;
+
+    remote_function(std::shared_ptr<private_::process_channel> channel, void* function)
+        : channel_(std::move(channel)), function_(function)
+    {
+    }
+
+    /**
+     * @brief operator() Call the function in the plugin process and wait for its result.
+     * @throw std::runtime_error If the function threw an exception in the plugin process.
+     * @throw plugin_process_error If the plugin process is not running or ended during the call.
+     */
+    ReturnType operator()(ArgsT... args) const { return submit(args...).get(); }
+
+    /**
+     * @brief submit Submit a call of the function to the plugin process, without waiting for it.
+     * @return The pending call, to get the result from.
+     * @throw plugin_process_error If the plugin process is not running.
+     * @details Submitting several calls before waiting for them lets the plugin process execute them in one batch,
+     * and saves a round trip per call.
+     * @warning A pending call holds one of the private_::process_channel::slot_count call slots until its result is
+     * retrieved, and submit() blocks while all the slots are held: a thread must not hold that many pending calls.
+     */
+    pending_call<ReturnType> submit(ArgsT... args) const
+    {
+        constexpr auto& offsets = private_::remote_argument_offsets<ArgsT...>;
+        std::array<std::byte, offsets.back()> arguments;
+        std::size_t index = 0;
+        ((std::memcpy(arguments.data() + offsets[index++], &args, sizeof(ArgsT))), ...);
+        const std::uint32_t slot_index =
+            channel_->submit(&private_::remote_function_invoker<ReturnType, ArgsT...>, function_, arguments);
+        return pending_call<ReturnType>(channel_, slot_index);
+    }
+
+    [[nodiscard]] inline bool is_callable() const noexcept { return channel_ != nullptr; }
+    inline explicit operator bool() const noexcept { return is_callable(); }
+
+private:
+    std::shared_ptr<private_::process_channel> channel_;
+    void* function_ = nullptr;
+};
+
+/**
+ * @brief The basic_out_of_process_plugin class loads a plugin in a helper process, so that a crash of the plugin does
+ * not end the host process.
+ * @tparam PluginType The plugin class used to load the plugin in the helper process (plugin, safe_plugin, ...).
+ * @details The helper process is a fork of the host process, which loads the plugin with PluginType and executes the
+ * remote calls. The calls go through lock-free rings in shared memory (see private_::process_channel).
+ * The plugin is unloaded and the helper process is stopped when the last of this instance and of its remote functions
+ * is destroyed.
+ * Only available on Linux.
+ * @warning The helper process is forked from the host: construct the instance before starting threads which may hold
+ * locks during the fork (the C library locks are safe).
+ */
+template <class PluginType = plugin>
+class basic_out_of_process_plugin
+{
+public:
+    using plugin_type = PluginType;
+
+    /**
+     * @brief basic_out_of_process_plugin Start a helper process and load a plugin in it.
+     * @param plugin_path The path to the plugin to load (extension of the file is optional).
+     * @param options The optional steps of the load.
+     * @throw plugin_load_error If the process cannot be started or if the plugin cannot be loaded.
+     */
+    explicit basic_out_of_process_plugin(const std::filesystem::path& plugin_path,
+                                         const plugin_load_options& options = {})
+        : channel_(std::make_shared<private_::process_channel>([&plugin_path, &options]() -> void* {
+              // The plugin lives until the end of the helper process, which never returns.
+              return new PluginType(plugin_path, options);
+          }))
+    {
+    }
+
+    /**
+     * @brief find_function Find the function with a given name in the plugin of the helper process.
+     * @tparam FunctionSignatureType Signature of the searched function. (i.e. int(*)(int))
+     * @param function_name The name of the searched function.
+     * @return A remote_function calling the found function in the helper process.
+     * @throw plugin_find_symbol_error If the function is not found.
+     * @throw std::runtime_error If PluginType rejects the function (ex: a safe_plugin with a bad function type).
+     * @throw plugin_process_error If the helper process is not running.
+     */
+    template <typename FunctionSignatureType>
+    remote_function<FunctionSignatureType> find_function(std::string_view function_name)
+    {
+        if (function_name.size() >= private_::process_channel::buffer_size) [[unlikely]]
+            throw std::invalid_argument(std::format("The function name '{}' is too long.", function_name));
+        std::array<std::byte, private_::process_channel::buffer_size> name{};
+        std::memcpy(name.data(), function_name.data(), function_name.size());
+        const std::uint32_t slot_index = channel_->submit(
+            &private_::remote_function_finder<PluginType, FunctionSignatureType>, nullptr, name);
+        std::array<std::byte, sizeof(void*)> function;
+        channel_->wait(slot_index, function);
+        return remote_function<FunctionSignatureType>(channel_, std::bit_cast<void*>(function));
+    }
+
+    /**
+     * @brief is_running Indicate if the helper process is running (false once the plugin crashed).
+     */
+    [[nodiscard]] inline bool is_running() const { return channel_->is_running(); }
+
+    [[nodiscard]] inline int process_id() const noexcept { return channel_->process_id(); }
+
+private:
+    std::shared_ptr<private_::process_channel> channel_;
+};
+
+using out_of_process_plugin = basic_out_of_process_plugin<plugin>;
+
+} // namespace plug
+} // namespace arba
@@ -24,8 +24,12 @@ public:
     /**
      * @brief Plugin constructor which takes the path to the plugin to load.
      * @param plugin_path The path to the plugin to load (extension of the file is optional).
+     * @param options The optional steps of the load.
      */
-    explicit plugin(const std::filesystem::path& plugin_path) : base_(plugin_path) {}
+    explicit plugin(const std::filesystem::path& plugin_path, const plugin_load_options& options = {})
+        : base_(plugin_path, options)
+    {
+    }
 
     plugin(plugin&&) = default;
     plugin& operator=(plugin&&) = default;
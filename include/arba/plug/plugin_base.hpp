@@ -1,8 +1,18 @@
 #pragma once
 
+#include "call_tracker.hpp"
 #include "exception.hpp"
+#include "load_options.hpp"
+#include "load_stats.hpp"
+#include "memory_footprint.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
 
 inline namespace arba
 {
@@ -16,8 +26,36 @@ constexpr std::string_view plugin_file_extension =
     ".so";
 #endif
 
+class service_registry;
+template <class PluginType, class ClassType>
+class basic_thread_instance_accessor;
+template <class ClassType, class PluginType>
+    requires std::has_virtual_destructor_v<ClassType>
+class plugin_object_pool;
+
+namespace private_
+{
+struct loaded_library;
+class symbol_overlay_index;
+} // namespace private_
+
 /**
  * @brief The plugin_base class
+ * @details Concurrency contract of all the plugin classes:
+ * - The lookups and queries (find_function_ptr(), find_symbols(), find_function_table(), bind_function(),
+ *   bind_tracked_function(), is_loaded(), is_initialized(), plugin_path(), load_stats(), memory_footprint()) can be
+ *   called concurrently with each other, and with load_from_file(), unload() and unload_in_background() called by
+ *   another thread. They never lock a mutex: they only mark a private_::read_section, and the unloads wait for the
+ *   sections which may read the unloaded plugin before closing it.
+ *   A lookup concurrent with an unload either finds the symbol in the unloaded plugin or throws
+ *   plugin_find_symbol_error.
+ * - The control operations (load_from_file(), unload(), remap_text_to_huge_pages(), warm_up(), initialize()) must
+ *   not be called concurrently with each other on the same instance.
+ * - Construction, move and destruction of an instance must not be concurrent with any other use of the instance.
+ * - The found functions, and the instances made by the plugin, must not be used once the plugin is unloaded: the
+ *   calls into the plugin (ex: make_unique_instance()) must be finished before unloading it. The functions bound with
+ *   bind_tracked_function() are the exception: their calls in flight are waited for by unload() and
+ *   unload_in_background().
  */
 class plugin_base
 {
@@ -27,13 +65,14 @@ protected:
     /**
      * @brief Plugin constructor which takes the path to the plugin to load.
      * @param plugin_path The path to the plugin to load (extension of the file is optional).
+     * @param options The optional steps of the load.
      * @throw std::runtime_error If the file does not exist or if there is a problem during loading.
      */
-    explicit plugin_base(const std::filesystem::path& plugin_path);
+    explicit plugin_base(const std::filesystem::path& plugin_path, const plugin_load_options& options = {});
 
 public:
     /**
-     * @brief ~Plugin destructor which unloads the plugin.
+     * @brief ~Plugin destructor which unloads the plugin, according to its unload policy.
      * @warning If any error occurs while unloading, an error message is written
      * on the error stream and the program exit with the error code.
      */
@@ -57,33 +96,177 @@ public:
     /**
      * @brief load_from_file Load the plugin present at a given path.
      * @param plugin_path The path to the plugin to load (extension of the file is optional).
+     * @param options The optional steps of the load.
      * @throw std::runtime_error If the file does not exist or if there is a problem during loading.
-     * @warning If a plugin is already loaded by this instance, the behavior is undefined.
+     * @details If a plugin is already loaded by this instance, it is replaced by the new one, then unloaded according
+     * to its unload policy. If an optional step of the load throws (ex: the load hook), the new plugin is unloaded
+     * before the exception is rethrown.
      */
-    void load_from_file(const std::filesystem::path& plugin_path);
+    void load_from_file(const std::filesystem::path& plugin_path, const plugin_load_options& options = {});
 
     /**
-     * @brief unload Unload the plugin.
+     * @brief unload Unload the plugin, and close its library according to its unload policy (see plugin_unload_policy).
+     * @details The new calls made through a tracked_function are refused. When the library is closed, the calls in
+     * flight are waited for before.
+     * @throw plugin_unload_error If the library is closed by this call and cannot be closed.
      * @warning If no plugin is loaded by this instance, the behavior is undefined.
      */
     void unload();
 
+    /**
+     * @brief unload_in_background Unload the plugin, and close it on a background thread once the calls in flight
+     * made through a tracked_function are finished, whatever its unload policy.
+     * @details The instance is unloaded when the function returns: the new calls of tracked functions are refused.
+     * The errors of the close are written on the error stream. See wait_for_background_unloads().
+     * @warning If no plugin is loaded by this instance, the behavior is undefined.
+     */
+    void unload_in_background();
+
+    /**
+     * @brief remap_text_to_huge_pages Move the executable segment of the plugin onto huge pages.
+     * @return The number of remapped bytes, also stored in load_stats().
+     * @details The part of the segment which is aligned on huge pages is copied onto anonymous memory advised with
+     * MADV_HUGEPAGE, which replaces the file mapping at the same address. Linking the plugin with
+     * -Wl,-zcommon-page-size=2097152 -Wl,-zmax-page-size=2097152 aligns its segments on huge pages.
+     * Nothing is remapped (0 is returned) if transparent huge pages are disabled, if anonymous memory cannot be made
+     * executable, if the segment does not contain a whole huge page, if the copy cannot be mapped, protected or moved
+     * (the segment is then left unchanged), or if the platform is not Linux.
+     * The remapped pages are private to the process: they are no longer shared with other processes using the plugin.
+     * @warning No thread may execute code of the plugin during the call: call it right after loading.
+     * @warning If no plugin is loaded by this instance, the behavior is undefined.
+     */
+    std::size_t remap_text_to_huge_pages();
+
+    /**
+     * @brief warm_up Prefault the pages of the plugin and call its warm up function.
+     * @param warm_up_function_name The name of a function void(*)() exported by the plugin, called after prefaulting
+     * (the same default name as plugin_load_options::warm_up_function_name). Nothing is called if the name is empty or
+     * if the plugin does not export it.
+     * @return The wall time of the warm up, also stored in load_stats().
+     * @details The text and data segments are prefaulted with madvise(MADV_POPULATE_READ), or by reading one byte per
+     * page on kernels which do not support it. Only Linux segments are prefaulted.
+     * @warning If no plugin is loaded by this instance, the behavior is undefined.
+     */
+    std::chrono::nanoseconds
+    warm_up(std::string_view warm_up_function_name = plugin_load_options::default_warm_up_func_name);
+
+    /**
+     * @brief bind_host Give the service table of the host to the plugin (see ARBA_PLUG_BIND_HOST()).
+     * @return true If the plugin has a host binding entry, false if it has none.
+     * @throw plugin_load_error If the plugin rejects the table.
+     * @details The plugin then calls the services of the host through the pointers of the table, without looking up
+     * any symbol of the host. The binding can be renewed with another table.
+     * @warning The table must outlive the plugin. If no plugin is loaded by this instance, the behavior is undefined.
+     */
+    bool bind_host(const host_services& services);
+
+    /**
+     * @brief initialize Call the load hook of the plugin (see ARBA_PLUG_ON_LOAD()), if it is not initialized yet.
+     * @return true If the plugin is initialized by this call, even if it has no load hook.
+     * @throw Any exception thrown by the load hook. The plugin is then left uninitialized.
+     * @details The wall time of the hook is stored in load_stats(). Once the plugin is initialized, its unload hook
+     * (see ARBA_PLUG_ON_UNLOAD()) is called before the plugin is closed, after the calls of tracked functions in
+     * flight, whatever the unload policy. Heavy setups done in the load hook, rather than on the first call, keep
+     * the first requests fast.
+     * @warning If no plugin is loaded by this instance, the behavior is undefined.
+     */
+    bool initialize();
+
+    /**
+     * @brief is_initialized Indicate if the plugin is loaded and initialized (see initialize()).
+     */
+    [[nodiscard]] bool is_initialized() const;
+
+    /**
+     * @brief find_symbols Find the addresses of several symbols in one pass.
+     * @param symbol_names The names of the searched symbols.
+     * @param symbol_pointers The found addresses, at the indexes of their names (nullptr for the missing symbols).
+     * @throw plugin_find_symbol_error If some symbols are not found, or if no plugin is loaded. The message lists all
+     * the missing symbols, and symbol_pointers holds the addresses of the found ones.
+     * @details On Linux, the symbols defined by the plugin are looked up directly in its GNU hash table, which is read
+     * once for all the names. The other symbols (ex: provided by a dependency of the plugin) are found with dlsym().
+     * @warning symbol_pointers must be as large as symbol_names.
+     */
+    void find_symbols(std::span<const std::string_view> symbol_names, std::span<void*> symbol_pointers) const;
+
     /**
      * @brief is_loaded Indicate is this plugin is loaded or not.
      * @return true If a loaded plugin is held by this instance.
      */
-    [[nodiscard]] inline bool is_loaded() const noexcept { return handle_; }
+    [[nodiscard]] inline bool is_loaded() const noexcept
+    {
+        return library_.load(std::memory_order_acquire) != nullptr;
+    }
+
+    /**
+     * @brief load_id The identifier of the current load of the plugin held by this instance.
+     * @return An identifier unique in the process, which changes at each load of the plugin, or 0 if no plugin is
+     * loaded. It is read with one atomic load, so caches of the plugin can check it on every access (see
+     * basic_instance_accessor).
+     */
+    [[nodiscard]] inline std::uint64_t load_id() const noexcept { return load_id_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief plugin_path The path of the loaded plugin file (with its extension).
+     * @return An empty path if no plugin is loaded by this instance.
+     */
+    [[nodiscard]] std::filesystem::path plugin_path() const;
+
+    /**
+     * @brief load_stats The cost of the load of the plugin held by this instance (see plugin_load_stats).
+     */
+    [[nodiscard]] plugin_load_stats load_stats() const;
+
+    /**
+     * @brief memory_footprint Measure the memory used by the segments of the plugin.
+     * @return The mapped, resident and dirty bytes of each loadable segment of the plugin (no segment if no plugin is
+     * loaded).
+     * @details To measure several plugins, memory_footprints() is faster.
+     */
+    [[nodiscard]] plugin_memory_footprint memory_footprint() const;
 
 protected:
-    void* find_symbol_pointer(const std::string& symbol_name);
+    /**
+     * @brief find_call_tracker The tracker of the calls in flight in the loaded plugin.
+     * @return nullptr if no plugin is loaded by this instance.
+     */
+    std::shared_ptr<call_tracker> find_call_tracker() const;
+
+    /**
+     * @brief find_symbol_pointer Find the address of a symbol exported by the plugin.
+     * @throw plugin_find_symbol_error If the symbol is not found or if no plugin is loaded by this instance.
+     */
+    void* find_symbol_pointer(const std::string& symbol_name) const;
+
+    /**
+     * @brief try_find_symbol_pointer Find the address of a symbol which the plugin may not export.
+     * @return The address of the symbol, or nullptr if it is not found or if no plugin is loaded by this instance.
+     */
+    void* try_find_symbol_pointer(const std::string& symbol_name) const noexcept;
 
 private:
+    friend class private_::symbol_overlay_index;
+    friend class service_registry;
+    template <class PluginType, class ClassType>
+    friend class basic_thread_instance_accessor;
+    template <class ClassType, class PluginType>
+        requires std::has_virtual_destructor_v<ClassType>
+    friend class plugin_object_pool;
+    friend std::vector<plugin_memory_footprint> memory_footprints(std::span<const plugin_base* const> plugins);
+    friend std::vector<plugin_memory_sharing> memory_sharings(int process_id,
+                                                              std::span<const plugin_base* const> plugins);
+
     plugin_base(const plugin_base&) = delete;
     plugin_base& operator=(const plugin_base&) = delete;
 
-protected:
-    void* handle_ = nullptr;
+    std::atomic<private_::loaded_library*> library_ = nullptr;
+    std::atomic<std::uint64_t> load_id_ = 0;
 };
 
+/**
+ * @brief wait_for_background_unloads Wait for the end of the closes of the plugins unloaded in background.
+ */
+void wait_for_background_unloads();
+
 } // namespace plug
 } // namespace arba
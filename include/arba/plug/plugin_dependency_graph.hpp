@@ -0,0 +1,95 @@
+#pragma once
+
+#include "load_options.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The plugin_load_spec struct declares a plugin to load and the plugins it needs to be loaded first.
+ */
+struct plugin_load_spec
+{
+    std::string name;
+    std::filesystem::path plugin_path;
+    // Names of the plugins to load before this one.
+    std::vector<std::string> dependencies;
+    plugin_load_options options;
+};
+
+/**
+ * @brief read_plugin_manifest Read the plugins to load from a manifest file.
+ * @param manifest_path The path to the manifest file.
+ * @return The load specifications of the plugins, in the order of the file.
+ * @throw std::runtime_error If the file cannot be read or if a line is invalid.
+ * @details Each line declares a plugin with its name, its path and the names of its dependencies, separated by
+ * spaces: 'name path [dependency...]'. Empty lines and lines starting with '#' are ignored. Relative paths are
+ * relative to the directory of the manifest file.
+ */
+[[nodiscard]] std::vector<plugin_load_spec> read_plugin_manifest(const std::filesystem::path& manifest_path);
+
+/**
+ * @brief The plugin_dependency_graph class is the directed acyclic graph of the dependencies of plugins to load.
+ * @details The nodes are the indexes of the load specifications given to the constructor.
+ */
+class plugin_dependency_graph
+{
+public:
+    /**
+     * @brief plugin_dependency_graph Build the graph of a set of plugins to load.
+     * @param specs The plugins to load.
+     * @param loaded_names The names of the plugins already loaded, which satisfy the dependencies on them.
+     * @throw std::invalid_argument If a name is used twice, if a dependency is unknown, or if the dependencies
+     * contain a cycle (the cycle is written in the message).
+     */
+    explicit plugin_dependency_graph(std::span<const plugin_load_spec> specs,
+                                     std::span<const std::string_view> loaded_names = {});
+
+    [[nodiscard]] inline std::size_t size() const noexcept { return nodes_.size(); }
+
+    /**
+     * @brief dependency_count The number of plugins of the graph to load before a plugin.
+     */
+    [[nodiscard]] inline std::size_t dependency_count(std::size_t node) const noexcept
+    {
+        return nodes_[node].dependencies.size();
+    }
+
+    /**
+     * @brief dependents The plugins of the graph depending on a plugin.
+     */
+    [[nodiscard]] inline std::span<const std::size_t> dependents(std::size_t node) const noexcept
+    {
+        return nodes_[node].dependents;
+    }
+
+    /**
+     * @brief topological_order The plugins in an order where each plugin comes after its dependencies.
+     */
+    [[nodiscard]] inline const std::vector<std::size_t>& topological_order() const noexcept
+    {
+        return topological_order_;
+    }
+
+private:
+    struct node_
+    {
+        std::vector<std::size_t> dependencies;
+        std::vector<std::size_t> dependents;
+    };
+
+    std::vector<node_> nodes_;
+    std::vector<std::size_t> topological_order_;
+};
+
+} // namespace plug
+} // namespace arba
@@ -1,8 +1,16 @@
 #pragma once
 
+#include "bound_function.hpp"
+#include "function_table.hpp"
+#include "instance_accessor.hpp"
+#include "instance_batch.hpp"
 #include "plugin_base.hpp"
+#include "plugin_trace.hpp"
+#include "read_section.hpp"
+#include "tracked_function.hpp"
 
 #include <filesystem>
+#include <format>
 #include <memory>
 #include <type_traits>
 
@@ -20,12 +28,92 @@ class plugin_impl : public plugin_base
 protected:
     inline plugin_impl() {}
 
-    explicit plugin_impl(const std::filesystem::path& plugin_path) : plugin_base(plugin_path) {}
+    explicit plugin_impl(const std::filesystem::path& plugin_path, const plugin_load_options& options = {})
+        : plugin_base(plugin_path, options)
+    {
+    }
 
 public:
     plugin_impl(plugin_impl&&) = default;
     plugin_impl& operator=(plugin_impl&&) = default;
 
+    /**
+     * @brief bind_function Find the function with a given name and bind it in a callable.
+     * @tparam FunctionSignatureType Signature of the searched function. (i.e. void(*)(int))
+     * @param function_name The name of the searched function.
+     * @return A bound_function calling the found function.
+     * @details The function is found with find_function_ptr() of PluginType, so it is checked like it.
+     * When the library is built with ARBA_PLUG_ENABLE_INSTRUMENTATION, the calls of the bound function are counted
+     * and timed (see snapshot_call_stats()).
+     */
+    template <typename FunctionSignatureType>
+    bound_function<FunctionSignatureType> bind_function(std::string_view function_name)
+    {
+        PluginType& self = static_cast<PluginType&>(*this);
+        FunctionSignatureType function = self.template find_function_ptr<FunctionSignatureType>(function_name);
+#ifdef ARBA_PLUG_ENABLE_INSTRUMENTATION
+        return bound_function<FunctionSignatureType>(function,
+                                                     &register_symbol_call_stats(this->plugin_path(), function_name));
+#else
+        return bound_function<FunctionSignatureType>(function);
+#endif
+    }
+
+    /**
+     * @brief bind_tracked_function Find the function with a given name and bind it in a callable whose calls are
+     * tracked, so that the plugin is not closed during a call.
+     * @tparam FunctionSignatureType Signature of the searched function. (i.e. void(*)(int))
+     * @param function_name The name of the searched function.
+     * @return A tracked_function calling the found function.
+     * @throw plugin_find_symbol_error If the function is not found or if no plugin is loaded by this instance.
+     * @details The function is found with find_function_ptr() of PluginType, so it is checked like it.
+     */
+    template <typename FunctionSignatureType>
+    tracked_function<FunctionSignatureType> bind_tracked_function(std::string_view function_name)
+    {
+        PluginType& self = static_cast<PluginType&>(*this);
+        private_::read_section section;
+        for (;;)
+        {
+            std::shared_ptr<call_tracker> tracker = this->find_call_tracker();
+            FunctionSignatureType function = self.template find_function_ptr<FunctionSignatureType>(function_name);
+            // If the plugin was reloaded during the search, the function may not be tracked by the tracker.
+            if (tracker && tracker == this->find_call_tracker()) [[likely]]
+                return tracked_function<FunctionSignatureType>(function, std::move(tracker));
+        }
+    }
+
+    /**
+     * @brief find_function_table Find the function table exported by the plugin and check it.
+     * @tparam FunctionTableType The table type, declared with ARBA_PLUG_DECLARE_FUNCTION_TABLE().
+     * @return A reference to the table of the plugin, valid until the plugin is unloaded.
+     * @throw plugin_find_symbol_error If the plugin does not export the table.
+     * @throw std::runtime_error If the version, the size or the signature hash of the exported table is not the one
+     * of FunctionTableType.
+     * @details All the functions of the table are found with one symbol lookup and checked with one hash comparison,
+     * whatever the plugin type.
+     */
+    template <typename FunctionTableType>
+        requires function_table_type<FunctionTableType>
+    const FunctionTableType& find_function_table()
+    {
+        using TableGetter = const function_table_header* (*)();
+        private_::read_section section;
+        const std::string getter_name =
+            std::string(private_::function_table_fname_prefix).append(FunctionTableType::table_name);
+        TableGetter getter = reinterpret_cast<TableGetter>(this->find_symbol_pointer(getter_name));
+        const function_table_header* header = getter();
+        if (header->version != FunctionTableType::version || header->table_size != sizeof(FunctionTableType)
+            || header->signature_hash != FunctionTableType::signature_hash) [[unlikely]]
+        {
+            throw std::runtime_error(std::format("Function table '{}' of plugin (version {}) is not the requested "
+                                                 "function table (version {}).",
+                                                 FunctionTableType::table_name, header->version,
+                                                 FunctionTableType::version));
+        }
+        return reinterpret_cast<const function_table<FunctionTableType>*>(header)->functions;
+    }
+
     static constexpr std::string_view default_instance_ref_func_name = "instance_ref";
 
     /**
@@ -40,6 +128,7 @@ public:
     template <typename InstanceType>
     InstanceType& instance_ref(const std::string_view getter_function_name = default_instance_ref_func_name)
     {
+        trace_scope trace("factory", "instance_ref", getter_function_name);
         using MainObjectGetter = InstanceType& (*)();
         PluginType& self = static_cast<PluginType&>(*this);
         MainObjectGetter getter = self.template find_function_ptr<MainObjectGetter>(getter_function_name);
@@ -60,12 +149,70 @@ public:
     template <typename InstanceType>
     const InstanceType& instance_cref(const std::string_view getter_function_name = default_instance_cref_func_name)
     {
+        trace_scope trace("factory", "instance_cref", getter_function_name);
         using MainObjectMaker = const InstanceType& (*)();
         PluginType& self = static_cast<PluginType&>(*this);
         MainObjectMaker getter = self.template find_function_ptr<MainObjectMaker>(getter_function_name);
         return getter();
     }
 
+    /**
+     * @brief bind_instance_ref Find a function returning a reference to a global variable, and cache the reference
+     * until the plugin is unloaded or reloaded.
+     * @tparam InstanceType The type of the global variable.
+     * @param getter_function_name The name of the global variable getter function to find in the plugin.
+     * @return An accessor to the global instance, which calls the getter once per load of the plugin.
+     * @throw plugin_find_symbol_error If the getter function is not found.
+     * @details The signature of the global variable getter function is expected to be InstanceType&(*)().
+     * @warning There is no guarantee that the global variable getter function returns the wanted type.
+     */
+    template <typename InstanceType>
+    basic_instance_accessor<PluginType, InstanceType>
+    bind_instance_ref(const std::string_view getter_function_name = default_instance_ref_func_name)
+    {
+        return basic_instance_accessor<PluginType, InstanceType>(static_cast<PluginType&>(*this),
+                                                                 getter_function_name);
+    }
+
+    /**
+     * @brief bind_instance_cref Find a function returning a const reference to a global variable, and cache the
+     * reference until the plugin is unloaded or reloaded.
+     * @tparam InstanceType The type of the global variable.
+     * @param getter_function_name The name of the global variable getter function to find in the plugin.
+     * @return An accessor to the global instance, which calls the getter once per load of the plugin.
+     * @throw plugin_find_symbol_error If the getter function is not found.
+     * @details The signature of the global variable getter function is expected to be const InstanceType&(*)().
+     * @warning There is no guarantee that the global variable getter function returns the wanted type.
+     */
+    template <typename InstanceType>
+    basic_instance_accessor<PluginType, const InstanceType>
+    bind_instance_cref(const std::string_view getter_function_name = default_instance_cref_func_name)
+    {
+        return basic_instance_accessor<PluginType, const InstanceType>(static_cast<PluginType&>(*this),
+                                                                       getter_function_name);
+    }
+
+    static constexpr std::string_view default_make_thread_instance_func_name = "make_thread_instance";
+
+    /**
+     * @brief bind_thread_instance Find a function making a new instance stored in a std::unique_ptr, to give each
+     * thread its own instance.
+     * @tparam ClassType The type of the made instances.
+     * @param maker_function_name The name of the maker function to find in the plugin.
+     * @return An accessor making the instance of a thread at its first access.
+     * @throw plugin_find_symbol_error If the maker function is not found.
+     * @details The signature of the maker function is expected to be std::unique_ptr<ClassType>(*)().
+     * @warning There is no guarantee that the maker function returns the wanted type.
+     */
+    template <typename ClassType>
+        requires std::has_virtual_destructor_v<ClassType>
+    basic_thread_instance_accessor<PluginType, ClassType>
+    bind_thread_instance(const std::string_view maker_function_name = default_make_thread_instance_func_name)
+    {
+        return basic_thread_instance_accessor<PluginType, ClassType>(static_cast<PluginType&>(*this),
+                                                                     maker_function_name);
+    }
+
     static constexpr std::string_view default_make_unique_func_name = "make_unique_instance";
 
     /**
@@ -82,6 +229,7 @@ public:
     std::unique_ptr<ClassType>
     make_unique_instance(const std::string_view maker_function_name = default_make_unique_func_name)
     {
+        trace_scope trace("factory", "make_unique_instance", maker_function_name);
         using InstanceMaker = std::unique_ptr<ClassType> (*)();
         PluginType& self = static_cast<PluginType&>(*this);
         InstanceMaker maker = self.template find_function_ptr<InstanceMaker>(maker_function_name);
@@ -104,6 +252,7 @@ public:
         requires std::has_virtual_destructor_v<ClassType> && (sizeof...(ArgsT) > 0)
     std::unique_ptr<ClassType> make_unique_instance(const std::string_view maker_function_name, ArgsT... args)
     {
+        trace_scope trace("factory", "make_unique_instance", maker_function_name);
         using InstanceMaker = std::unique_ptr<ClassType> (*)(ArgsT...);
         PluginType& self = static_cast<PluginType&>(*this);
         InstanceMaker maker = self.template find_function_ptr<InstanceMaker>(maker_function_name);
@@ -126,6 +275,7 @@ public:
     std::shared_ptr<ClassType>
     make_shared_instance(const std::string_view maker_function_name = default_make_shared_func_name)
     {
+        trace_scope trace("factory", "make_shared_instance", maker_function_name);
         using InstanceMaker = std::shared_ptr<ClassType> (*)();
         PluginType& self = static_cast<PluginType&>(*this);
         InstanceMaker maker = self.template find_function_ptr<InstanceMaker>(maker_function_name);
@@ -148,11 +298,99 @@ public:
         requires std::has_virtual_destructor_v<ClassType> && (sizeof...(ArgsT) > 0)
     std::shared_ptr<ClassType> make_shared_instance(const std::string_view maker_function_name, ArgsT... args)
     {
+        trace_scope trace("factory", "make_shared_instance", maker_function_name);
         using InstanceMaker = std::shared_ptr<ClassType> (*)(ArgsT...);
         PluginType& self = static_cast<PluginType&>(*this);
         InstanceMaker maker = self.template find_function_ptr<InstanceMaker>(maker_function_name);
         return maker(args...);
     }
+
+    static constexpr std::string_view default_make_instances_func_name = "make_instances";
+
+    /**
+     * @brief make_instances Find a function making a batch of instances and call it once to make them all.
+     * @tparam ClassType The type of the made instances.
+     * @param count The number of instances to make.
+     * @param batch_maker_function_name The name of the batch maker function to find in the plugin.
+     * @param maker_function_name The name of the maker function used when the plugin has no batch maker.
+     * @return An instance_batch<ClassType> holding the made instances.
+     * @details The signature of the batch maker function is expected to be instance_batch<ClassType>(*)(std::size_t).
+     * If it is not found, the maker function (std::unique_ptr<ClassType>(*)()) is found once and called count times.
+     * @warning There is no guarantee that the maker functions return the wanted type.
+     */
+    template <typename ClassType>
+        requires std::has_virtual_destructor_v<ClassType>
+    instance_batch<ClassType>
+    make_instances(std::size_t count,
+                   const std::string_view batch_maker_function_name = default_make_instances_func_name,
+                   const std::string_view maker_function_name = default_make_unique_func_name)
+    {
+        trace_scope trace("factory", "make_instances", batch_maker_function_name);
+        using BatchMaker = instance_batch<ClassType> (*)(std::size_t);
+        using InstanceMaker = std::unique_ptr<ClassType> (*)();
+        PluginType& self = static_cast<PluginType&>(*this);
+        if (BatchMaker batch_maker = find_batch_maker_<BatchMaker>(batch_maker_function_name))
+            return batch_maker(count);
+        InstanceMaker maker = self.template find_function_ptr<InstanceMaker>(maker_function_name);
+        return make_instances_one_by_one_<ClassType>(count, [maker] { return maker(); });
+    }
+
+    /**
+     * @brief make_instances Find a function making a batch of instances and call it once to make them all.
+     * @tparam ClassType The type of the made instances.
+     * @tparam ArgsT... The types of the arguments to pass to the maker functions.
+     * @param count The number of instances to make.
+     * @param batch_maker_function_name The name of the batch maker function to find in the plugin.
+     * @param maker_function_name The name of the maker function used when the plugin has no batch maker.
+     * @param args The arguments to pass to the maker functions.
+     * @return An instance_batch<ClassType> holding the made instances.
+     * @details The signature of the batch maker function is expected to be
+     * instance_batch<ClassType>(*)(std::size_t, ArgsT...). If it is not found, the maker function
+     * (std::unique_ptr<ClassType>(*)(ArgsT...)) is found once and called count times with args.
+     * @warning There is no guarantee that the maker functions return the wanted type.
+     * @warning All args types must be explicitly provided. (make_instances<InstanceType, Parameter1Type>(...))
+     */
+    template <typename ClassType, typename... ArgsT>
+        requires std::has_virtual_destructor_v<ClassType> && (sizeof...(ArgsT) > 0)
+    instance_batch<ClassType> make_instances(std::size_t count, const std::string_view batch_maker_function_name,
+                                             const std::string_view maker_function_name, ArgsT... args)
+    {
+        trace_scope trace("factory", "make_instances", batch_maker_function_name);
+        using BatchMaker = instance_batch<ClassType> (*)(std::size_t, ArgsT...);
+        using InstanceMaker = std::unique_ptr<ClassType> (*)(ArgsT...);
+        PluginType& self = static_cast<PluginType&>(*this);
+        if (BatchMaker batch_maker = find_batch_maker_<BatchMaker>(batch_maker_function_name))
+            return batch_maker(count, args...);
+        InstanceMaker maker = self.template find_function_ptr<InstanceMaker>(maker_function_name);
+        return make_instances_one_by_one_<ClassType>(count, [&] { return maker(args...); });
+    }
+
+private:
+    template <typename BatchMaker>
+    BatchMaker find_batch_maker_(const std::string_view batch_maker_function_name)
+    {
+        PluginType& self = static_cast<PluginType&>(*this);
+        try
+        {
+            return self.template find_function_ptr<BatchMaker>(batch_maker_function_name);
+        }
+        catch (const plugin_find_symbol_error&)
+        {
+            return nullptr;
+        }
+    }
+
+    template <typename ClassType, typename MakeFunction>
+    static instance_batch<ClassType> make_instances_one_by_one_(std::size_t count, MakeFunction make_function)
+    {
+        auto owners = std::make_shared<std::vector<std::unique_ptr<ClassType>>>();
+        owners->reserve(count);
+        std::vector<ClassType*> instances;
+        instances.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            instances.push_back(owners->emplace_back(make_function()).get());
+        return instance_batch<ClassType>(std::move(owners), std::move(instances));
+    }
 };
 
 } // namespace plug
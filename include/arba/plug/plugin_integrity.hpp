@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The content_digest type is a SHA-256 digest, in the byte order of its hexadecimal form.
+ */
+using content_digest = std::array<std::uint8_t, 32>;
+
+/**
+ * @brief content_hash Hash a content with SHA-256.
+ * @details The blocks are compressed with the SHA extensions of the CPU when it has them (x86-64 SHA-NI, detected at
+ * the first call), which hash at more than 1 GB/s per thread, and with a portable implementation otherwise. The
+ * digests are the ones of sha256sum.
+ */
+[[nodiscard]] content_digest content_hash(std::span<const std::byte> content) noexcept;
+
+/**
+ * @brief hash_plugin_file Hash the content of a file with content_hash().
+ * @details The file is mapped in memory rather than read in a buffer (except on Windows).
+ * @throw plugin_integrity_error If the file cannot be read.
+ */
+[[nodiscard]] content_digest hash_plugin_file(const std::filesystem::path& file_path);
+
+/**
+ * @brief to_hex_string The lowercase hexadecimal form of a digest, as written by sha256sum.
+ */
+[[nodiscard]] std::string to_hex_string(const content_digest& digest);
+
+/**
+ * @brief The plugin_integrity_verifier class checks that plugin files have the content hash written in a manifest,
+ * before they are loaded (see plugin_load_options::integrity_verifier).
+ * @details The manifest is the output of sha256sum: each line is the hexadecimal digest of a file, then its path,
+ * relative to the directory of the manifest (optionally prefixed by '*'). Empty lines and lines starting with '#' are
+ * ignored.
+ * The verified digests are cached with the device, the inode, the size, the modification time and the status change
+ * time of their file: a file whose attributes did not change is not hashed again. The status change time is set by
+ * the system at each write and cannot be set by the owner of the file, so a file rewritten with its old modification
+ * time is hashed again (on POSIX systems). The cache can be saved in a file and read at the next start, so that
+ * unchanged plugins are verified with one stat() call.
+ * The verifications can be called concurrently.
+ * @warning The file is verified then loaded by path: it must not be replaced between the two by someone who can
+ * write in its directory. The cache file is trusted like the manifest: it must only be writable by the users trusted
+ * to deploy the plugins, else no cache file must be used (the default). On Windows, the status change time is not
+ * read: the cache only saves time there, it is not a security boundary.
+ */
+class plugin_integrity_verifier
+{
+public:
+    /**
+     * @brief plugin_integrity_verifier Read a manifest and an optional cache file.
+     * @param manifest_path The path to the manifest file.
+     * @param cache_path The path to the cache file, read if it exists and written by save_cache(). No cache file is
+     * used if it is empty.
+     * @throw plugin_integrity_error If the manifest cannot be read or if a line is invalid. An invalid cache file is
+     * ignored.
+     */
+    explicit plugin_integrity_verifier(const std::filesystem::path& manifest_path,
+                                       std::filesystem::path cache_path = {});
+
+    /**
+     * @brief verify Check the content hash of a plugin file.
+     * @param plugin_path The path to the plugin file, with its extension.
+     * @throw plugin_integrity_error If the file is not in the manifest, if it cannot be read, or if its content hash
+     * is not the one of the manifest.
+     */
+    void verify(const std::filesystem::path& plugin_path);
+
+    /**
+     * @brief verify_all Check the content hashes of several plugin files in parallel.
+     * @param plugin_paths The paths to the plugin files, with their extension.
+     * @param max_thread_count The maximum number of threads hashing files, the calling thread included.
+     * @throw plugin_integrity_error If a file is not valid (see verify()). The message lists all the invalid files.
+     */
+    void verify_all(std::span<const std::filesystem::path> plugin_paths,
+                    std::size_t max_thread_count = std::thread::hardware_concurrency());
+
+    /**
+     * @brief save_cache Write the cached digests in the cache file, if there is one.
+     * @throw plugin_integrity_error If the cache file cannot be written.
+     */
+    void save_cache() const;
+
+    /**
+     * @brief manifest_size The number of files of the manifest.
+     */
+    [[nodiscard]] inline std::size_t manifest_size() const noexcept { return manifest_.size(); }
+
+    /**
+     * @brief hashed_file_count The number of files hashed by the verifications (the other ones were found in the
+     * cache).
+     */
+    [[nodiscard]] std::size_t hashed_file_count() const;
+
+private:
+    struct file_attributes_
+    {
+        std::uint64_t device = 0;
+        std::uint64_t inode = 0;
+        std::uint64_t size = 0;
+        std::int64_t modification_time = 0;
+        std::int64_t change_time = 0;
+
+        bool operator==(const file_attributes_&) const = default;
+    };
+
+    struct cache_entry_
+    {
+        file_attributes_ attributes;
+        content_digest digest{};
+    };
+
+    static file_attributes_ read_attributes_(const std::filesystem::path& file_path);
+    static std::string make_key_(const std::filesystem::path& file_path);
+    void read_cache_();
+
+    std::filesystem::path cache_path_;
+    // The expected digests, by absolute normalized path.
+    std::unordered_map<std::string, content_digest> manifest_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, cache_entry_> cache_;
+    std::size_t hashed_file_count_ = 0;
+};
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,377 @@
+#pragma once
+
+#include "plugin.hpp"
+#include "plugin_dependency_graph.hpp"
+#include "run_on_threads.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The plugin_load_report_entry struct describes the load of one plugin of a plugin manager.
+ */
+struct plugin_load_report_entry
+{
+    std::string name;
+    std::filesystem::path plugin_path;
+    plugin_load_stats load_stats;
+};
+
+/**
+ * @brief The plugin_memory_report_entry struct describes the memory used by one plugin of a plugin manager.
+ */
+struct plugin_memory_report_entry
+{
+    std::string name;
+    std::filesystem::path plugin_path;
+    plugin_memory_footprint memory_footprint;
+};
+
+/**
+ * @brief The plugin_initialize_status enum tells how the initialization of a plugin ended.
+ */
+enum class plugin_initialize_status : std::uint8_t
+{
+    // The load hook of the plugin returned, or the plugin has no load hook.
+    initialized,
+    // The plugin was initialized before.
+    already_initialized,
+    // The load hook of the plugin threw an exception.
+    failed,
+    // The time limit was reached before the initialization of the plugin started.
+    timed_out,
+};
+
+/**
+ * @brief The plugin_initialize_report_entry struct describes the initialization of one plugin of a plugin manager.
+ */
+struct plugin_initialize_report_entry
+{
+    std::string name;
+    plugin_initialize_status status = plugin_initialize_status::initialized;
+    // Wall time of the load hook of the plugin.
+    std::chrono::nanoseconds initialize_duration{ 0 };
+    // The message of the exception thrown by the load hook, if it failed.
+    std::string error_message;
+    // The exception thrown by the load hook, if it failed.
+    std::exception_ptr error;
+};
+
+/**
+ * @brief The basic_plugin_manager class owns a set of named plugins.
+ * @tparam PluginType The plugin class used to load the plugins (plugin, safe_plugin, ...).
+ * @details Plugins are unloaded in the reverse order of their loading, so a plugin loaded by load_all() is unloaded
+ * before its dependencies.
+ */
+template <class PluginType>
+class basic_plugin_manager
+{
+public:
+    using plugin_type = PluginType;
+
+    basic_plugin_manager() = default;
+    basic_plugin_manager(basic_plugin_manager&&) = default;
+
+    basic_plugin_manager& operator=(basic_plugin_manager&& other)
+    {
+        if (&other != this)
+        {
+            clear();
+            entries_ = std::move(other.entries_);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief ~basic_plugin_manager destructor which unloads the plugins in the reverse order of their loading.
+     */
+    ~basic_plugin_manager() { clear(); }
+
+    /**
+     * @brief load Load a plugin and give it a name.
+     * @param name The name of the plugin in the manager.
+     * @param plugin_path The path to the plugin to load (extension of the file is optional).
+     * @param options The optional steps of the load.
+     * @return A reference to the loaded plugin.
+     * @throw std::invalid_argument If a plugin with the same name is already managed.
+     * @throw plugin_load_error If there is a problem during loading.
+     */
+    PluginType& load(std::string_view name, const std::filesystem::path& plugin_path,
+                     const plugin_load_options& options = {})
+    {
+        if (contains(name)) [[unlikely]]
+            throw std::invalid_argument(std::format("A plugin named '{}' is already loaded.", name));
+        auto plugin_uptr = std::make_unique<PluginType>(plugin_path, options);
+        return *entries_.emplace_back(entry_{ .name = std::string(name), .plugin = std::move(plugin_uptr) }).plugin;
+    }
+
+    /**
+     * @brief load_all Load a set of plugins, each one after its dependencies, with independent plugins loaded in
+     * parallel.
+     * @param specs The plugins to load. Their dependencies are names of plugins of specs or already managed.
+     * @param max_thread_count The maximum number of threads loading plugins, the calling thread included.
+     * @throw std::invalid_argument If a name is already used, if a dependency is unknown, or if the dependencies
+     * contain a cycle. Nothing is loaded.
+     * @throw plugin_load_error If there is a problem during the loading of a plugin. The plugins of specs which were
+     * already loaded are unloaded, and the error of the first failed load is thrown.
+     * @details A plugin starts loading as soon as all its dependencies are loaded. The plugins are managed in the
+     * order their loads finish.
+     */
+    void load_all(std::span<const plugin_load_spec> specs,
+                  std::size_t max_thread_count = std::thread::hardware_concurrency())
+    {
+        const plugin_dependency_graph graph(specs, names());
+        const std::size_t first_loaded_index = entries_.size();
+        entries_.reserve(entries_.size() + specs.size());
+
+        std::mutex mutex;
+        std::condition_variable ready_condition;
+        std::vector<std::size_t> remaining_counts(graph.size());
+        std::vector<std::size_t> ready_nodes;
+        std::size_t pending_count = graph.size();
+        std::exception_ptr load_error;
+        for (std::size_t node = 0; node < graph.size(); ++node)
+            if ((remaining_counts[node] = graph.dependency_count(node)) == 0)
+                ready_nodes.push_back(node);
+
+        const auto load_ready_plugins = [&] {
+            std::unique_lock lock(mutex);
+            for (;;)
+            {
+                ready_condition.wait(lock, [&] { return !ready_nodes.empty() || pending_count == 0 || load_error; });
+                if (pending_count == 0 || load_error)
+                    return;
+                const std::size_t node = ready_nodes.back();
+                ready_nodes.pop_back();
+                lock.unlock();
+                std::unique_ptr<PluginType> plugin_uptr;
+                try
+                {
+                    plugin_uptr = std::make_unique<PluginType>(specs[node].plugin_path, specs[node].options);
+                }
+                catch (...)
+                {
+                    lock.lock();
+                    --pending_count;
+                    if (!load_error)
+                        load_error = std::current_exception();
+                    ready_condition.notify_all();
+                    continue;
+                }
+                lock.lock();
+                --pending_count;
+                entries_.push_back(entry_{ .name = specs[node].name, .plugin = std::move(plugin_uptr) });
+                for (std::size_t dependent : graph.dependents(node))
+                    if (--remaining_counts[dependent] == 0)
+                        ready_nodes.push_back(dependent);
+                ready_condition.notify_all();
+            }
+        };
+
+        private_::run_on_threads(std::min(max_thread_count, graph.size()), load_ready_plugins);
+
+        if (load_error) [[unlikely]]
+        {
+            while (entries_.size() > first_loaded_index)
+                entries_.pop_back();
+            std::rethrow_exception(load_error);
+        }
+    }
+
+    /**
+     * @brief initialize_all Initialize all the plugins (see plugin_base::initialize()), in parallel.
+     * @param max_thread_count The maximum number of threads running load hooks, the calling thread included.
+     * @param time_limit The time after which no more initialization is started. A running load hook cannot be
+     * interrupted: the function returns once the started ones are finished.
+     * @return The initialization of all the plugins, sorted by decreasing initialization duration.
+     * @details The exceptions thrown by the load hooks, of any type, are caught and reported. The plugins are
+     * initialized in the order of their loading, but concurrently: a load hook must not rely on the load hook of
+     * another plugin.
+     */
+    std::vector<plugin_initialize_report_entry>
+    initialize_all(std::size_t max_thread_count = std::thread::hardware_concurrency(),
+                   std::chrono::nanoseconds time_limit = std::chrono::nanoseconds::max())
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+        const auto deadline = time_limit < std::chrono::steady_clock::time_point::max() - start_time
+                                  ? start_time + time_limit
+                                  : std::chrono::steady_clock::time_point::max();
+        std::vector<plugin_initialize_report_entry> report(entries_.size());
+        std::atomic_size_t next_index = 0;
+        const auto initialize_plugins = [&] {
+            for (std::size_t i = next_index++; i < entries_.size(); i = next_index++)
+            {
+                plugin_initialize_report_entry& report_entry = report[i];
+                report_entry.name = entries_[i].name;
+                if (std::chrono::steady_clock::now() >= deadline) [[unlikely]]
+                {
+                    report_entry.status = plugin_initialize_status::timed_out;
+                    continue;
+                }
+                try
+                {
+                    if (entries_[i].plugin->initialize())
+                        report_entry.initialize_duration = entries_[i].plugin->load_stats().initialize_duration;
+                    else
+                        report_entry.status = plugin_initialize_status::already_initialized;
+                }
+                catch (const std::exception& exception)
+                {
+                    report_entry.status = plugin_initialize_status::failed;
+                    report_entry.error_message = exception.what();
+                    report_entry.error = std::current_exception();
+                }
+                catch (...)
+                {
+                    // An exception escaping the worker thread would terminate the program.
+                    report_entry.status = plugin_initialize_status::failed;
+                    report_entry.error_message = "The load hook threw an exception which is not a std::exception.";
+                    report_entry.error = std::current_exception();
+                }
+            }
+        };
+        private_::run_on_threads(std::min(max_thread_count, entries_.size()), initialize_plugins);
+        std::ranges::stable_sort(report, std::ranges::greater{}, [](const plugin_initialize_report_entry& entry) {
+            return entry.initialize_duration;
+        });
+        return report;
+    }
+
+    /**
+     * @brief unload Unload the plugin with a given name.
+     * @param name The name of the plugin in the manager.
+     * @return true If a plugin with this name was managed.
+     */
+    bool unload(std::string_view name)
+    {
+        const auto iter = std::ranges::find_if(entries_, [name](const entry_& entry) { return entry.name == name; });
+        if (iter == entries_.end())
+            return false;
+        entries_.erase(iter);
+        return true;
+    }
+
+    /**
+     * @brief clear Unload all the plugins, in the reverse order of their loading.
+     */
+    void clear()
+    {
+        while (!entries_.empty())
+            entries_.pop_back();
+    }
+
+    /**
+     * @brief find Find the plugin with a given name.
+     * @return A pointer to the plugin, or nullptr if no plugin has this name.
+     */
+    [[nodiscard]] PluginType* find(std::string_view name) noexcept
+    {
+        const auto iter = std::ranges::find_if(entries_, [name](const entry_& entry) { return entry.name == name; });
+        return iter != entries_.end() ? iter->plugin.get() : nullptr;
+    }
+
+    /**
+     * @brief get Get the plugin with a given name.
+     * @throw std::out_of_range If no plugin has this name.
+     */
+    [[nodiscard]] PluginType& get(std::string_view name)
+    {
+        PluginType* plugin_ptr = find(name);
+        if (!plugin_ptr) [[unlikely]]
+            throw std::out_of_range(std::format("No plugin named '{}' is loaded.", name));
+        return *plugin_ptr;
+    }
+
+    [[nodiscard]] inline bool contains(std::string_view name) const noexcept
+    {
+        return std::ranges::any_of(entries_, [name](const entry_& entry) { return entry.name == name; });
+    }
+
+    [[nodiscard]] inline std::size_t size() const noexcept { return entries_.size(); }
+    [[nodiscard]] inline bool empty() const noexcept { return entries_.empty(); }
+
+    /**
+     * @brief names The names of the plugins, in the order of their loading.
+     */
+    [[nodiscard]] std::vector<std::string_view> names() const
+    {
+        std::vector<std::string_view> result;
+        result.reserve(entries_.size());
+        for (const entry_& entry : entries_)
+            result.push_back(entry.name);
+        return result;
+    }
+
+    /**
+     * @brief load_report Rank the plugins by startup cost.
+     * @return The load statistics of all the plugins, sorted by decreasing load duration.
+     */
+    [[nodiscard]] std::vector<plugin_load_report_entry> load_report() const
+    {
+        std::vector<plugin_load_report_entry> report;
+        report.reserve(entries_.size());
+        for (const entry_& entry : entries_)
+            report.push_back(plugin_load_report_entry{ .name = entry.name,
+                                                       .plugin_path = entry.plugin->plugin_path(),
+                                                       .load_stats = entry.plugin->load_stats() });
+        std::ranges::stable_sort(report, std::ranges::greater{},
+                                 [](const plugin_load_report_entry& entry) { return entry.load_stats.load_duration; });
+        return report;
+    }
+
+    /**
+     * @brief memory_report Rank the plugins by memory usage, to find the ones to unload or replace.
+     * @return The memory footprints of all the plugins, sorted by decreasing resident bytes.
+     */
+    [[nodiscard]] std::vector<plugin_memory_report_entry> memory_report() const
+    {
+        std::vector<const plugin_base*> plugins;
+        plugins.reserve(entries_.size());
+        for (const entry_& entry : entries_)
+            plugins.push_back(entry.plugin.get());
+        std::vector<plugin_memory_footprint> footprints = memory_footprints(plugins);
+
+        std::vector<plugin_memory_report_entry> report;
+        report.reserve(entries_.size());
+        for (std::size_t i = 0; i < entries_.size(); ++i)
+            report.push_back(plugin_memory_report_entry{ .name = entries_[i].name,
+                                                         .plugin_path = entries_[i].plugin->plugin_path(),
+                                                         .memory_footprint = std::move(footprints[i]) });
+        std::ranges::stable_sort(report, std::ranges::greater{}, [](const plugin_memory_report_entry& entry) {
+            return entry.memory_footprint.resident_bytes();
+        });
+        return report;
+    }
+
+private:
+    struct entry_
+    {
+        std::string name;
+        std::unique_ptr<PluginType> plugin;
+    };
+
+    std::vector<entry_> entries_;
+};
+
+using plugin_manager = basic_plugin_manager<plugin>;
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,272 @@
+#pragma once
+
+#include "call_tracker.hpp"
+#include "exception.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The plugin_object_pool class recycles instances made by a plugin factory.
+ * @tparam ClassType The type of the pooled instances (the interface class known by the host).
+ * @tparam PluginType The plugin class used to find the factory (plugin, safe_plugin, ...).
+ * @details Instances are handed out through RAII handles. When a handle is released, its instance is reset and
+ * pushed to the free list of the releasing thread, so acquire() and release never take a lock once the free list of
+ * the thread exists. Each free list keeps at most high_water_mark() instances: extra instances are destroyed.
+ * The pool is bound to the load of the plugin it was made with (see plugin_base::load_id()): the factory and the
+ * reset function are found once, and are not found again if the plugin is reloaded. When the plugin is unloaded or
+ * reloaded, the free instances of all the threads are destroyed while the code of the plugin is still mapped (see
+ * call_tracker::add_release_callback()), and acquire() throws.
+ * @warning A handle released once the plugin is released drops its instance without destroying it (its memory is
+ * leaked rather than calling unmapped code): release the handles before unloading the plugin. acquire() and the
+ * releases must not be called concurrently with unload() or load_from_file(). All handles must be released before
+ * the pool is destroyed.
+ */
+template <class ClassType, class PluginType>
+    requires std::has_virtual_destructor_v<ClassType>
+class plugin_object_pool
+{
+public:
+    using instance_maker_type = std::unique_ptr<ClassType> (*)();
+    using instance_reset_type = void (*)(ClassType&);
+
+    class handle_deleter
+    {
+    public:
+        handle_deleter() = default;
+        explicit handle_deleter(plugin_object_pool* pool) : pool_(pool) {}
+
+        void operator()(ClassType* instance) const { pool_->recycle_(instance); }
+
+    private:
+        plugin_object_pool* pool_ = nullptr;
+    };
+
+    using handle = std::unique_ptr<ClassType, handle_deleter>;
+
+    static constexpr std::string_view default_reset_func_name = "reset_instance";
+    static constexpr std::size_t default_high_water_mark = 64;
+
+    /**
+     * @brief Pool constructor which finds the factory (and the optional reset function) in the plugin.
+     * @param plugin The loaded plugin providing the factory.
+     * @param maker_function_name The name of the maker function to find in the plugin.
+     * @param reset_function_name The name of the optional reset function to find in the plugin.
+     * @param high_water_mark The maximum number of free instances kept by each thread.
+     * @details The signature of the maker function is expected to be std::unique_ptr<ClassType>(*)().
+     * The signature of the reset function is expected to be void(*)(ClassType&). If the plugin does not provide it,
+     * the instances are recycled as they are.
+     * @throw plugin_find_symbol_error If the maker function is not found.
+     */
+    explicit plugin_object_pool(PluginType& plugin,
+                                std::string_view maker_function_name = PluginType::default_make_unique_func_name,
+                                std::string_view reset_function_name = default_reset_func_name,
+                                std::size_t high_water_mark = default_high_water_mark)
+        : plugin_(&plugin), load_id_(plugin.load_id()), high_water_mark_(high_water_mark),
+          free_lists_(std::make_shared<free_lists_type_>())
+    {
+        maker_ = plugin.template find_function_ptr<instance_maker_type>(maker_function_name);
+        try
+        {
+            reset_ = plugin.template find_function_ptr<instance_reset_type>(reset_function_name);
+        }
+        catch (const plugin_find_symbol_error&)
+        {
+            reset_ = nullptr;
+        }
+        if (std::shared_ptr<call_tracker> tracker = plugin.find_call_tracker())
+        {
+            tracker->add_release_callback([weak_free_lists = std::weak_ptr<free_lists_type_>(free_lists_)] {
+                if (std::shared_ptr<free_lists_type_> free_lists = weak_free_lists.lock())
+                {
+                    std::lock_guard lock(free_lists->mutex);
+                    free_lists->destroy_instances();
+                    free_lists->released = true;
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief ~plugin_object_pool destructor which destroys all the free instances of all threads.
+     */
+    ~plugin_object_pool()
+    {
+        assert(outstanding_.load(std::memory_order_relaxed) == 0);
+        clear();
+    }
+
+    plugin_object_pool(const plugin_object_pool&) = delete;
+    plugin_object_pool& operator=(const plugin_object_pool&) = delete;
+
+    /**
+     * @brief acquire Take a free instance from the free list of the calling thread, or make a new one.
+     * @return A handle returning the instance to the pool when it is released.
+     * @throw plugin_unloaded_error If the plugin was unloaded or reloaded since the pool was made.
+     */
+    [[nodiscard]] handle acquire()
+    {
+        if (plugin_->load_id() != load_id_) [[unlikely]]
+            throw plugin_unloaded_error("The plugin of the pool was unloaded or reloaded.");
+#ifndef NDEBUG
+        outstanding_.fetch_add(1, std::memory_order_relaxed);
+#endif
+        std::vector<ClassType*>& free_list = local_free_list_();
+        if (!free_list.empty()) [[likely]]
+        {
+            ClassType* instance = free_list.back();
+            free_list.pop_back();
+            return handle(instance, handle_deleter(this));
+        }
+        return handle(maker_().release(), handle_deleter(this));
+    }
+
+    /**
+     * @brief clear Destroy all the free instances of all threads.
+     * @warning No other thread may use the pool during this call.
+     */
+    void clear()
+    {
+        std::lock_guard lock(free_lists_->mutex);
+        if (!free_lists_->released)
+            free_lists_->destroy_instances();
+    }
+
+    [[nodiscard]] inline std::size_t high_water_mark() const noexcept { return high_water_mark_; }
+    [[nodiscard]] inline bool has_reset_function() const noexcept { return reset_ != nullptr; }
+
+    /**
+     * @brief local_size The number of free instances held by the calling thread (0 if it has no free list).
+     */
+    [[nodiscard]] std::size_t local_size() const
+    {
+        const free_list_* free_list = find_local_free_list_();
+        return free_list ? free_list->instances.size() : 0;
+    }
+
+private:
+    struct free_list_
+    {
+        std::vector<ClassType*> instances;
+    };
+
+    // The free lists of all the threads, shared with the release callback of the plugin, which may be called after
+    // the pool is destroyed (ex: by the reaper thread of unload_in_background()).
+    struct free_lists_type_
+    {
+        // The mutex must be locked.
+        void destroy_instances()
+        {
+            for (std::shared_ptr<free_list_>& free_list : lists)
+            {
+                for (ClassType* instance : free_list->instances)
+                    delete instance;
+                free_list->instances.clear();
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<std::shared_ptr<free_list_>> lists;
+        // Set once the plugin is released: the instances cannot be destroyed anymore.
+        bool released = false;
+    };
+
+    void recycle_(ClassType* instance)
+    {
+#ifndef NDEBUG
+        outstanding_.fetch_sub(1, std::memory_order_relaxed);
+#endif
+        if (plugin_->load_id() != load_id_) [[unlikely]]
+        {
+            // The plugin is closed after its release callbacks, which lock the mutex: until then, its code is mapped.
+            std::lock_guard lock(free_lists_->mutex);
+            if (!free_lists_->released)
+                delete instance;
+            return;
+        }
+        std::vector<ClassType*>& free_list = local_free_list_();
+        if (free_list.size() < high_water_mark_) [[likely]]
+        {
+            if (reset_)
+                reset_(*instance);
+            free_list.push_back(instance);
+            return;
+        }
+        delete instance;
+    }
+
+    const free_list_* find_local_free_list_() const
+    {
+        if (local_pool_id_ == id_) [[likely]]
+            return local_last_free_list_;
+        if (auto iter = local_free_lists_.find(id_); iter != local_free_lists_.end())
+            return iter->second.lock().get();
+        return nullptr;
+    }
+
+    std::vector<ClassType*>& local_free_list_()
+    {
+        // Pool ids are never reused, so entries left by destroyed pools are never matched again.
+        if (local_pool_id_ == id_) [[likely]]
+            return local_last_free_list_->instances;
+
+        // The free lists are owned by their pool: the entries of the destroyed pools expire, and are pruned when the
+        // thread uses a new pool.
+        free_list_* free_list = nullptr;
+        if (auto iter = local_free_lists_.find(id_); iter != local_free_lists_.end())
+        {
+            free_list = iter->second.lock().get();
+        }
+        else
+        {
+            std::erase_if(local_free_lists_, [](const auto& entry) { return entry.second.expired(); });
+            std::shared_ptr<free_list_> new_free_list = std::make_shared<free_list_>();
+            new_free_list->instances.reserve(high_water_mark_);
+            free_list = new_free_list.get();
+            local_free_lists_.emplace(id_, new_free_list);
+            std::lock_guard lock(free_lists_->mutex);
+            free_lists_->lists.push_back(std::move(new_free_list));
+        }
+        local_pool_id_ = id_;
+        local_last_free_list_ = free_list;
+        return free_list->instances;
+    }
+
+    static std::uint64_t next_id_()
+    {
+        static std::atomic<std::uint64_t> id_counter = 0;
+        return ++id_counter;
+    }
+
+    // The free lists of the calling thread, by pool id, and the last one used.
+    inline static thread_local std::uint64_t local_pool_id_ = 0;
+    inline static thread_local free_list_* local_last_free_list_ = nullptr;
+    inline static thread_local std::unordered_map<std::uint64_t, std::weak_ptr<free_list_>> local_free_lists_;
+
+private:
+    PluginType* plugin_;
+    const std::uint64_t load_id_;
+    instance_maker_type maker_ = nullptr;
+    instance_reset_type reset_ = nullptr;
+    std::size_t high_water_mark_;
+    const std::uint64_t id_ = next_id_();
+    std::shared_ptr<free_lists_type_> free_lists_;
+#ifndef NDEBUG
+    std::atomic<std::size_t> outstanding_ = 0;
+#endif
+};
+
+} // namespace plug
+} // namespace arba
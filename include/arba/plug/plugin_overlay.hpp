@@ -0,0 +1,257 @@
+#pragma once
+
+#include "plugin.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+/**
+ * @brief The symbol_overlay_index class maps the names of the symbols defined by a stack of plugins to the address in
+ * the topmost plugin defining them.
+ * @details The index is a flat open addressing hash table (linear probing): a lookup hashes the name once and reads
+ * consecutive slots, however many plugins are stacked. Pushing a plugin inserts or overrides its symbols, erasing a
+ * plugin gives its symbols back to the plugins below it: the other symbols are not touched.
+ * The symbols are read from the GNU hash tables of the plugins: only the symbols defined by the plugins themselves
+ * (not by their dependencies) are indexed, and nothing is indexed on platforms without GNU hash tables.
+ */
+class symbol_overlay_index
+{
+public:
+    symbol_overlay_index();
+    symbol_overlay_index(symbol_overlay_index&&) noexcept;
+    symbol_overlay_index& operator=(symbol_overlay_index&&) noexcept;
+    ~symbol_overlay_index();
+
+    /**
+     * @brief push_back Index the symbols of a plugin above the plugins already indexed.
+     * @warning The plugin must stay loaded until it is erased from the index.
+     */
+    void push_back(const plugin_base& plugin);
+
+    /**
+     * @brief erase Remove a plugin from the index.
+     * @param layer_index The index of the plugin in the stack, from the bottom.
+     * @warning The plugin must still be loaded.
+     */
+    void erase(std::size_t layer_index);
+
+    /**
+     * @brief find Find the address of a symbol in the topmost plugin defining it.
+     * @return The address, or nullptr if no plugin defines the symbol.
+     */
+    [[nodiscard]] void* find(std::string_view symbol_name) const noexcept;
+
+    /**
+     * @brief find_layer Find the topmost plugin defining a symbol.
+     * @return The index of the plugin in the stack, or layer_count() if no plugin defines the symbol.
+     */
+    [[nodiscard]] std::size_t find_layer(std::string_view symbol_name) const noexcept;
+
+    [[nodiscard]] inline std::size_t layer_count() const noexcept { return layers_.size(); }
+    [[nodiscard]] inline std::size_t symbol_count() const noexcept { return symbol_count_; }
+
+private:
+    struct layer_;
+    struct slot_
+    {
+        std::string name;
+        std::size_t hash = 0;
+        void* address = nullptr;
+        // nullptr for an empty slot.
+        const layer_* layer = nullptr;
+    };
+
+    const slot_* find_slot_(std::string_view symbol_name, std::size_t hash) const noexcept;
+    void insert_(std::string_view symbol_name, void* address, const layer_* layer);
+    void remove_(const slot_& slot) noexcept;
+    void grow_();
+
+    std::vector<std::unique_ptr<layer_>> layers_;
+    std::vector<slot_> slots_;
+    std::size_t symbol_count_ = 0;
+};
+} // namespace private_
+
+/**
+ * @brief The basic_plugin_overlay class stacks named plugins, the upper ones overriding the symbols of the lower
+ * ones, like LD_PRELOAD does.
+ * @tparam PluginType The plugin class used to load the plugins (plugin, safe_plugin, ...).
+ * @details A symbol is resolved with one probe in a merged index of the symbols of all the plugins (see
+ * private_::symbol_overlay_index), which is updated incrementally when a plugin is pushed or erased. Only available
+ * on platforms with GNU hash tables (Linux).
+ * The lookups can be called concurrently with each other, but not with push_back(), erase() or clear().
+ * The plugins of the overlay are only given as const: the index holds the addresses of their symbols, so they must
+ * not be reloaded nor unloaded other than by erase() or clear().
+ */
+template <class PluginType = plugin>
+class basic_plugin_overlay
+{
+public:
+    using plugin_type = PluginType;
+
+    basic_plugin_overlay() = default;
+    basic_plugin_overlay(basic_plugin_overlay&&) = default;
+    basic_plugin_overlay& operator=(basic_plugin_overlay&& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            index_ = std::move(other.index_);
+            entries_ = std::move(other.entries_);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief ~basic_plugin_overlay Unload the plugins, from the top of the stack.
+     */
+    ~basic_plugin_overlay() { clear(); }
+
+    /**
+     * @brief push_back Load a plugin on top of the stack: its symbols override the symbols of the plugins below.
+     * @param name The name of the plugin in the overlay.
+     * @param plugin_path The path to the plugin to load (extension of the file is optional).
+     * @param options The optional steps of the load.
+     * @return The loaded plugin, as const since its symbols are indexed.
+     * @throw std::invalid_argument If a plugin with the same name is in the overlay.
+     * @throw plugin_load_error If the plugin cannot be loaded.
+     */
+    const PluginType& push_back(std::string name, const std::filesystem::path& plugin_path,
+                                const plugin_load_options& options = {})
+    {
+        if (contains(name)) [[unlikely]]
+            throw std::invalid_argument(std::format("A plugin named '{}' is already in the overlay.", name));
+        auto plugin_ptr = std::make_unique<PluginType>(plugin_path, options);
+        index_.push_back(*plugin_ptr);
+        return *entries_.emplace_back(entry_{ std::move(name), std::move(plugin_ptr) }).plugin;
+    }
+
+    /**
+     * @brief erase Unload the plugin with a given name: the symbols it overrode resolve to the plugins below again.
+     * @return true If a plugin with this name was in the overlay.
+     */
+    bool erase(std::string_view name)
+    {
+        const auto iter = std::ranges::find_if(entries_, [name](const entry_& entry) { return entry.name == name; });
+        if (iter == entries_.end())
+            return false;
+        index_.erase(iter - entries_.begin());
+        entries_.erase(iter);
+        return true;
+    }
+
+    /**
+     * @brief clear Unload all the plugins, from the top of the stack.
+     */
+    void clear()
+    {
+        while (!entries_.empty())
+        {
+            index_.erase(entries_.size() - 1);
+            entries_.pop_back();
+        }
+    }
+
+    /**
+     * @brief find_symbol_pointer Find the address of a symbol in the topmost plugin defining it.
+     * @return The address of the symbol, or nullptr if no plugin defines it.
+     */
+    [[nodiscard]] inline void* find_symbol_pointer(std::string_view symbol_name) const noexcept
+    {
+        return index_.find(symbol_name);
+    }
+
+    /**
+     * @brief find_function_ptr Find a function in the topmost plugin defining it.
+     * @tparam FunctionSignatureType Signature of the searched function. (i.e. int(*)(int))
+     * @throw plugin_find_symbol_error If no plugin defines the function.
+     */
+    template <typename FunctionSignatureType>
+    [[nodiscard]] FunctionSignatureType find_function_ptr(std::string_view function_name) const
+    {
+        void* function = index_.find(function_name);
+        if (!function) [[unlikely]]
+        {
+            const std::string message = std::format("No plugin of the overlay defines the function {}.", function_name);
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+            throw plugin_find_symbol_error(std::make_error_code(std::errc::invalid_argument), message);
+#else
+            throw plugin_find_symbol_error(message);
+#endif
+        }
+        return reinterpret_cast<FunctionSignatureType>(function);
+    }
+
+    /**
+     * @brief find_provider Find the topmost plugin defining a symbol.
+     * @return A pointer to the plugin, or nullptr if no plugin defines the symbol.
+     */
+    [[nodiscard]] const PluginType* find_provider(std::string_view symbol_name) const noexcept
+    {
+        const std::size_t layer_index = index_.find_layer(symbol_name);
+        return layer_index < entries_.size() ? entries_[layer_index].plugin.get() : nullptr;
+    }
+
+    /**
+     * @brief find Find the plugin with a given name.
+     * @return A pointer to the plugin, or nullptr if no plugin has this name.
+     */
+    [[nodiscard]] const PluginType* find(std::string_view name) const noexcept
+    {
+        const auto iter = std::ranges::find_if(entries_, [name](const entry_& entry) { return entry.name == name; });
+        return iter != entries_.end() ? iter->plugin.get() : nullptr;
+    }
+
+    [[nodiscard]] inline bool contains(std::string_view name) const noexcept
+    {
+        return std::ranges::any_of(entries_, [name](const entry_& entry) { return entry.name == name; });
+    }
+
+    [[nodiscard]] inline std::size_t size() const noexcept { return entries_.size(); }
+    [[nodiscard]] inline bool empty() const noexcept { return entries_.empty(); }
+
+    /**
+     * @brief symbol_count The number of distinct symbols defined by the plugins.
+     */
+    [[nodiscard]] inline std::size_t symbol_count() const noexcept { return index_.symbol_count(); }
+
+    /**
+     * @brief names The names of the plugins, from the bottom of the stack.
+     */
+    [[nodiscard]] std::vector<std::string_view> names() const
+    {
+        std::vector<std::string_view> result;
+        result.reserve(entries_.size());
+        for (const entry_& entry : entries_)
+            result.push_back(entry.name);
+        return result;
+    }
+
+private:
+    struct entry_
+    {
+        std::string name;
+        std::unique_ptr<PluginType> plugin;
+    };
+
+    private_::symbol_overlay_index index_;
+    std::vector<entry_> entries_;
+};
+
+using plugin_overlay = basic_plugin_overlay<plugin>;
+
+} // namespace plug
+} // namespace arba
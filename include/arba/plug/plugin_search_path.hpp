@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The plugin_search_path class resolves plugin names to plugin files in a list of directories, like
+ * LD_LIBRARY_PATH does for the dynamic loader.
+ * @details The directories are indexed once: a name is then resolved with one hash lookup, without touching the file
+ * system. A name is the file name of a plugin, with or without its extension (ex: "libconcat" or "libconcat.so"); if
+ * several directories contain it, the first directory wins. A missing name is also resolved by the index, so looking
+ * for a missing optional plugin again and again never touches the file system.
+ * On Linux, the directories are watched with inotify, and the index is rebuilt at the first lookup after a change (a
+ * lookup then only checks the watch without blocking). On the other platforms, refresh() must be called after a
+ * change. The directories which do not exist when the index is built are not watched.
+ * The lookups can be called concurrently.
+ */
+class plugin_search_path
+{
+public:
+    /**
+     * @brief plugin_search_path Index the plugins of a list of directories.
+     * @param directories The directories, by order of priority.
+     */
+    explicit plugin_search_path(std::vector<std::filesystem::path> directories);
+
+    /**
+     * @brief plugin_search_path Index the plugins of a list of directories written like LD_LIBRARY_PATH.
+     * @param directory_list The directories, separated by ':' (';' on Windows), by order of priority. Empty entries
+     * are ignored.
+     */
+    explicit plugin_search_path(std::string_view directory_list);
+
+    plugin_search_path(plugin_search_path&& other) noexcept;
+    plugin_search_path& operator=(plugin_search_path&& other) noexcept;
+    ~plugin_search_path();
+
+    /**
+     * @brief find Find the file of a plugin.
+     * @param plugin_name The file name of the plugin, with or without its extension. A name with a directory part is
+     * returned as is.
+     * @return The path to the plugin file (with its extension), or std::nullopt if no directory contains it.
+     */
+    [[nodiscard]] std::optional<std::filesystem::path> find(std::string_view plugin_name);
+
+    /**
+     * @brief resolve Find the file of a plugin.
+     * @param plugin_name The file name of the plugin, with or without its extension. A name with a directory part is
+     * returned as is.
+     * @return The path to the plugin file (with its extension), which can be given to plugin_base::load_from_file().
+     * @throw plugin_load_error If no directory contains the plugin.
+     */
+    [[nodiscard]] std::filesystem::path resolve(std::string_view plugin_name);
+
+    /**
+     * @brief refresh Index the directories again.
+     */
+    void refresh();
+
+    [[nodiscard]] inline const std::vector<std::filesystem::path>& directories() const noexcept
+    {
+        return directories_;
+    }
+
+    /**
+     * @brief plugin_count The number of distinct plugin files found in the directories.
+     */
+    [[nodiscard]] std::size_t plugin_count() const;
+
+    /**
+     * @brief index_build_count The number of times the directories were indexed (1 at construction).
+     */
+    [[nodiscard]] std::uint64_t index_build_count() const;
+
+private:
+    struct name_hash_
+    {
+        using is_transparent = void;
+        inline std::size_t operator()(std::string_view name) const noexcept
+        {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
+    void build_index_();
+    void watch_directories_();
+    void close_watch_() noexcept;
+    bool has_changes_() noexcept;
+
+    std::vector<std::filesystem::path> directories_;
+    mutable std::mutex mutex_;
+    // The plugin files, by file name with and without extension.
+    std::unordered_map<std::string, std::filesystem::path, name_hash_, std::equal_to<>> plugins_;
+    std::size_t plugin_count_ = 0;
+    std::uint64_t index_build_count_ = 0;
+    // The inotify descriptor watching the directories (-1 if they are not watched).
+    int watch_descriptor_ = -1;
+};
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The trace_event struct is a timed activity of the plugins recorded while tracing (see start_tracing()).
+ * @details The strings of an event are valid until the end of the program.
+ */
+struct trace_event
+{
+    // The kind of activity: "load", "unload", "initialize", "symbol", "factory" or "call".
+    std::string_view category;
+    std::string_view name;
+    // The plugin path or the symbol name the activity is about (may be empty).
+    std::string_view argument;
+    // The start of the activity, since the start of the program.
+    std::chrono::nanoseconds start{ 0 };
+    std::chrono::nanoseconds duration{ 0 };
+    // The index of the thread which recorded the event, in the order the threads recorded their first event.
+    std::uint32_t thread_index = 0;
+};
+
+namespace private_
+{
+extern std::atomic_bool tracing_enabled;
+
+/**
+ * @brief intern_trace_string Copy a string in a set living until the end of the program.
+ * @return A view on the copy, the same for equal strings.
+ * @details The strings already used by the calling thread are found in a cache of the thread, without lock: the set
+ * is only locked the first time a thread uses a string.
+ */
+std::string_view intern_trace_string(std::string_view text);
+
+/**
+ * @brief record_trace_event Add an event to the trace buffer of the calling thread.
+ * @details The buffer of a thread is only written by the thread: the event is published with one atomic store,
+ * without lock.
+ * @warning The strings must live until the end of the program (see intern_trace_string()).
+ */
+void record_trace_event(std::string_view category, std::string_view name, std::string_view argument,
+                        std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point end) noexcept;
+} // namespace private_
+
+/**
+ * @brief start_tracing Start recording the activity of the plugins: the loads, unloads and initializations, the
+ * symbol lookups, the calls of factories and, when the library is built with ARBA_PLUG_ENABLE_INSTRUMENTATION, the
+ * calls of the bound functions.
+ * @details When tracing is stopped, recording an activity costs one relaxed atomic load.
+ */
+void start_tracing() noexcept;
+
+/**
+ * @brief stop_tracing Stop recording the activity of the plugins. The recorded events are kept.
+ */
+void stop_tracing() noexcept;
+
+[[nodiscard]] inline bool is_tracing() noexcept
+{
+    return private_::tracing_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief snapshot_trace Copy the events recorded by all the threads.
+ * @return The events, by thread, then in the order each thread finished them.
+ * @details The events being recorded during the copy may be missing.
+ */
+[[nodiscard]] std::vector<trace_event> snapshot_trace();
+
+/**
+ * @brief clear_trace Remove the recorded events, and release the buffers of the finished threads.
+ * @warning No event must be recorded during the call (ex: tracing is stopped and no traced activity is running).
+ */
+void clear_trace();
+
+/**
+ * @brief write_chrome_trace Write the recorded events in the Chrome trace event format (JSON), which can be opened in
+ * Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+ * @details Each event is a complete event ("ph": "X") on the track of its thread.
+ */
+void write_chrome_trace(std::ostream& stream);
+
+/**
+ * @brief write_chrome_trace Write the recorded events in a Chrome trace file.
+ * @throw std::runtime_error If the file cannot be written.
+ */
+void write_chrome_trace(const std::filesystem::path& trace_path);
+
+/**
+ * @brief The trace_scope class records the duration of its scope as a trace event, if tracing is started at its
+ * construction.
+ * @details The argument is interned (see private_::intern_trace_string()): once a thread has used an argument,
+ * tracing a scope with it takes no lock.
+ * @warning category and name must live until the end of the program (ex: string literals). The argument is copied.
+ */
+class trace_scope
+{
+public:
+    inline trace_scope(std::string_view category, std::string_view name, std::string_view argument = {}) noexcept
+    {
+        if (is_tracing()) [[unlikely]]
+            begin_(category, name, argument.empty() ? argument : intern_argument_(argument));
+    }
+
+    /**
+     * @brief trace_scope Record the scope with a path as argument, converted only if tracing is started.
+     */
+    template <std::same_as<std::filesystem::path> PathType>
+    inline trace_scope(std::string_view category, std::string_view name, const PathType& path) noexcept
+    {
+        if (is_tracing()) [[unlikely]]
+            begin_(category, name, intern_argument_(path));
+    }
+
+    inline ~trace_scope()
+    {
+        if (!category_.empty()) [[unlikely]]
+            private_::record_trace_event(category_, name_, argument_, start_, std::chrono::steady_clock::now());
+    }
+
+    trace_scope(const trace_scope&) = delete;
+    trace_scope& operator=(const trace_scope&) = delete;
+
+private:
+    inline void begin_(std::string_view category, std::string_view name, std::string_view argument) noexcept
+    {
+        category_ = category;
+        name_ = name;
+        argument_ = argument;
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    static std::string_view intern_argument_(std::string_view argument) noexcept;
+    static std::string_view intern_argument_(const std::filesystem::path& path) noexcept;
+
+    std::string_view category_;
+    std::string_view name_;
+    std::string_view argument_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "plugin_manager.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+/**
+ * @brief fork_process Fork the process, and run a function in the child process, which then exits with the result.
+ * @return The id of the child process.
+ * @throw plugin_process_error If the process cannot be forked, or if the platform does not support fork.
+ * @details The exceptions thrown by the function, of any type, are caught: their message is written on the error
+ * stream, and the child exits with 1.
+ */
+int fork_process(const std::function<int()>& function);
+
+/**
+ * @brief wait_process Wait for the end of a child process.
+ * @return The exit code of the process, or 128 + the signal number if it was killed by a signal.
+ * @throw plugin_process_error If the process is not a child of the calling process.
+ */
+int wait_process(int process_id);
+} // namespace private_
+
+/**
+ * @brief The plugin_sharing_report_entry struct describes the memory of one plugin shared by a worker of a zygote.
+ */
+struct plugin_sharing_report_entry
+{
+    std::string name;
+    std::filesystem::path plugin_path;
+    plugin_memory_sharing memory_sharing;
+};
+
+/**
+ * @brief The basic_plugin_zygote class loads a set of plugins once, then forks workers which inherit them.
+ * @tparam PluginType The plugin class used to load the plugins (plugin, safe_plugin, ...).
+ * @details The plugins are loaded (see basic_plugin_manager::load_all()), warmed up according to their load options,
+ * and initialized before the first fork. The workers share their pages copy-on-write with the zygote: the startup
+ * cost is paid once, and the pages which are not written stay shared (see memory_report()).
+ * The caches of the library (read sections, call slots, background closes, call statistics) are reset in the
+ * workers, which can load and unload plugins like any process.
+ * Not available on Windows.
+ * @warning A worker inherits only the forking thread: fork_worker() must not be called while other threads call
+ * tracked functions, load or unload plugins, or while the calling thread is in a call of a plugin.
+ */
+template <class PluginType = plugin>
+class basic_plugin_zygote
+{
+public:
+    using plugin_type = PluginType;
+    using manager_type = basic_plugin_manager<PluginType>;
+
+    /**
+     * @brief basic_plugin_zygote Load and initialize a set of plugins, in dependency order.
+     * @param specs The plugins to load.
+     * @param initialize Initialize the plugins after loading them (see basic_plugin_manager::initialize_all()).
+     * @param max_thread_count The maximum number of threads loading and initializing the plugins.
+     * @throw std::invalid_argument If the dependencies of the specs are invalid.
+     * @throw plugin_load_error If a plugin cannot be loaded.
+     * @throw std::runtime_error If a plugin fails to initialize. The message lists the failed plugins.
+     */
+    explicit basic_plugin_zygote(std::span<const plugin_load_spec> specs, bool initialize = true,
+                                 std::size_t max_thread_count = std::thread::hardware_concurrency())
+    {
+        manager_.load_all(specs, max_thread_count);
+        if (!initialize)
+            return;
+        std::string failures;
+        for (const plugin_initialize_report_entry& entry : manager_.initialize_all(max_thread_count))
+            if (entry.status == plugin_initialize_status::failed)
+                failures += std::format("\n{}: {}", entry.name, entry.error_message);
+        if (!failures.empty()) [[unlikely]]
+            throw std::runtime_error(std::format("Plugins failed to initialize:{}", failures));
+    }
+
+    basic_plugin_zygote(const basic_plugin_zygote&) = delete;
+    basic_plugin_zygote& operator=(const basic_plugin_zygote&) = delete;
+
+    /**
+     * @brief ~basic_plugin_zygote Wait for the end of the workers, then unload the plugins.
+     */
+    ~basic_plugin_zygote()
+    {
+        for (int worker_id : worker_ids_)
+        {
+            try
+            {
+                private_::wait_process(worker_id);
+            }
+            catch (const plugin_process_error&)
+            {
+            }
+        }
+    }
+
+    /**
+     * @brief fork_worker Fork a worker process, which runs a function with the inherited plugins.
+     * @param worker_main The function run by the worker. Its result is the exit code of the worker.
+     * @return The id of the worker process.
+     * @throw plugin_process_error If the process cannot be forked.
+     * @details The worker exits right after the function, without unloading the plugins nor running the destructors
+     * of the static objects: the standard streams are flushed before.
+     */
+    int fork_worker(const std::function<int(manager_type&)>& worker_main)
+    {
+        const int worker_id = private_::fork_process([this, &worker_main] { return worker_main(manager_); });
+        worker_ids_.push_back(worker_id);
+        return worker_id;
+    }
+
+    /**
+     * @brief wait_worker Wait for the end of a worker.
+     * @return The exit code of the worker, or 128 + the signal number if it was killed by a signal.
+     * @throw std::invalid_argument If the process is not a worker of this zygote, or was already waited for.
+     */
+    int wait_worker(int worker_id)
+    {
+        const auto iter = std::ranges::find(worker_ids_, worker_id);
+        if (iter == worker_ids_.end()) [[unlikely]]
+            throw std::invalid_argument(std::format("The process {} is not a running worker.", worker_id));
+        worker_ids_.erase(iter);
+        return private_::wait_process(worker_id);
+    }
+
+    /**
+     * @brief worker_ids The ids of the workers which were not waited for yet, in the order of their fork.
+     */
+    [[nodiscard]] inline const std::vector<int>& worker_ids() const noexcept { return worker_ids_; }
+
+    /**
+     * @brief memory_report Split the memory of the plugins in a process between the pages shared with the other
+     * processes and the private ones.
+     * @param process_id The process to inspect: a worker, or the zygote itself.
+     * @return The memory sharing of all the plugins, in the order of their loading.
+     * @details A page written by a worker after the fork becomes private to it. Only measured on Linux.
+     */
+    [[nodiscard]] std::vector<plugin_sharing_report_entry> memory_report(int process_id)
+    {
+        const std::vector<std::string_view> names = manager_.names();
+        std::vector<const plugin_base*> plugins;
+        plugins.reserve(names.size());
+        for (std::string_view name : names)
+            plugins.push_back(manager_.find(name));
+        std::vector<plugin_memory_sharing> sharings = memory_sharings(process_id, plugins);
+
+        std::vector<plugin_sharing_report_entry> report;
+        report.reserve(names.size());
+        for (std::size_t i = 0; i < names.size(); ++i)
+            report.push_back(plugin_sharing_report_entry{ .name = std::string(names[i]),
+                                                          .plugin_path = plugins[i]->plugin_path(),
+                                                          .memory_sharing = sharings[i] });
+        return report;
+    }
+
+    [[nodiscard]] inline manager_type& manager() noexcept { return manager_; }
+    [[nodiscard]] inline const manager_type& manager() const noexcept { return manager_; }
+
+private:
+    manager_type manager_;
+    std::vector<int> worker_ids_;
+};
+
+using plugin_zygote = basic_plugin_zygote<plugin>;
+
+} // namespace plug
+} // namespace arba
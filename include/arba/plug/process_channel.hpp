@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <semaphore>
+#include <span>
+#include <string_view>
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+/**
+ * @brief remote_invoker_type The type of the functions executed by a plugin process for a remote call.
+ * @details The context is the object returned by the server start function, and the buffer holds the arguments of
+ * the call, then its result. As the plugin process is a fork of the host process, an invoker instantiated in the host
+ * has the same address in the plugin process.
+ */
+using remote_invoker_type = void (*)(void* context, void* function, std::byte* buffer);
+
+/**
+ * @brief The process_channel class runs a server in a forked process and sends it remote calls through shared memory.
+ * @details The host threads submit the indexes of their call slots to a lock-free MPSC ring. The server drains the
+ * ring in batches, and is only woken up (futex) when it sleeps because the ring was empty. The completion of each
+ * call is published in its slot, where the submitting thread waits for it.
+ * Only available on Linux.
+ */
+class process_channel
+{
+public:
+    static constexpr std::size_t slot_count = 64;
+    static constexpr std::size_t buffer_size = 256;
+
+    /**
+     * @brief process_channel Fork the process, and run the server in the child process.
+     * @param start_server The function called in the child process to make the context of the remote calls
+     * (ex: load a plugin). If it throws, the message of the exception is sent to the host.
+     * @throw plugin_load_error If the process cannot be forked or if start_server throws.
+     */
+    explicit process_channel(const std::function<void*()>& start_server);
+
+    process_channel(const process_channel&) = delete;
+    process_channel& operator=(const process_channel&) = delete;
+
+    /**
+     * @brief ~process_channel Stop the server process and wait for its end.
+     * @details The server process is killed if it does not stop within one second (ex: stuck in a call).
+     */
+    ~process_channel();
+
+    /**
+     * @brief submit Submit a remote call to the server.
+     * @return The index of the call slot, to give to wait().
+     * @throw plugin_process_error If the server process is not running.
+     * @details Blocks while all the call slots are used.
+     */
+    std::uint32_t submit(remote_invoker_type invoker, void* function, std::span<const std::byte> arguments);
+
+    /**
+     * @brief wait Wait for the end of a remote call, copy its result and free its slot.
+     * @throw plugin_find_symbol_error If the invoker threw a plugin_find_symbol_error.
+     * @throw std::runtime_error If the invoker threw another exception.
+     * @throw plugin_process_error If the server process ended before the end of the call.
+     */
+    void wait(std::uint32_t slot_index, std::span<std::byte> result);
+
+    /**
+     * @brief is_running Indicate if the server process is running.
+     */
+    [[nodiscard]] bool is_running();
+
+    [[nodiscard]] inline int process_id() const noexcept { return process_id_; }
+
+private:
+    struct shared_region;
+
+    [[noreturn]] void run_server_(const std::function<void*()>& start_server);
+    void serve_calls_(void* context);
+    void stop_() noexcept;
+    void throw_if_ended_(std::string_view action);
+
+    shared_region* region_ = nullptr;
+    int process_id_ = -1;
+    std::atomic_uint64_t used_slots_ = 0;
+    std::counting_semaphore<slot_count> free_slot_count_{ slot_count };
+    std::mutex exit_mutex_;
+    std::atomic_bool ended_ = false;
+    int exit_status_ = 0;
+};
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
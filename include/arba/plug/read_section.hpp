@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+/**
+ * @brief The read_section class marks a scope reading a loaded plugin, which cannot be unloaded during the scope.
+ * @details Each thread counts its sections in one of a few sharded counters, so entering a section is one atomic
+ * increment on a cache line rarely shared with other threads, and never takes a lock. A thread unloading a plugin
+ * unpublishes it, then calls synchronize() to wait for the end of the sections which may still read it, before
+ * closing it. Sections can be nested, but synchronize() must not be called inside a section.
+ */
+class read_section
+{
+public:
+    read_section() noexcept;
+    ~read_section();
+
+    read_section(const read_section&) = delete;
+    read_section& operator=(const read_section&) = delete;
+
+    /**
+     * @brief synchronize Wait for the end of all the sections entered before the call.
+     */
+    static void synchronize();
+
+private:
+    std::atomic<std::uint64_t>* reader_count_;
+};
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+/**
+ * @brief run_on_threads Run a function on thread_count threads (at least one), the calling thread included, and wait
+ * for them.
+ */
+template <class FunctionType>
+void run_on_threads(std::size_t thread_count, const FunctionType& function)
+{
+    std::vector<std::jthread> threads;
+    threads.reserve(thread_count > 1 ? thread_count - 1 : 0);
+    for (std::size_t i = 1; i < thread_count; ++i)
+        threads.emplace_back(function);
+    function();
+}
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
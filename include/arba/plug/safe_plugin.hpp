@@ -31,8 +31,12 @@ public:
     /**
      * @brief Plugin constructor which takes the path to the plugin to load.
      * @param plugin_path The path to the plugin to load (extension of the file is optional).
+     * @param options The optional steps of the load.
      */
-    explicit safe_plugin(const std::filesystem::path& plugin_path) : base_(plugin_path) {}
+    explicit safe_plugin(const std::filesystem::path& plugin_path, const plugin_load_options& options = {})
+        : base_(plugin_path, options)
+    {
+    }
 
     safe_plugin(safe_plugin&&) = default;
     safe_plugin& operator=(safe_plugin&&) = default;
@@ -51,6 +55,8 @@ public:
                  && std::is_function_v<std::remove_cvref_t<decltype(*std::declval<FunctionSignatureType>)>>
     FunctionSignatureType find_function_ptr(std::string_view function_name)
     {
+        // The register and the std::any it returns are code of the plugin, which must stay loaded while they are used.
+        private_::read_section section;
         const auto find_function_ptr = this->find_symbol_pointer(std::string(private_::function_register_fname));
         const private_::function_register_type find_function_ptr_as_any =
             reinterpret_cast<private_::function_register_type>(find_function_ptr);
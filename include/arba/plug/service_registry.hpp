@@ -0,0 +1,208 @@
+#pragma once
+
+#include "plugin_base.hpp"
+#include "signature_hash.hpp"
+
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief service_id The compile-time identifier of an interface provided by plugins as a service.
+ * @warning The plugins and their user must be built with the same compiler (see signature_hash()).
+ */
+template <class InterfaceType>
+constexpr std::uint64_t service_id() noexcept
+{
+    return signature_hash<InterfaceType>();
+}
+
+/**
+ * @brief The service_entry struct describes an interface provided by a plugin, in its service register.
+ */
+struct service_entry
+{
+    std::uint64_t interface_id = 0;
+    std::string_view interface_name;
+    // Make an instance of the interface, as a std::shared_ptr<InterfaceType> converted to std::shared_ptr<void>.
+    std::shared_ptr<void> (*make_shared_instance)() = nullptr;
+};
+
+namespace private_
+{
+using service_register_type = std::span<const service_entry> (*)();
+static constexpr std::string_view service_register_fname = "arba_plug_service_register_";
+} // namespace private_
+
+/**
+ * @brief The service_provider struct is a service of a plugin registered in a service_registry.
+ */
+struct service_provider
+{
+    const plugin_base* plugin = nullptr;
+    // A view on the name of the interface in the plugin, valid while it is loaded.
+    std::string_view interface_name;
+    std::shared_ptr<void> (*make_shared_void_instance)() = nullptr;
+
+    /**
+     * @brief make_shared_instance Make an instance of the interface provided by the plugin.
+     * @warning InterfaceType must be the interface of the provider. The instance must not outlive the plugin.
+     */
+    template <class InterfaceType>
+    [[nodiscard]] std::shared_ptr<InterfaceType> make_shared_instance() const
+    {
+        return std::static_pointer_cast<InterfaceType>(make_shared_void_instance());
+    }
+};
+
+/**
+ * @brief The service_registry class indexes the interfaces provided by a set of plugins (see
+ * ARBA_PLUG_REGISTER_SERVICE()), to find all the plugins providing an interface.
+ * @details The providers of each interface are cached in a contiguous vector, found with one hash lookup of the
+ * compile-time identifier of the interface (see service_id()). The providers are listed in the order of the addition
+ * of their plugins.
+ * The lookups can be called concurrently with each other, but not with add(), remove() or clear().
+ * @warning A plugin must be removed from the registry before it is unloaded.
+ */
+class service_registry
+{
+public:
+    /**
+     * @brief add Register the services of a plugin.
+     * @return The number of services provided by the plugin (0 if it has no service register).
+     * @throw std::invalid_argument If the plugin is already registered.
+     */
+    std::size_t add(const plugin_base& plugin);
+
+    /**
+     * @brief remove Unregister the services of a plugin.
+     * @return true If the plugin was registered.
+     */
+    bool remove(const plugin_base& plugin);
+
+    /**
+     * @brief clear Unregister all the plugins.
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief providers The providers of an interface.
+     * @return The providers, or an empty span if no plugin provides the interface. The span is invalidated by the
+     * next add(), remove() or clear().
+     */
+    [[nodiscard]] std::span<const service_provider> providers(std::uint64_t interface_id) const noexcept;
+
+    template <class InterfaceType>
+    [[nodiscard]] inline std::span<const service_provider> providers() const noexcept
+    {
+        return providers(service_id<InterfaceType>());
+    }
+
+    /**
+     * @brief make_shared_instance Make an instance of an interface with its first provider.
+     * @throw std::out_of_range If no plugin provides the interface.
+     */
+    template <class InterfaceType>
+    [[nodiscard]] std::shared_ptr<InterfaceType> make_shared_instance() const
+    {
+        const std::span<const service_provider> interface_providers = providers<InterfaceType>();
+        if (interface_providers.empty()) [[unlikely]]
+            throw std::out_of_range(
+                std::format("No plugin provides the interface '{}'.", typeid(InterfaceType).name()));
+        return interface_providers.front().make_shared_instance<InterfaceType>();
+    }
+
+    /**
+     * @brief make_shared_instances Make an instance of an interface with each of its providers.
+     */
+    template <class InterfaceType>
+    [[nodiscard]] std::vector<std::shared_ptr<InterfaceType>> make_shared_instances() const
+    {
+        const std::span<const service_provider> interface_providers = providers<InterfaceType>();
+        std::vector<std::shared_ptr<InterfaceType>> instances;
+        instances.reserve(interface_providers.size());
+        for (const service_provider& provider : interface_providers)
+            instances.push_back(provider.make_shared_instance<InterfaceType>());
+        return instances;
+    }
+
+    [[nodiscard]] inline std::size_t plugin_count() const noexcept { return plugins_.size(); }
+
+    /**
+     * @brief interface_count The number of distinct interfaces provided by the registered plugins.
+     */
+    [[nodiscard]] inline std::size_t interface_count() const noexcept { return providers_.size(); }
+
+private:
+    std::unordered_map<std::uint64_t, std::vector<service_provider>> providers_;
+    std::vector<const plugin_base*> plugins_;
+};
+
+} // namespace plug
+} // namespace arba
+
+/**
+ * Begin the service register of a plugin, listing the interfaces it provides (see service_registry).
+ */
+#define ARBA_PLUG_BEGIN_SERVICE_REGISTER()                                                                             \
+    extern "C" std::span<const ::arba::plug::service_entry> arba_plug_service_register_()                              \
+    {                                                                                                                  \
+        static_assert(::arba::plug::private_::service_register_fname == __func__);                                     \
+        static_assert(std::is_same_v<::arba::plug::private_::service_register_type,                                    \
+                                     decltype(&arba_plug_service_register_)>);                                         \
+        static const ::arba::plug::service_entry service_register_[] = {
+
+/**
+ * Register an interface provided by the plugin.
+ * @param interface_ The interface type.
+ * @param factory_ A function without parameter returning a std::unique_ptr or a std::shared_ptr to an implementation
+ * of the interface.
+ */
+#define ARBA_PLUG_REGISTER_SERVICE(interface_, factory_)                                                               \
+    ::arba::plug::service_entry{ .interface_id = ::arba::plug::service_id<interface_>(),                               \
+                                 .interface_name = #interface_,                                                        \
+                                 .make_shared_instance = []() -> std::shared_ptr<void> {                               \
+                                     return std::shared_ptr<interface_>(factory_());                                   \
+                                 } },
+
+#define ARBA_PLUG_END_SERVICE_REGISTER()                                                                               \
+    }                                                                                                                  \
+    ;                                                                                                                  \
+    return service_register_;                                                                                          \
+    }
+
+#ifndef PLUG_BEGIN_SERVICE_REGISTER
+#define PLUG_BEGIN_SERVICE_REGISTER() ARBA_PLUG_BEGIN_SERVICE_REGISTER()
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message "PLUG_BEGIN_SERVICE_REGISTER already exists. You must use ARBA_PLUG_BEGIN_SERVICE_REGISTER."
+#endif
+#endif
+
+#ifndef PLUG_REGISTER_SERVICE
+#define PLUG_REGISTER_SERVICE(interface_, factory_) ARBA_PLUG_REGISTER_SERVICE(interface_, factory_)
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message "PLUG_REGISTER_SERVICE already exists. You must use ARBA_PLUG_REGISTER_SERVICE."
+#endif
+#endif
+
+#ifndef PLUG_END_SERVICE_REGISTER
+#define PLUG_END_SERVICE_REGISTER() ARBA_PLUG_END_SERVICE_REGISTER()
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message "PLUG_END_SERVICE_REGISTER already exists. You must use ARBA_PLUG_END_SERVICE_REGISTER."
+#endif
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+constexpr std::uint64_t fnv1a_hash(std::string_view text) noexcept
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char character : text)
+    {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <typename Type>
+constexpr std::string_view type_signature() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+}
+} // namespace private_
+
+/**
+ * @brief signature_hash A compile-time hash of a type, computed from its spelling by the compiler.
+ * @tparam Type The hashed type. (i.e. void(*)(int))
+ * @warning The hash of a type is stable for a given compiler, but may differ between compilers. A plugin and its user
+ * must be built with the same compiler to compare hashes.
+ */
+template <typename Type>
+constexpr std::uint64_t signature_hash() noexcept
+{
+    return private_::fnv1a_hash(private_::type_signature<Type>());
+}
+
+} // namespace plug
+} // namespace arba
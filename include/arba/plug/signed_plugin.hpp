@@ -0,0 +1,104 @@
+#pragma once
+
+#include "plugin_impl.hpp"
+#include "signature_hash.hpp"
+
+#include <format>
+#include <typeinfo>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The signed_function_entry struct is exported by a plugin for each function registered with
+ * ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION(): the function pointer and the signature hash of its type.
+ */
+template <typename FunctionSignatureType>
+struct signed_function_entry
+{
+    std::uint64_t signature_hash;
+    FunctionSignatureType function;
+};
+
+namespace private_
+{
+static constexpr std::string_view signed_function_fname_prefix = "arba_plug_signed_plugin_function_";
+} // namespace private_
+
+/**
+ * @brief The signed_plugin class
+ * @details The type of the found functions is checked like with safe_plugin, but at the cost of one symbol lookup and
+ * one integer comparison, so the check can stay on in release builds.
+ */
+class signed_plugin : public plugin_impl<signed_plugin>
+{
+private:
+    using base_ = plugin_impl<signed_plugin>;
+
+public:
+    inline signed_plugin() {}
+
+    /**
+     * @brief Plugin constructor which takes the path to the plugin to load.
+     * @param plugin_path The path to the plugin to load (extension of the file is optional).
+     * @param options The optional steps of the load.
+     */
+    explicit signed_plugin(const std::filesystem::path& plugin_path, const plugin_load_options& options = {})
+        : base_(plugin_path, options)
+    {
+    }
+
+    signed_plugin(signed_plugin&&) = default;
+    signed_plugin& operator=(signed_plugin&&) = default;
+
+    /**
+     * @brief find_function_ptr Find the address of the function with a given name and check the type of the function.
+     * @tparam FunctionSignatureType Signature of the searched function. (i.e. void(*)(int))
+     * @param function_name The name of the searched function.
+     * @return A function pointer to the found function symbol in the plugin.
+     * @throw plugin_find_symbol_error If the function is not registered or if a plugin is not loaded by this instance.
+     * @throw std::runtime_error If the type of the function is not the expected one.
+     * @warning Only functions registered with ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION() can be found (and checked).
+     * The plugin and its user must be built with the same compiler (see signature_hash()).
+     */
+    template <typename FunctionSignatureType>
+        requires std::is_pointer_v<FunctionSignatureType>
+                 && std::is_function_v<std::remove_cvref_t<decltype(*std::declval<FunctionSignatureType>)>>
+    FunctionSignatureType find_function_ptr(std::string_view function_name)
+    {
+        private_::read_section section;
+        const std::string entry_name = std::string(private_::signed_function_fname_prefix).append(function_name);
+        const auto* entry =
+            static_cast<const signed_function_entry<FunctionSignatureType>*>(this->find_symbol_pointer(entry_name));
+        if (entry->signature_hash != signature_hash<FunctionSignatureType>()) [[unlikely]]
+        {
+            throw std::runtime_error(std::format("Function type of '{}' is not the requested type function '{}'.",
+                                                 function_name, typeid(FunctionSignatureType).name()));
+        }
+        return entry->function;
+    }
+};
+
+} // namespace plug
+} // namespace arba
+
+/**
+ * Export a plugin function so that signed_plugin can find it and check its type.
+ * @param function_ The name of the function, which must not be overloaded.
+ */
+#define ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION(function_)                                                           \
+    extern "C" const ::arba::plug::signed_function_entry<decltype(&function_)>                                         \
+        arba_plug_signed_plugin_function_##function_{                                                                  \
+            .signature_hash = ::arba::plug::signature_hash<decltype(&function_)>(), .function = &function_           \
+        };
+
+#ifndef PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION
+#define PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION(function_) ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION(function_)
+#else
+#if not defined(NDEBUG) && (defined(__GNUC__) || defined(__GNUG__) || defined(_MSC_VER) || defined(__clang__))
+#pragma message                                                                                                        \
+    "PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION already exists. You must use ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION."
+#endif
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "call_tracker.hpp"
+
+#include <memory>
+#include <utility>
+
+inline namespace arba
+{
+namespace plug
+{
+
+template <typename FunctionSignatureType>
+class tracked_function;
+
+/**
+ * @brief The tracked_function class is a callable holding a function found in a plugin, whose calls are tracked so
+ * that the plugin is not closed during a call.
+ * @tparam ReturnType The return type of the function.
+ * @tparam ArgsT... The parameter types of the function.
+ * @details Each call is counted in the call_tracker of the plugin: unloading the plugin waits for the end of the
+ * calls in flight, and the calls made after the unload throw plugin_unloaded_error.
+ * @warning A tracked call must not wait for the unload of its own plugin, unless the plugin is unloaded in background.
+ */
+template <typename ReturnType, typename... ArgsT>
+class tracked_function<ReturnType (*)(ArgsT...)>
+{
+public:
+    using function_pointer_type = ReturnType (*)(ArgsT...);
+
+    tracked_function() = default;
+
+    tracked_function(function_pointer_type function, std::shared_ptr<call_tracker> tracker)
+        : function_(function), tracker_(std::move(tracker))
+    {
+    }
+
+    /**
+     * @throw plugin_unloaded_error If the plugin of the function is unloaded.
+     */
+    inline ReturnType operator()(ArgsT... args) const
+    {
+        call_tracker::call_scope scope(*tracker_);
+        return function_(std::forward<ArgsT>(args)...);
+    }
+
+    /**
+     * @brief get The function pointer found in the plugin, whose calls are not tracked.
+     */
+    [[nodiscard]] inline function_pointer_type get() const noexcept { return function_; }
+
+    /**
+     * @brief is_callable Indicate if the function is bound and its plugin is not unloaded.
+     */
+    [[nodiscard]] inline bool is_callable() const noexcept { return function_ && !tracker_->is_closed(); }
+
+    [[nodiscard]] inline explicit operator bool() const noexcept { return function_ != nullptr; }
+
+private:
+    function_pointer_type function_ = nullptr;
+    std::shared_ptr<call_tracker> tracker_;
+};
+
+} // namespace plug
+} // namespace arba
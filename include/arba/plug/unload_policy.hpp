@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+inline namespace arba
+{
+namespace plug
+{
+
+/**
+ * @brief The plugin_unload_policy enum tells what plugin_base::unload() and the destructor of a plugin do with the
+ * unloaded library.
+ */
+enum class plugin_unload_policy : std::uint8_t
+{
+    // Close the library (dlclose()) before returning, once its tracked calls are finished.
+    close,
+    // Hand the close of the library to the background reaper thread: the unloading thread never waits for dlclose().
+    close_in_background,
+    // Never close the library: it stays mapped until the process exits, and its static destructors are not run by
+    // dlclose(). Useful to shut down a process with many plugins quickly.
+    keep_mapped,
+};
+
+/**
+ * @brief set_default_unload_policy Set the unload policy of the plugins which are loaded without one.
+ * @details The policy can be changed at any time: it is read when a plugin is unloaded. Setting keep_mapped before
+ * destroying the plugins at the end of a program skips all the dlclose() calls, and the closes not yet done by the
+ * reaper thread.
+ */
+void set_default_unload_policy(plugin_unload_policy policy) noexcept;
+
+/**
+ * @brief default_unload_policy The unload policy of the plugins which are loaded without one (close by default).
+ */
+[[nodiscard]] plugin_unload_policy default_unload_policy() noexcept;
+
+} // namespace plug
+} // namespace arba
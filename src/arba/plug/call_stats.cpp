@@ -0,0 +1,155 @@
+#include <arba/plug/call_stats.hpp>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+#include <pthread.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+
+std::chrono::nanoseconds symbol_call_stats_snapshot::mean_duration() const noexcept
+{
+    if (call_count == 0)
+        return std::chrono::nanoseconds(0);
+    return total_duration / call_count;
+}
+
+std::chrono::nanoseconds symbol_call_stats_snapshot::latency_percentile(double ratio) const noexcept
+{
+    if (call_count == 0)
+        return std::chrono::nanoseconds(0);
+    const double threshold = std::clamp(ratio, 0.0, 1.0) * static_cast<double>(call_count);
+    std::uint64_t cumulated_count = 0;
+    for (std::size_t i = 0; i < histogram_size; ++i)
+    {
+        cumulated_count += latency_histogram[i];
+        if (static_cast<double>(cumulated_count) >= threshold && cumulated_count > 0)
+            return std::chrono::nanoseconds(std::uint64_t(1) << (i + 1));
+    }
+    return std::chrono::nanoseconds(std::uint64_t(1) << histogram_size);
+}
+
+symbol_call_stats_snapshot symbol_call_stats::snapshot(std::string_view symbol_name) const
+{
+    symbol_call_stats_snapshot result;
+    result.symbol_name = symbol_name;
+    std::uint64_t total_duration_ns = 0;
+    for (const shard_& shard : shards_)
+    {
+        result.call_count += shard.call_count.load(std::memory_order_relaxed);
+        total_duration_ns += shard.total_duration_ns.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < symbol_call_stats_snapshot::histogram_size; ++i)
+            result.latency_histogram[i] += shard.latency_histogram[i].load(std::memory_order_relaxed);
+    }
+    result.total_duration = std::chrono::nanoseconds(total_duration_ns);
+    return result;
+}
+
+void symbol_call_stats::reset() noexcept
+{
+    for (shard_& shard : shards_)
+    {
+        shard.call_count.store(0, std::memory_order_relaxed);
+        shard.total_duration_ns.store(0, std::memory_order_relaxed);
+        for (std::atomic<std::uint64_t>& bucket : shard.latency_histogram)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t symbol_call_stats::local_shard_index_() noexcept
+{
+    static std::atomic<std::size_t> thread_counter = 0;
+    thread_local const std::size_t shard_index = thread_counter.fetch_add(1, std::memory_order_relaxed) % shard_count;
+    return shard_index;
+}
+
+namespace
+{
+class call_stats_registry
+{
+public:
+    static call_stats_registry& instance()
+    {
+        static call_stats_registry registry;
+        return registry;
+    }
+
+    symbol_call_stats& register_stats(const std::filesystem::path& plugin_path, std::string_view symbol_name)
+    {
+        std::lock_guard lock(mutex_);
+        auto plugin_iter = plugins_.try_emplace(plugin_path.generic_string()).first;
+        symbol_stats_map& symbols = plugin_iter->second;
+        auto iter = symbols.find(symbol_name);
+        if (iter == symbols.end())
+        {
+            // The keys of the maps are stable: the statistics can name themselves with them.
+            iter = symbols.emplace(std::string(symbol_name), nullptr).first;
+            iter->second = std::make_unique<symbol_call_stats>(plugin_iter->first, iter->first);
+        }
+        return *iter->second;
+    }
+
+    std::vector<plugin_call_stats_snapshot> snapshot()
+    {
+        std::vector<plugin_call_stats_snapshot> result;
+        std::lock_guard lock(mutex_);
+        result.reserve(plugins_.size());
+        for (const auto& [plugin_path, symbols] : plugins_)
+        {
+            plugin_call_stats_snapshot& plugin_snapshot = result.emplace_back();
+            plugin_snapshot.plugin_path = plugin_path;
+            plugin_snapshot.symbols.reserve(symbols.size());
+            for (const auto& [symbol_name, stats] : symbols)
+                plugin_snapshot.symbols.push_back(stats->snapshot(symbol_name));
+        }
+        return result;
+    }
+
+    void reset()
+    {
+        std::lock_guard lock(mutex_);
+        for (auto& [plugin_path, symbols] : plugins_)
+            for (auto& [symbol_name, stats] : symbols)
+                stats->reset();
+    }
+
+private:
+    call_stats_registry()
+    {
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+        // A forked child must not inherit the mutex locked by another thread.
+        pthread_atfork([] { instance().mutex_.lock(); }, [] { instance().mutex_.unlock(); },
+                       [] { instance().mutex_.unlock(); });
+#endif
+    }
+
+    using symbol_stats_map = std::map<std::string, std::unique_ptr<symbol_call_stats>, std::less<>>;
+
+    std::mutex mutex_;
+    std::map<std::string, symbol_stats_map, std::less<>> plugins_;
+};
+} // namespace
+
+symbol_call_stats& register_symbol_call_stats(const std::filesystem::path& plugin_path, std::string_view symbol_name)
+{
+    return call_stats_registry::instance().register_stats(plugin_path, symbol_name);
+}
+
+std::vector<plugin_call_stats_snapshot> snapshot_call_stats()
+{
+    return call_stats_registry::instance().snapshot();
+}
+
+void reset_call_stats()
+{
+    call_stats_registry::instance().reset();
+}
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,174 @@
+#include <arba/plug/call_tracker.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+#include <pthread.h>
+#endif
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <windows.h>
+#elif defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+namespace
+{
+bool asymmetric_barrier_available() noexcept
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    return true;
+#elif defined(__linux__) && defined(SYS_membarrier)
+    static const bool available = [] {
+        const long commands = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+        return commands >= 0 && (commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED)
+               && syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+struct call_thread_slot_owner
+{
+    std::size_t index = call_thread_slot::no_index;
+
+    ~call_thread_slot_owner();
+};
+
+thread_local call_thread_slot_owner local_slot_owner;
+
+class call_thread_slot_allocator
+{
+public:
+    static call_thread_slot_allocator& instance()
+    {
+        static call_thread_slot_allocator allocator;
+        return allocator;
+    }
+
+    call_thread_slot_allocator()
+    {
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+        // Only the forking thread lives in a forked child: the slots of the other threads are free.
+        pthread_atfork([] { instance().mutex_.lock(); }, [] { instance().mutex_.unlock(); },
+                       [] {
+                           call_thread_slot_allocator& allocator = instance();
+                           allocator.free_indexes_.clear();
+                           for (std::size_t index = allocator.next_index_; index-- > 0;)
+                               if (index != local_slot_owner.index)
+                                   allocator.free_indexes_.push_back(index);
+                           allocator.mutex_.unlock();
+                       });
+#endif
+    }
+
+    std::size_t acquire()
+    {
+        std::lock_guard lock(mutex_);
+        if (free_indexes_.empty())
+            return next_index_++;
+        const std::size_t index = free_indexes_.back();
+        free_indexes_.pop_back();
+        return index;
+    }
+
+    void release(std::size_t index)
+    {
+        std::lock_guard lock(mutex_);
+        free_indexes_.push_back(index);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::size_t> free_indexes_;
+    std::size_t next_index_ = 0;
+};
+
+call_thread_slot_owner::~call_thread_slot_owner()
+{
+    if (index != call_thread_slot::no_index)
+        call_thread_slot_allocator::instance().release(index);
+}
+} // namespace
+
+call_thread_slot acquire_call_thread_slot()
+{
+    // The allocator must outlive the threads releasing their slot at exit.
+    call_thread_slot_allocator& allocator = call_thread_slot_allocator::instance();
+    if (local_slot_owner.index == call_thread_slot::no_index)
+        local_slot_owner.index = allocator.acquire();
+    return call_thread_slot{ .index = local_slot_owner.index, .asymmetric_barrier = asymmetric_barrier_available() };
+}
+
+void heavy_barrier() noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    FlushProcessWriteBuffers();
+#elif defined(__linux__) && defined(SYS_membarrier)
+    if (asymmetric_barrier_available())
+        syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+#endif
+}
+} // namespace private_
+
+void call_tracker::close() noexcept
+{
+    closed_.store(true, std::memory_order_relaxed);
+    private_::heavy_barrier();
+}
+
+bool call_tracker::is_idle() const noexcept
+{
+    return overflow_call_count_.load(std::memory_order_acquire) == 0
+           && std::ranges::all_of(slots_, [](const slot_& slot) {
+                  return slot.call_count.load(std::memory_order_acquire) == 0;
+              });
+}
+
+void call_tracker::wait_idle() const noexcept
+{
+    while (!is_idle())
+        std::this_thread::yield();
+}
+
+void call_tracker::add_release_callback(std::function<void()> callback)
+{
+    std::lock_guard lock(release_mutex_);
+    if (!released_)
+        release_callbacks_.push_back(std::move(callback));
+}
+
+bool call_tracker::has_release_callbacks() const
+{
+    std::lock_guard lock(release_mutex_);
+    return !release_callbacks_.empty();
+}
+
+void call_tracker::run_release_callbacks() noexcept
+{
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard lock(release_mutex_);
+        released_ = true;
+        callbacks.swap(release_callbacks_);
+    }
+    // The callbacks may take locks which are held while adding callbacks to other trackers.
+    for (const std::function<void()>& callback : callbacks)
+        callback();
+}
+
+} // namespace plug
+} // namespace arba
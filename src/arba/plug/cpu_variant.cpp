@@ -0,0 +1,117 @@
+#include <arba/plug/cpu_variant.hpp>
+#include <arba/plug/exception.hpp>
+#include <arba/plug/plugin_base.hpp>
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <string>
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace
+{
+constexpr std::array all_cpu_variants{ cpu_variant::baseline, cpu_variant::avx2, cpu_variant::avx512 };
+
+[[noreturn]] void throw_variant_error(const std::string& message)
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    throw plugin_load_error(std::make_error_code(std::errc::no_such_file_or_directory), message);
+#else
+    throw plugin_load_error(message);
+#endif
+}
+
+// The path of the file of a variant: the name of the variant is inserted before the plugin file extension.
+std::filesystem::path variant_path(const std::string& base_path, cpu_variant variant)
+{
+    if (variant == cpu_variant::baseline)
+        return base_path + std::string(plugin_file_extension);
+    return std::format("{}.{}{}", base_path, cpu_variant_name(variant), plugin_file_extension);
+}
+} // namespace
+
+std::string_view cpu_variant_name(cpu_variant variant) noexcept
+{
+    switch (variant)
+    {
+    case cpu_variant::avx2:
+        return "avx2";
+    case cpu_variant::avx512:
+        return "avx512";
+    case cpu_variant::baseline:
+        break;
+    }
+    return "baseline";
+}
+
+bool is_cpu_variant_supported(cpu_variant variant) noexcept
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    switch (variant)
+    {
+    case cpu_variant::avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi2");
+    case cpu_variant::avx512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+               && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+    case cpu_variant::baseline:
+        break;
+    }
+    return true;
+#else
+    return variant == cpu_variant::baseline;
+#endif
+}
+
+cpu_variant best_cpu_variant() noexcept
+{
+    // The CPU does not change during the process.
+    static const cpu_variant best_variant = [] {
+        const auto iter = std::ranges::find_if(all_cpu_variants.rbegin(), all_cpu_variants.rend(),
+                                               &is_cpu_variant_supported);
+        return iter != all_cpu_variants.rend() ? *iter : cpu_variant::baseline;
+    }();
+    return best_variant;
+}
+
+plugin_variant_selection select_plugin_variant(const std::filesystem::path& plugin_path,
+                                               std::optional<cpu_variant> forced_variant)
+{
+    std::string base_path = plugin_path.generic_string();
+    if (base_path.ends_with(plugin_file_extension))
+        base_path.resize(base_path.size() - plugin_file_extension.size());
+
+    plugin_variant_selection selection;
+    for (cpu_variant variant : all_cpu_variants)
+        if (std::filesystem::exists(variant_path(base_path, variant)))
+            selection.available_variants.push_back(variant);
+
+    if (forced_variant)
+    {
+        if (std::ranges::find(selection.available_variants, *forced_variant) == selection.available_variants.end())
+            [[unlikely]]
+            throw_variant_error(std::format("The variant {} of the plugin {} does not exist.",
+                                            cpu_variant_name(*forced_variant), base_path));
+        if (!is_cpu_variant_supported(*forced_variant)) [[unlikely]]
+            throw_variant_error(std::format("The variant {} of the plugin {} is not supported by the CPU.",
+                                            cpu_variant_name(*forced_variant), base_path));
+        selection.variant = *forced_variant;
+    }
+    else
+    {
+        const auto iter = std::ranges::find_if(selection.available_variants.rbegin(),
+                                               selection.available_variants.rend(), &is_cpu_variant_supported);
+        if (iter == selection.available_variants.rend()) [[unlikely]]
+            throw_variant_error(std::format("No variant of the plugin {} is supported by the CPU.", base_path));
+        selection.variant = *iter;
+    }
+    selection.plugin_path = variant_path(base_path, selection.variant);
+    return selection;
+}
+
+} // namespace plug
+} // namespace arba
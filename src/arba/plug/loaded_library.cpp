@@ -0,0 +1,237 @@
+#include "loaded_library.hpp"
+
+#include <arba/plug/exception.hpp>
+#include <arba/plug/read_section.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <thread>
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <pthread.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+namespace
+{
+constinit std::atomic<plugin_unload_policy> default_policy = plugin_unload_policy::close;
+} // namespace
+
+void set_default_unload_policy(plugin_unload_policy policy) noexcept
+{
+    default_policy.store(policy, std::memory_order_relaxed);
+}
+
+plugin_unload_policy default_unload_policy() noexcept
+{
+    return default_policy.load(std::memory_order_relaxed);
+}
+
+namespace private_
+{
+
+namespace
+{
+// The unload hook must not throw: the program is terminated if it does.
+void call_unload_hook(const loaded_library& library) noexcept
+{
+    if (library.on_unload)
+        library.on_unload();
+}
+} // namespace
+
+void close_library(std::unique_ptr<loaded_library> library)
+{
+    library->calls->close();
+    read_section::synchronize();
+    library->calls->wait_idle();
+    library->calls->run_release_callbacks();
+    call_unload_hook(*library);
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    int result = FreeLibrary(static_cast<HINSTANCE>(library->handle));
+    if (result == 0) [[unlikely]]
+    {
+        std::error_code error_code(GetLastError(), std::system_category());
+        throw plugin_unload_error(error_code,
+                                  std::format("A problem occured while unloading plugin: {}", error_code.message()));
+    }
+#else
+    int result = dlclose(library->handle);
+    if (result != 0) [[unlikely]]
+    {
+        std::string error_message(dlerror());
+        throw plugin_unload_error(std::format("A problem occured while unloading plugin: {}", error_message));
+    }
+#endif
+}
+
+namespace
+{
+// The reaper thread closes the libraries given to it, in order. It is started by the first background close, and
+// closes the remaining libraries when the program exits.
+class library_reaper
+{
+public:
+    // The reaper is never destroyed, only stopped at exit: a plugin with static storage may be destroyed after it is
+    // stopped, and its library is then closed by the releasing thread (see try_push()).
+    static library_reaper& instance()
+    {
+        static library_reaper* const reaper = new library_reaper();
+        static const stopper_ reaper_stopper{ reaper };
+        return *reaper;
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+            // The program exits: the libraries waiting to be closed stay mapped, like with the keep_mapped policy.
+            if (default_unload_policy() == plugin_unload_policy::keep_mapped)
+                libraries_.clear();
+        }
+        condition_.notify_all();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    // Give a library to the reaper thread, or give it back if the reaper is stopped.
+    [[nodiscard]] std::unique_ptr<loaded_library> try_push(std::unique_ptr<loaded_library> library)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            if (stopping_) [[unlikely]]
+                return library;
+            if (!thread_.joinable())
+                thread_ = std::thread(&library_reaper::run_, this);
+            libraries_.push_back(std::move(library));
+        }
+        condition_.notify_all();
+        return nullptr;
+    }
+
+    void wait_empty()
+    {
+        std::unique_lock lock(mutex_);
+        condition_.wait(lock, [this] { return libraries_.empty() && !closing_; });
+    }
+
+private:
+    struct stopper_
+    {
+        library_reaper* reaper;
+
+        ~stopper_() { reaper->stop(); }
+    };
+
+    library_reaper()
+    {
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+        // The reaper thread does not live in a forked child: the child forgets it, and keeps mapped the libraries
+        // which were waiting for it.
+        pthread_atfork([] { instance().mutex_.lock(); }, [] { instance().mutex_.unlock(); },
+                       [] {
+                           library_reaper& reaper = instance();
+                           reaper.libraries_.clear();
+                           reaper.closing_ = false;
+                           new (&reaper.thread_) std::thread();
+                           new (&reaper.condition_) std::condition_variable();
+                           reaper.mutex_.unlock();
+                       });
+#endif
+    }
+
+    void run_()
+    {
+        std::unique_lock lock(mutex_);
+        for (;;)
+        {
+            condition_.wait(lock, [this] { return stopping_ || !libraries_.empty(); });
+            if (libraries_.empty())
+                return;
+            std::unique_ptr<loaded_library> library = std::move(libraries_.front());
+            libraries_.pop_front();
+            closing_ = true;
+            lock.unlock();
+            try
+            {
+                close_library(std::move(library));
+            }
+            catch (const plugin_unload_error& err)
+            {
+                std::cerr << err.what() << std::endl;
+            }
+            lock.lock();
+            closing_ = false;
+            condition_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<std::unique_ptr<loaded_library>> libraries_;
+    bool closing_ = false;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+} // namespace
+
+void close_library_in_background(std::unique_ptr<loaded_library> library)
+{
+    // The new calls are refused right away, the calls in flight are waited for by the reaper.
+    library->calls->close();
+    std::unique_ptr<loaded_library> rejected_library = library_reaper::instance().try_push(std::move(library));
+    if (!rejected_library) [[likely]]
+        return;
+    try
+    {
+        close_library(std::move(rejected_library));
+    }
+    catch (const plugin_unload_error& err)
+    {
+        std::cerr << err.what() << std::endl;
+    }
+}
+
+void release_library(std::unique_ptr<loaded_library> library)
+{
+    switch (library->unload_policy.value_or(default_unload_policy()))
+    {
+    case plugin_unload_policy::close:
+        close_library(std::move(library));
+        break;
+    case plugin_unload_policy::close_in_background:
+        close_library_in_background(std::move(library));
+        break;
+    case plugin_unload_policy::keep_mapped:
+        // The handle is not closed: only the state is deleted, once no reader can read it.
+        library->calls->close();
+        read_section::synchronize();
+        if (library->on_unload || library->calls->has_release_callbacks())
+        {
+            library->calls->wait_idle();
+            library->calls->run_release_callbacks();
+            call_unload_hook(*library);
+        }
+        break;
+    }
+}
+
+void wait_background_closes()
+{
+    library_reaper::instance().wait_empty();
+}
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <arba/plug/call_tracker.hpp>
+#include <arba/plug/load_stats.hpp>
+#include <arba/plug/unload_policy.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+/**
+ * @brief The loaded_library struct is the state of a loaded plugin, published atomically by plugin_base.
+ * @details A published state is never modified: it is replaced by an updated copy, and deleted once no read_section
+ * can read it anymore.
+ */
+struct loaded_library
+{
+    void* handle = nullptr;
+    std::filesystem::path plugin_path;
+    plugin_load_stats load_stats;
+    std::shared_ptr<call_tracker> calls = std::make_shared<call_tracker>();
+    std::optional<plugin_unload_policy> unload_policy;
+    bool initialized = false;
+    // The unload hook of the plugin, called before closing it if it was initialized.
+    void (*on_unload)() = nullptr;
+};
+
+/**
+ * @brief close_library Close an unpublished library, once no read_section can read it and its tracked calls are
+ * finished.
+ * @throw plugin_unload_error If the library cannot be closed.
+ */
+void close_library(std::unique_ptr<loaded_library> library);
+
+/**
+ * @brief close_library_in_background Close an unpublished library on the background reaper thread.
+ * @details The errors are written on the error stream. Once the reaper is stopped at the exit of the program, the
+ * library is closed by the calling thread.
+ */
+void close_library_in_background(std::unique_ptr<loaded_library> library);
+
+/**
+ * @brief release_library Close or keep an unpublished library, according to its unload policy.
+ * @throw plugin_unload_error If the library is closed and cannot be closed.
+ */
+void release_library(std::unique_ptr<loaded_library> library);
+
+/**
+ * @brief wait_background_closes Wait for the reaper thread to close all the libraries given to it.
+ */
+void wait_background_closes();
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
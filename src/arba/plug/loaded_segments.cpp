@@ -0,0 +1,194 @@
+#include "loaded_segments.hpp"
+
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <tuple>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+
+std::vector<loaded_segment> find_loaded_segments(void*)
+{
+    return {};
+}
+
+std::size_t page_size()
+{
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    return system_info.dwPageSize;
+}
+
+void prefault_segment(const loaded_segment&)
+{
+}
+
+std::size_t remap_segment_to_huge_pages(const loaded_segment&)
+{
+    return 0;
+}
+
+#else
+
+std::size_t page_size()
+{
+    static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+namespace
+{
+struct segment_search
+{
+    const link_map* plugin_link_map;
+    std::vector<loaded_segment> segments;
+};
+
+int collect_plugin_segments(dl_phdr_info* info, std::size_t, void* data)
+{
+    segment_search& search = *static_cast<segment_search*>(data);
+    if (info->dlpi_addr != search.plugin_link_map->l_addr || !info->dlpi_name
+        || std::strcmp(info->dlpi_name, search.plugin_link_map->l_name) != 0)
+        return 0;
+
+    const std::uintptr_t page_mask = ~static_cast<std::uintptr_t>(page_size() - 1);
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i)
+    {
+        const ElfW(Phdr)& header = info->dlpi_phdr[i];
+        if (header.p_type != PT_LOAD || header.p_memsz == 0)
+            continue;
+        const std::uintptr_t begin = (info->dlpi_addr + header.p_vaddr) & page_mask;
+        const std::uintptr_t end = (info->dlpi_addr + header.p_vaddr + header.p_memsz + page_size() - 1) & page_mask;
+        search.segments.push_back(loaded_segment{ .address = begin,
+                                                  .size = end - begin,
+                                                  .readable = (header.p_flags & PF_R) != 0,
+                                                  .writable = (header.p_flags & PF_W) != 0,
+                                                  .executable = (header.p_flags & PF_X) != 0 });
+    }
+    return 1;
+}
+} // namespace
+
+std::vector<loaded_segment> find_loaded_segments(void* handle)
+{
+    link_map* plugin_link_map = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &plugin_link_map) != 0 || !plugin_link_map) [[unlikely]]
+        return {};
+    segment_search search{ .plugin_link_map = plugin_link_map, .segments = {} };
+    dl_iterate_phdr(&collect_plugin_segments, &search);
+    return std::move(search.segments);
+}
+
+void prefault_segment(const loaded_segment& segment)
+{
+    if (!segment.readable) [[unlikely]]
+        return;
+    void* address = reinterpret_cast<void*>(segment.address);
+#ifdef MADV_POPULATE_READ
+    // Linux >= 5.14: populate the page table without touching the pages one by one.
+    if (madvise(address, segment.size, MADV_POPULATE_READ) == 0) [[likely]]
+        return;
+#endif
+    madvise(address, segment.size, MADV_WILLNEED);
+    const std::size_t size = page_size();
+    for (std::uintptr_t page = segment.address; page < segment.address + segment.size; page += size)
+        std::ignore = *reinterpret_cast<const volatile unsigned char*>(page);
+}
+
+namespace
+{
+// Return the size of the transparent huge pages, or 0 if they are not available for anonymous memory.
+std::size_t transparent_huge_page_size()
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    std::string thp_mode;
+    std::getline(std::ifstream("/sys/kernel/mm/transparent_hugepage/enabled"), thp_mode);
+    if (thp_mode.empty() || thp_mode.find("[never]") != std::string::npos)
+        return 0;
+    std::size_t huge_page_size = 0;
+    std::ifstream("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size") >> huge_page_size;
+    return huge_page_size;
+#else
+    return 0;
+#endif
+}
+
+// Check that anonymous memory can be made executable (it may be forbidden by a security policy).
+bool can_execute_anonymous_memory()
+{
+    void* page = mmap(nullptr, page_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (page == MAP_FAILED) [[unlikely]]
+        return false;
+    const bool result = mprotect(page, page_size(), PROT_READ | PROT_EXEC) == 0;
+    munmap(page, page_size());
+    return result;
+}
+} // namespace
+
+std::size_t remap_segment_to_huge_pages(const loaded_segment& segment)
+{
+    static const std::size_t huge_page_size = transparent_huge_page_size();
+    if (huge_page_size == 0 || huge_page_size <= page_size())
+        return 0;
+    const std::uintptr_t huge_page_mask = ~static_cast<std::uintptr_t>(huge_page_size - 1);
+    const std::uintptr_t begin = (segment.address + huge_page_size - 1) & huge_page_mask;
+    const std::uintptr_t end = (segment.address + segment.size) & huge_page_mask;
+    if (end <= begin)
+        return 0;
+    const std::size_t size = end - begin;
+    const int protection = (segment.readable ? PROT_READ : 0) | (segment.writable ? PROT_WRITE : 0)
+                           | (segment.executable ? PROT_EXEC : 0);
+    if ((protection & PROT_EXEC) && !can_execute_anonymous_memory())
+        return 0;
+
+    // The copy is made and protected aside, then moved over the file mapping in one step: if a step fails, the
+    // segment is left as it was.
+    void* reserved = mmap(nullptr, size + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) [[unlikely]]
+        return 0;
+    const std::uintptr_t reserved_begin = reinterpret_cast<std::uintptr_t>(reserved);
+    const std::uintptr_t copy_begin = (reserved_begin + huge_page_size - 1) & huge_page_mask;
+    if (copy_begin > reserved_begin)
+        munmap(reserved, copy_begin - reserved_begin);
+    munmap(reinterpret_cast<void*>(copy_begin + size), reserved_begin + huge_page_size - copy_begin);
+    void* const copy = reinterpret_cast<void*>(copy_begin);
+    void* const address = reinterpret_cast<void*>(begin);
+    madvise(copy, size, MADV_HUGEPAGE);
+    std::memcpy(copy, address, size);
+    if (mprotect(copy, size, protection) != 0) [[unlikely]]
+    {
+        munmap(copy, size);
+        return 0;
+    }
+    void* remapped = mremap(copy, size, size, MREMAP_MAYMOVE | MREMAP_FIXED, address);
+    if (remapped == MAP_FAILED) [[unlikely]]
+    {
+        munmap(copy, size);
+        return 0;
+    }
+    if (protection & PROT_EXEC)
+        __builtin___clear_cache(static_cast<char*>(address), static_cast<char*>(address) + size);
+    return size;
+}
+
+#endif
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
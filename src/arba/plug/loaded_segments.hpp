@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+struct loaded_segment
+{
+    // Page aligned address of the first byte of the segment.
+    std::uintptr_t address = 0;
+    // Size of the segment, rounded to whole pages.
+    std::size_t size = 0;
+    bool readable = false;
+    bool writable = false;
+    bool executable = false;
+};
+
+/**
+ * @brief find_loaded_segments Find the loadable segments mapped for a plugin.
+ * @param handle The handle of the loaded plugin.
+ * @return The segments, in address order (empty on platforms where they cannot be found).
+ */
+std::vector<loaded_segment> find_loaded_segments(void* handle);
+
+std::size_t page_size();
+
+/**
+ * @brief prefault_segment Map all the pages of a segment in the page table of the process.
+ */
+void prefault_segment(const loaded_segment& segment);
+
+/**
+ * @brief remap_segment_to_huge_pages Replace the huge page aligned part of a segment by a copy backed by anonymous
+ * memory which is advised to use transparent huge pages.
+ * @return The number of remapped bytes (0 if transparent huge pages are not available, if the segment does not
+ * contain a whole huge page, or if the remap fails: the segment is then left unchanged).
+ * @warning No thread may execute or read the segment during the call.
+ */
+std::size_t remap_segment_to_huge_pages(const loaded_segment& segment);
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
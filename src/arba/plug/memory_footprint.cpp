@@ -0,0 +1,180 @@
+#include <arba/plug/memory_footprint.hpp>
+#include <arba/plug/plugin_base.hpp>
+#include <arba/plug/read_section.hpp>
+
+#include "loaded_library.hpp"
+#include "loaded_segments.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <string>
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+#include <sys/mman.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace
+{
+std::size_t sum_segments(const std::vector<segment_footprint>& segments, std::size_t segment_footprint::*bytes)
+{
+    return std::accumulate(segments.begin(), segments.end(), std::size_t(0),
+                           [bytes](std::size_t sum, const segment_footprint& segment) { return sum + segment.*bytes; });
+}
+} // namespace
+
+std::size_t plugin_memory_footprint::mapped_bytes() const noexcept
+{
+    return sum_segments(segments, &segment_footprint::mapped_bytes);
+}
+
+std::size_t plugin_memory_footprint::resident_bytes() const noexcept
+{
+    return sum_segments(segments, &segment_footprint::resident_bytes);
+}
+
+std::size_t plugin_memory_footprint::dirty_bytes() const noexcept
+{
+    return sum_segments(segments, &segment_footprint::dirty_bytes);
+}
+
+namespace
+{
+#if defined(__linux__)
+struct mapping_bytes
+{
+    std::uintptr_t begin = 0;
+    std::uintptr_t end = 0;
+    std::size_t dirty_bytes = 0;
+    std::size_t shared_bytes = 0;
+    std::size_t private_bytes = 0;
+};
+
+// Read the resident bytes of each mapping of a process, sorted by address.
+std::vector<mapping_bytes> read_mappings_bytes(const std::string& smaps_path = "/proc/self/smaps")
+{
+    std::vector<mapping_bytes> mappings;
+    std::ifstream smaps(smaps_path);
+    std::string line;
+    const auto read_bytes = [&line] {
+        const std::size_t value_pos = line.find_first_of("0123456789");
+        return value_pos != std::string::npos ? std::stoull(line.substr(value_pos)) * 1024 : 0;
+    };
+    while (std::getline(smaps, line))
+    {
+        if (line.empty())
+            continue;
+        if (std::isxdigit(static_cast<unsigned char>(line.front())) && line.find('-') != std::string::npos)
+        {
+            mapping_bytes& mapping = mappings.emplace_back();
+            std::size_t end_pos = 0;
+            mapping.begin = std::stoull(line, &end_pos, 16);
+            mapping.end = std::stoull(line.substr(end_pos + 1), nullptr, 16);
+        }
+        else if (mappings.empty())
+            continue;
+        else if (line.starts_with("Shared_Clean:"))
+            mappings.back().shared_bytes += read_bytes();
+        else if (line.starts_with("Private_Clean:"))
+            mappings.back().private_bytes += read_bytes();
+        else if (line.starts_with("Shared_Dirty:"))
+        {
+            const std::size_t bytes = read_bytes();
+            mappings.back().shared_bytes += bytes;
+            mappings.back().dirty_bytes += bytes;
+        }
+        else if (line.starts_with("Private_Dirty:"))
+        {
+            const std::size_t bytes = read_bytes();
+            mappings.back().private_bytes += bytes;
+            mappings.back().dirty_bytes += bytes;
+        }
+    }
+    return mappings;
+}
+
+std::size_t resident_bytes(const private_::loaded_segment& segment)
+{
+    const std::size_t page_size = private_::page_size();
+    std::vector<unsigned char> page_states(segment.size / page_size);
+    if (mincore(reinterpret_cast<void*>(segment.address), segment.size, page_states.data()) != 0) [[unlikely]]
+        return 0;
+    return static_cast<std::size_t>(std::ranges::count_if(page_states, [](unsigned char state) { return state & 1; }))
+           * page_size;
+}
+
+// Sum some bytes of the mappings overlapping a segment, prorated when a mapping is not fully in the segment.
+std::size_t segment_bytes(const private_::loaded_segment& segment, const std::vector<mapping_bytes>& mappings,
+                          std::size_t mapping_bytes::*bytes)
+{
+    const std::uintptr_t segment_end = segment.address + segment.size;
+    auto iter = std::ranges::upper_bound(mappings, segment.address, {}, &mapping_bytes::end);
+    std::size_t result = 0;
+    for (; iter != mappings.end() && iter->begin < segment_end; ++iter)
+    {
+        const std::uintptr_t overlap_begin = std::max(iter->begin, segment.address);
+        const std::uintptr_t overlap_end = std::min(iter->end, segment_end);
+        const std::size_t mapping_size = iter->end - iter->begin;
+        result += (*iter).*bytes * (overlap_end - overlap_begin) / mapping_size;
+    }
+    return result;
+}
+#endif
+} // namespace
+
+std::vector<plugin_memory_footprint> memory_footprints(std::span<const plugin_base* const> plugins)
+{
+    std::vector<plugin_memory_footprint> footprints(plugins.size());
+#if defined(__linux__)
+    const std::vector<mapping_bytes> mappings = read_mappings_bytes();
+    private_::read_section section;
+    for (std::size_t i = 0; i < plugins.size(); ++i)
+    {
+        const private_::loaded_library* library = plugins[i]->library_.load();
+        if (!library)
+            continue;
+        for (const private_::loaded_segment& segment : private_::find_loaded_segments(library->handle))
+        {
+            const std::size_t dirty_bytes = segment_bytes(segment, mappings, &mapping_bytes::dirty_bytes);
+            footprints[i].segments.push_back(segment_footprint{ .address = segment.address,
+                                                                .mapped_bytes = segment.size,
+                                                                .resident_bytes = resident_bytes(segment),
+                                                                .dirty_bytes = dirty_bytes,
+                                                                .readable = segment.readable,
+                                                                .writable = segment.writable,
+                                                                .executable = segment.executable });
+        }
+    }
+#endif
+    return footprints;
+}
+
+std::vector<plugin_memory_sharing> memory_sharings(int process_id, std::span<const plugin_base* const> plugins)
+{
+    std::vector<plugin_memory_sharing> sharings(plugins.size());
+#if defined(__linux__)
+    const std::vector<mapping_bytes> mappings = read_mappings_bytes(std::format("/proc/{}/smaps", process_id));
+    private_::read_section section;
+    for (std::size_t i = 0; i < plugins.size(); ++i)
+    {
+        const private_::loaded_library* library = plugins[i]->library_.load();
+        if (!library)
+            continue;
+        for (const private_::loaded_segment& segment : private_::find_loaded_segments(library->handle))
+        {
+            sharings[i].shared_bytes += segment_bytes(segment, mappings, &mapping_bytes::shared_bytes);
+            sharings[i].private_bytes += segment_bytes(segment, mappings, &mapping_bytes::private_bytes);
+        }
+    }
+#endif
+    return sharings;
+}
+
+} // namespace plug
+} // namespace arba
@@ -1,12 +1,24 @@
+#include <arba/plug/lifecycle.hpp>
 #include <arba/plug/plugin_base.hpp>
+#include <arba/plug/plugin_integrity.hpp>
+#include <arba/plug/plugin_trace.hpp>
+#include <arba/plug/read_section.hpp>
+
+#include "loaded_library.hpp"
+#include "loaded_segments.hpp"
+#include "symbol_table.hpp"
 
 #include <cassert>
 #include <format>
 #include <iostream>
+#include <memory>
+#include <system_error>
+#include <utility>
 #if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
 #include <windows.h>
 #else
 #include <dlfcn.h>
+#include <sys/resource.h>
 #endif
 
 inline namespace arba
@@ -20,9 +32,9 @@ namespace plug
 // UNIX API (dl):
 //   https://linux.die.net/man/3/dlopen
 
-plugin_base::plugin_base(const std::filesystem::path& plugin_path)
+plugin_base::plugin_base(const std::filesystem::path& plugin_path, const plugin_load_options& options)
 {
-    load_from_file(plugin_path);
+    load_from_file(plugin_path, options);
 }
 
 plugin_base::~plugin_base()
@@ -42,87 +54,309 @@ plugin_base::~plugin_base()
 }
 
 plugin_base::plugin_base(plugin_base&& other)
+    : library_(other.library_.exchange(nullptr)), load_id_(other.load_id_.exchange(0))
 {
-    handle_ = other.handle_;
-    other.handle_ = nullptr;
 }
 
 plugin_base& plugin_base::operator=(plugin_base&& other)
 {
     if (&other != this)
     {
-        if (handle_)
+        if (is_loaded())
             unload();
-        handle_ = other.handle_;
-        other.handle_ = nullptr;
+        library_.store(other.library_.exchange(nullptr));
+        load_id_.store(other.load_id_.exchange(0));
     }
     return *this;
 }
 
-void plugin_base::load_from_file(const std::filesystem::path& plugin_path)
+namespace
+{
+struct page_fault_counters
+{
+    std::uint64_t minor = 0;
+    std::uint64_t major = 0;
+};
+
+page_fault_counters thread_page_fault_counters()
+{
+#if defined(__linux__)
+    rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) == 0)
+        return page_fault_counters{ .minor = static_cast<std::uint64_t>(usage.ru_minflt),
+                                    .major = static_cast<std::uint64_t>(usage.ru_majflt) };
+#endif
+    return page_fault_counters{};
+}
+
+plugin_load_stats make_load_stats(void* handle, std::chrono::steady_clock::time_point start_time,
+                                  const page_fault_counters& start_page_faults)
+{
+    const auto end_time = std::chrono::steady_clock::now();
+    const page_fault_counters end_page_faults = thread_page_fault_counters();
+    plugin_load_stats stats;
+    stats.load_duration = end_time - start_time;
+    stats.minor_page_faults = end_page_faults.minor - start_page_faults.minor;
+    stats.major_page_faults = end_page_faults.major - start_page_faults.major;
+    for (const private_::loaded_segment& segment : private_::find_loaded_segments(handle))
+    {
+        stats.mapped_bytes += segment.size;
+        ++stats.mapped_segment_count;
+    }
+    return stats;
+}
+
+void* try_find_symbol(void* handle, const std::string& symbol_name) noexcept
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HINSTANCE>(handle), symbol_name.c_str()));
+#else
+    return dlsym(handle, symbol_name.c_str());
+#endif
+}
+
+[[noreturn]] void throw_find_symbol_error([[maybe_unused]] std::errc error, const std::string& message)
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    throw plugin_find_symbol_error(std::make_error_code(error), message);
+#else
+    throw plugin_find_symbol_error(message);
+#endif
+}
+
+// The identifier of the next load of a plugin, in the process.
+std::atomic<std::uint64_t> next_load_id = 1;
+
+// Publish an updated copy of the library, so that concurrent readers never see a partial update.
+template <class UpdateFunction>
+void update_library(std::atomic<private_::loaded_library*>& library, UpdateFunction update_function)
+{
+    auto updated_library = std::make_unique<private_::loaded_library>(*library.load());
+    update_function(*updated_library);
+    std::unique_ptr<private_::loaded_library> old_library(library.exchange(updated_library.release()));
+    private_::read_section::synchronize();
+}
+} // namespace
+
+void plugin_base::load_from_file(const std::filesystem::path& plugin_path, const plugin_load_options& options)
 {
-    assert(!is_loaded());
+    trace_scope trace("load", "load_from_file", plugin_path);
+    plugin_variant_selection selection;
+    if (options.select_cpu_variant || options.forced_cpu_variant)
+        selection = select_plugin_variant(plugin_path, options.forced_cpu_variant);
+    const std::filesystem::path& library_path = selection.plugin_path.empty() ? plugin_path : selection.plugin_path;
+
+    const page_fault_counters start_page_faults = thread_page_fault_counters();
+    const auto start_time = std::chrono::steady_clock::now();
+    auto library = std::make_unique<private_::loaded_library>();
 #if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
     static_assert(std::is_pointer_v<HINSTANCE>);
     static_assert(std::is_nothrow_convertible_v<HINSTANCE, void*>);
 
-    HINSTANCE instance = LoadLibraryW(plugin_path.native().c_str());
+    if (options.integrity_verifier)
+        options.integrity_verifier->verify(library_path);
+    HINSTANCE instance = LoadLibraryW(library_path.native().c_str());
     if (!instance) [[unlikely]]
     {
         std::error_code error_code(GetLastError(), std::system_category());
         throw plugin_load_error(
-            error_code, std::format("Exception occurred while loading plugin: {}", plugin_path.generic_string()));
+            error_code, std::format("Exception occurred while loading plugin: {}", library_path.generic_string()));
     }
-    handle_ = static_cast<void*>(instance);
+    library->handle = static_cast<void*>(instance);
+    library->plugin_path = library_path;
 #else
     std::string plugin_path_string;
-    if (plugin_path.has_extension() || std::filesystem::exists(plugin_path))
+    if (library_path.has_extension() || std::filesystem::exists(library_path))
     {
-        plugin_path_string = plugin_path.generic_string();
+        plugin_path_string = library_path.generic_string();
     }
     else
     {
-        plugin_path_string = plugin_path.generic_string() + ".so";
+        plugin_path_string = library_path.generic_string() + ".so";
     }
-    void* handle = dlopen(plugin_path_string.c_str(), RTLD_LAZY);
+    if (options.integrity_verifier)
+    {
+        // dlopen() would search the library paths for a name without directory, rather than open the verified file.
+        if (!std::filesystem::path(plugin_path_string).has_parent_path())
+            plugin_path_string.insert(0, "./");
+        options.integrity_verifier->verify(plugin_path_string);
+    }
+    const int flags = RTLD_LAZY | (options.export_symbols_globally ? RTLD_GLOBAL : RTLD_LOCAL);
+    void* handle = dlopen(plugin_path_string.c_str(), flags);
     if (!handle) [[unlikely]]
     {
         std::string error_message(dlerror());
         throw plugin_load_error(std::format("Exception occurred while loading plugin: {}", error_message));
     }
-    handle_ = handle;
+    library->handle = handle;
+    library->plugin_path = plugin_path_string;
 #endif
+    library->load_stats = make_load_stats(library->handle, start_time, start_page_faults);
+    library->load_stats.variant = selection.variant;
+    library->unload_policy = options.unload_policy;
+    load_id_.store(0);
+    if (private_::loaded_library* old_library = library_.exchange(library.release()))
+        private_::release_library(std::unique_ptr<private_::loaded_library>(old_library));
+    load_id_.store(next_load_id.fetch_add(1, std::memory_order_relaxed));
+    try
+    {
+        // The host services are bound before the other steps, which may call the plugin (ex: its warm up function).
+        if (options.host)
+            bind_host(*options.host);
+        if (options.remap_text_to_huge_pages)
+            remap_text_to_huge_pages();
+        if (options.warm_up)
+            warm_up(options.warm_up_function_name);
+        if (options.initialize)
+            initialize();
+    }
+    catch (...)
+    {
+        // The plugin is not left loaded half set up (nor leaked, when the load is made by a constructor).
+        unload();
+        throw;
+    }
 }
 
-void plugin_base::unload()
+std::size_t plugin_base::remap_text_to_huge_pages()
 {
     assert(is_loaded());
-#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
-    int result = FreeLibrary(static_cast<HINSTANCE>(handle_));
-    if (result == 0) [[unlikely]]
+    std::size_t remapped_bytes = 0;
+    for (const private_::loaded_segment& segment : private_::find_loaded_segments(library_.load()->handle))
+        if (segment.executable)
+            remapped_bytes += private_::remap_segment_to_huge_pages(segment);
+    update_library(library_, [remapped_bytes](private_::loaded_library& library) {
+        library.load_stats.huge_page_text_bytes += remapped_bytes;
+    });
+    return remapped_bytes;
+}
+
+std::chrono::nanoseconds plugin_base::warm_up(std::string_view warm_up_function_name)
+{
+    assert(is_loaded());
+    const auto start_time = std::chrono::steady_clock::now();
+    for (const private_::loaded_segment& segment : private_::find_loaded_segments(library_.load()->handle))
+        private_::prefault_segment(segment);
+    if (!warm_up_function_name.empty())
     {
-        std::error_code error_code(GetLastError(), std::system_category());
-        throw plugin_unload_error(error_code,
-                                  std::format("A problem occured while unloading plugin: {}", error_code.message()));
+        using warm_up_function_type = void (*)();
+        if (void* function = try_find_symbol_pointer(std::string(warm_up_function_name)))
+            reinterpret_cast<warm_up_function_type>(function)();
     }
-#else
-    int result = dlclose(handle_);
-    if (result != 0) [[unlikely]]
+    const std::chrono::nanoseconds warm_up_duration = std::chrono::steady_clock::now() - start_time;
+    update_library(library_, [warm_up_duration](private_::loaded_library& library) {
+        library.load_stats.warm_up_duration = warm_up_duration;
+    });
+    return warm_up_duration;
+}
+
+bool plugin_base::bind_host(const host_services& services)
+{
+    assert(is_loaded());
+    void* bind_host_entry = try_find_symbol_pointer(std::string(private_::bind_host_fname));
+    if (!bind_host_entry)
+        return false;
+    if (!reinterpret_cast<private_::bind_host_type>(bind_host_entry)(services)) [[unlikely]]
     {
-        std::string error_message(dlerror());
-        throw plugin_unload_error(std::format("A problem occured while unloading plugin: {}", error_message));
-    }
+        const std::string message = std::format("The plugin {} rejected the host services (version {}).",
+                                                plugin_path().generic_string(), services.version);
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+        throw plugin_load_error(std::make_error_code(std::errc::not_supported), message);
+#else
+        throw plugin_load_error(message);
 #endif
-    handle_ = nullptr;
+    }
+    return true;
+}
+
+bool plugin_base::initialize()
+{
+    assert(is_loaded());
+    trace_scope trace("initialize", "initialize", library_.load()->plugin_path);
+    if (library_.load()->initialized)
+        return false;
+    using lifecycle_hook_type = void (*)();
+    const auto start_time = std::chrono::steady_clock::now();
+    if (void* on_load = try_find_symbol_pointer(std::string(private_::on_load_fname)))
+        reinterpret_cast<lifecycle_hook_type>(on_load)();
+    const std::chrono::nanoseconds initialize_duration = std::chrono::steady_clock::now() - start_time;
+    void* on_unload = try_find_symbol_pointer(std::string(private_::on_unload_fname));
+    update_library(library_, [initialize_duration, on_unload](private_::loaded_library& library) {
+        library.initialized = true;
+        library.on_unload = reinterpret_cast<lifecycle_hook_type>(on_unload);
+        library.load_stats.initialize_duration = initialize_duration;
+    });
+    return true;
+}
+
+bool plugin_base::is_initialized() const
+{
+    private_::read_section section;
+    const private_::loaded_library* library = library_.load();
+    return library && library->initialized;
 }
 
-void* plugin_base::find_symbol_pointer(const std::string& symbol_name)
+void plugin_base::unload()
+{
+    assert(is_loaded());
+    trace_scope trace("unload", "unload", library_.load()->plugin_path);
+    load_id_.store(0);
+    private_::release_library(std::unique_ptr<private_::loaded_library>(library_.exchange(nullptr)));
+}
+
+void plugin_base::unload_in_background()
 {
     assert(is_loaded());
+    trace_scope trace("unload", "unload_in_background", library_.load()->plugin_path);
+    load_id_.store(0);
+    private_::close_library_in_background(std::unique_ptr<private_::loaded_library>(library_.exchange(nullptr)));
+}
+
+void wait_for_background_unloads()
+{
+    private_::wait_background_closes();
+}
+
+std::filesystem::path plugin_base::plugin_path() const
+{
+    private_::read_section section;
+    const private_::loaded_library* library = library_.load();
+    return library ? library->plugin_path : std::filesystem::path();
+}
+
+plugin_load_stats plugin_base::load_stats() const
+{
+    private_::read_section section;
+    const private_::loaded_library* library = library_.load();
+    return library ? library->load_stats : plugin_load_stats{};
+}
+
+plugin_memory_footprint plugin_base::memory_footprint() const
+{
+    const plugin_base* self = this;
+    return std::move(memory_footprints(std::span(&self, 1)).front());
+}
+
+std::shared_ptr<call_tracker> plugin_base::find_call_tracker() const
+{
+    private_::read_section section;
+    const private_::loaded_library* library = library_.load();
+    return library ? library->calls : nullptr;
+}
+
+void* plugin_base::find_symbol_pointer(const std::string& symbol_name) const
+{
+    trace_scope trace("symbol", "find_symbol_pointer", symbol_name);
+    private_::read_section section;
+    const private_::loaded_library* library = library_.load();
+    if (!library) [[unlikely]]
+        throw_find_symbol_error(
+            std::errc::bad_file_descriptor,
+            std::format("Exception occurred while looking for address of {}: no plugin is loaded", symbol_name));
 #if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
     static_assert(std::is_pointer_v<FARPROC>);
 
-    FARPROC pointer = GetProcAddress(static_cast<HINSTANCE>(handle_), symbol_name.c_str());
+    FARPROC pointer = GetProcAddress(static_cast<HINSTANCE>(library->handle), symbol_name.c_str());
     if (!pointer) [[unlikely]]
     {
         std::error_code error_code(GetLastError(), std::system_category());
@@ -132,7 +366,7 @@ void* plugin_base::find_symbol_pointer(const std::string& symbol_name)
     return reinterpret_cast<void*>(pointer);
 #else
     dlerror(); // Clear any existing error
-    void* pointer = dlsym(handle_, symbol_name.c_str());
+    void* pointer = dlsym(library->handle, symbol_name.c_str());
     if (!pointer) [[unlikely]]
     {
         std::string error_message(dlerror());
@@ -143,5 +377,45 @@ void* plugin_base::find_symbol_pointer(const std::string& symbol_name)
 #endif
 }
 
+void plugin_base::find_symbols(std::span<const std::string_view> symbol_names, std::span<void*> symbol_pointers) const
+{
+    assert(symbol_pointers.size() >= symbol_names.size());
+    trace_scope trace("symbol", "find_symbols");
+    private_::read_section section;
+    const private_::loaded_library* library = library_.load();
+    const std::optional<private_::gnu_hash_table> hash_table =
+        library ? private_::gnu_hash_table::from_handle(library->handle) : std::nullopt;
+    std::string missing_symbols;
+    std::string symbol_name;
+    for (std::size_t i = 0; i < symbol_names.size(); ++i)
+    {
+        void* pointer = hash_table ? hash_table->find(symbol_names[i]) : nullptr;
+        if (!pointer && library)
+        {
+            symbol_name = symbol_names[i];
+            pointer = try_find_symbol(library->handle, symbol_name);
+        }
+        if (!pointer) [[unlikely]]
+        {
+            if (!missing_symbols.empty())
+                missing_symbols += ", ";
+            missing_symbols += symbol_names[i];
+        }
+        symbol_pointers[i] = pointer;
+    }
+    if (!missing_symbols.empty()) [[unlikely]]
+        throw_find_symbol_error(std::errc::invalid_argument,
+                                std::format("Exception occurred while looking for address of symbols: {}",
+                                            missing_symbols));
+}
+
+void* plugin_base::try_find_symbol_pointer(const std::string& symbol_name) const noexcept
+{
+    trace_scope trace("symbol", "try_find_symbol_pointer", symbol_name);
+    private_::read_section section;
+    const private_::loaded_library* library = library_.load();
+    return library ? try_find_symbol(library->handle, symbol_name) : nullptr;
+}
+
 } // namespace plug
 } // namespace arba
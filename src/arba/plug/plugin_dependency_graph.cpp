@@ -0,0 +1,102 @@
+#include <arba/plug/plugin_dependency_graph.hpp>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+inline namespace arba
+{
+namespace plug
+{
+
+std::vector<plugin_load_spec> read_plugin_manifest(const std::filesystem::path& manifest_path)
+{
+    std::ifstream stream(manifest_path);
+    if (!stream) [[unlikely]]
+        throw std::runtime_error(std::format("Cannot read plugin manifest '{}'.", manifest_path.generic_string()));
+
+    std::vector<plugin_load_spec> specs;
+    std::string line;
+    for (std::size_t line_number = 1; std::getline(stream, line); ++line_number)
+    {
+        std::istringstream line_stream(line);
+        std::string name;
+        if (!(line_stream >> name) || name.starts_with('#'))
+            continue;
+        std::string plugin_path;
+        if (!(line_stream >> plugin_path)) [[unlikely]]
+            throw std::runtime_error(std::format("Line {} of plugin manifest '{}' has no plugin path.", line_number,
+                                                 manifest_path.generic_string()));
+        plugin_load_spec& spec = specs.emplace_back();
+        spec.name = std::move(name);
+        spec.plugin_path = manifest_path.parent_path() / plugin_path;
+        for (std::string dependency; line_stream >> dependency;)
+            spec.dependencies.push_back(std::move(dependency));
+    }
+    return specs;
+}
+
+plugin_dependency_graph::plugin_dependency_graph(std::span<const plugin_load_spec> specs,
+                                                 std::span<const std::string_view> loaded_names)
+    : nodes_(specs.size())
+{
+    std::unordered_map<std::string_view, std::size_t> node_indexes;
+    for (std::size_t i = 0; i < specs.size(); ++i)
+    {
+        const std::string_view name = specs[i].name;
+        if (std::ranges::find(loaded_names, name) != loaded_names.end()) [[unlikely]]
+            throw std::invalid_argument(std::format("A plugin named '{}' is already loaded.", name));
+        if (!node_indexes.emplace(name, i).second) [[unlikely]]
+            throw std::invalid_argument(std::format("A plugin named '{}' appears twice in the load specs.", name));
+    }
+
+    for (std::size_t i = 0; i < specs.size(); ++i)
+    {
+        for (const std::string& dependency : specs[i].dependencies)
+        {
+            if (const auto iter = node_indexes.find(dependency); iter != node_indexes.end())
+            {
+                nodes_[i].dependencies.push_back(iter->second);
+                nodes_[iter->second].dependents.push_back(i);
+            }
+            else if (std::ranges::find(loaded_names, dependency) == loaded_names.end()) [[unlikely]]
+                throw std::invalid_argument(
+                    std::format("Plugin '{}' depends on unknown plugin '{}'.", specs[i].name, dependency));
+        }
+    }
+
+    // Kahn's algorithm: the plugins left with unloaded dependencies are in a cycle or depend on one.
+    std::vector<std::size_t> remaining_counts(nodes_.size());
+    topological_order_.reserve(nodes_.size());
+    for (std::size_t i = 0; i < nodes_.size(); ++i)
+        if ((remaining_counts[i] = nodes_[i].dependencies.size()) == 0)
+            topological_order_.push_back(i);
+    for (std::size_t k = 0; k < topological_order_.size(); ++k)
+        for (std::size_t dependent : nodes_[topological_order_[k]].dependents)
+            if (--remaining_counts[dependent] == 0)
+                topological_order_.push_back(dependent);
+    if (topological_order_.size() == nodes_.size()) [[likely]]
+        return;
+
+    // Follow unloaded dependencies until a plugin is met twice, to report the cycle.
+    const auto is_unloaded = [&remaining_counts](std::size_t node) { return remaining_counts[node] > 0; };
+    std::size_t node = *std::ranges::find_if(std::views::iota(std::size_t(0), nodes_.size()), is_unloaded);
+    std::vector<std::size_t> path;
+    while (std::ranges::find(path, node) == path.end())
+    {
+        path.push_back(node);
+        node = *std::ranges::find_if(nodes_[node].dependencies, is_unloaded);
+    }
+    std::string cycle;
+    for (auto iter = std::ranges::find(path, node); iter != path.end(); ++iter)
+        cycle += std::format("{} -> ", specs[*iter].name);
+    cycle += specs[node].name;
+    throw std::invalid_argument(std::format("Plugin dependencies contain a cycle: {}.", cycle));
+}
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,455 @@
+#include <arba/plug/exception.hpp>
+#include <arba/plug/plugin_integrity.hpp>
+#include <arba/plug/run_on_threads.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <chrono>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace
+{
+constexpr std::size_t block_size = 64;
+
+constexpr std::array<std::uint32_t, 8> initial_state{ 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                                                      0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+
+alignas(16) constexpr std::array<std::uint32_t, 64> round_constants{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+using compress_function = void (*)(std::uint32_t* state, const std::byte* blocks, std::size_t block_count) noexcept;
+
+// Big endian read, compiled to a load and a byte swap.
+inline std::uint32_t read_uint32(const std::byte* bytes) noexcept
+{
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value = (value << 8) | std::to_integer<std::uint32_t>(bytes[i]);
+    return value;
+}
+
+void compress_blocks(std::uint32_t* state, const std::byte* blocks, std::size_t block_count) noexcept
+{
+    for (; block_count > 0; --block_count, blocks += block_size)
+    {
+        std::array<std::uint32_t, 64> words;
+        for (std::size_t i = 0; i < 16; ++i)
+            words[i] = read_uint32(blocks + 4 * i);
+        for (std::size_t i = 16; i < 64; ++i)
+        {
+            const std::uint32_t sigma_0 =
+                std::rotr(words[i - 15], 7) ^ std::rotr(words[i - 15], 18) ^ (words[i - 15] >> 3);
+            const std::uint32_t sigma_1 =
+                std::rotr(words[i - 2], 17) ^ std::rotr(words[i - 2], 19) ^ (words[i - 2] >> 10);
+            words[i] = words[i - 16] + sigma_0 + words[i - 7] + sigma_1;
+        }
+        std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            const std::uint32_t sum_1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+            const std::uint32_t choice = (e & f) ^ (~e & g);
+            const std::uint32_t temporary_1 = h + sum_1 + choice + round_constants[i] + words[i];
+            const std::uint32_t sum_0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+            const std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + temporary_1;
+            d = c;
+            c = b;
+            b = a;
+            a = temporary_1 + sum_0 + majority;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define ARBA_PLUG_SHA_EXTENSIONS
+
+// The SHA-NI instructions run two rounds each, on the state split in the ABEF and CDGH halves, and compute the
+// message schedule four words at a time.
+__attribute__((target("sha,sse4.1"))) void compress_blocks_sha_extensions(std::uint32_t* state,
+                                                                           const std::byte* blocks,
+                                                                           std::size_t block_count) noexcept
+{
+    const __m128i byte_swap_mask = _mm_set_epi64x(0x0C0D0E0F08090A0BLL, 0x0405060700010203LL);
+    const __m128i dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+    const __m128i hgfe = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+    __m128i abef = _mm_alignr_epi8(dcba, hgfe, 8);
+    __m128i cdgh = _mm_blend_epi16(hgfe, dcba, 0xF0);
+    for (; block_count > 0; --block_count, blocks += block_size)
+    {
+        const __m128i abef_save = abef;
+        const __m128i cdgh_save = cdgh;
+        __m128i words[4];
+        for (std::size_t group = 0; group < 16; ++group)
+        {
+            __m128i& group_words = words[group % 4];
+            if (group < 4)
+                group_words = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * group)), byte_swap_mask);
+            else
+            {
+                const __m128i& previous_words = words[(group + 3) % 4];
+                group_words = _mm_sha256msg1_epu32(group_words, words[(group + 1) % 4]);
+                group_words = _mm_add_epi32(group_words, _mm_alignr_epi8(previous_words, words[(group + 2) % 4], 4));
+                group_words = _mm_sha256msg2_epu32(group_words, previous_words);
+            }
+            const __m128i message = _mm_add_epi32(
+                group_words, _mm_load_si128(reinterpret_cast<const __m128i*>(round_constants.data() + 4 * group)));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0E));
+        }
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+    }
+    const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+#endif
+
+compress_function select_compress_function() noexcept
+{
+#if defined(ARBA_PLUG_SHA_EXTENSIONS)
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    const bool has_sha = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA);
+    if (has_sha && __builtin_cpu_supports("sse4.1"))
+        return &compress_blocks_sha_extensions;
+#endif
+    return &compress_blocks;
+}
+
+[[noreturn]] void throw_unreadable_file_error(const std::filesystem::path& file_path)
+{
+    throw plugin_integrity_error(std::format("Cannot read the plugin file {}.", file_path.generic_string()));
+}
+
+bool parse_digest(std::string_view text, content_digest& digest) noexcept
+{
+    if (text.size() != 2 * digest.size())
+        return false;
+    for (std::size_t i = 0; i < digest.size(); ++i)
+    {
+        const char* const first = text.data() + 2 * i;
+        const auto [end, error] = std::from_chars(first, first + 2, digest[i], 16);
+        if (error != std::errc() || end != first + 2)
+            return false;
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view text) noexcept
+{
+    const std::size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+        return {};
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+} // namespace
+
+content_digest content_hash(std::span<const std::byte> content) noexcept
+{
+    // The CPU does not change during the process.
+    static const compress_function compress = select_compress_function();
+    std::array<std::uint32_t, 8> state = initial_state;
+    const std::size_t full_block_count = content.size() / block_size;
+    compress(state.data(), content.data(), full_block_count);
+
+    // The padding: a 1 bit, zeros, then the size in bits, in one or two blocks.
+    std::array<std::byte, 2 * block_size> last_blocks{};
+    const std::span<const std::byte> tail = content.subspan(full_block_count * block_size);
+    std::ranges::copy(tail, last_blocks.begin());
+    last_blocks[tail.size()] = std::byte{ 0x80 };
+    const std::size_t last_block_count = tail.size() + 9 <= block_size ? 1 : 2;
+    const std::uint64_t bit_count = std::uint64_t(content.size()) * 8;
+    for (std::size_t i = 0; i < 8; ++i)
+        last_blocks[last_block_count * block_size - 1 - i] = std::byte(bit_count >> (8 * i));
+    compress(state.data(), last_blocks.data(), last_block_count);
+
+    content_digest digest;
+    for (std::size_t i = 0; i < digest.size(); ++i)
+        digest[i] = std::uint8_t(state[i / 4] >> (24 - 8 * (i % 4)));
+    return digest;
+}
+
+std::string to_hex_string(const content_digest& digest)
+{
+    constexpr std::string_view hex_digits = "0123456789abcdef";
+    std::string text;
+    text.reserve(2 * digest.size());
+    for (std::uint8_t byte : digest)
+        text.append({ hex_digits[byte >> 4], hex_digits[byte & 0xF] });
+    return text;
+}
+
+content_digest hash_plugin_file(const std::filesystem::path& file_path)
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    std::ifstream stream(file_path, std::ios::binary);
+    if (!stream) [[unlikely]]
+        throw_unreadable_file_error(file_path);
+    std::ostringstream content;
+    content << stream.rdbuf();
+    const std::string bytes = std::move(content).str();
+    return content_hash(std::as_bytes(std::span(bytes)));
+#else
+    const int file_descriptor = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_descriptor < 0) [[unlikely]]
+        throw_unreadable_file_error(file_path);
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) != 0) [[unlikely]]
+    {
+        close(file_descriptor);
+        throw_unreadable_file_error(file_path);
+    }
+    const std::size_t size = static_cast<std::size_t>(file_status.st_size);
+    if (size == 0)
+    {
+        close(file_descriptor);
+        return content_hash({});
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    close(file_descriptor);
+    if (mapping == MAP_FAILED) [[unlikely]]
+        throw_unreadable_file_error(file_path);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    const content_digest digest = content_hash(std::span(static_cast<const std::byte*>(mapping), size));
+    munmap(mapping, size);
+    return digest;
+#endif
+}
+
+plugin_integrity_verifier::plugin_integrity_verifier(const std::filesystem::path& manifest_path,
+                                                     std::filesystem::path cache_path)
+    : cache_path_(std::move(cache_path))
+{
+    std::ifstream stream(manifest_path);
+    if (!stream) [[unlikely]]
+        throw plugin_integrity_error(
+            std::format("Cannot read integrity manifest '{}'.", manifest_path.generic_string()));
+    std::string line;
+    for (std::size_t line_number = 1; std::getline(stream, line); ++line_number)
+    {
+        const std::string_view text = trim(line);
+        if (text.empty() || text.starts_with('#'))
+            continue;
+        const std::size_t separator_pos = text.find_first_of(" \t");
+        const std::string_view digest_text = text.substr(0, separator_pos);
+        content_digest digest;
+        std::string_view file_name =
+            separator_pos == std::string_view::npos ? std::string_view() : trim(text.substr(separator_pos));
+        // sha256sum marks the files hashed in binary mode with '*'.
+        if (file_name.starts_with('*'))
+            file_name.remove_prefix(1);
+        if (!parse_digest(digest_text, digest) || file_name.empty()) [[unlikely]]
+            throw plugin_integrity_error(std::format("Line {} of integrity manifest '{}' is invalid.", line_number,
+                                                     manifest_path.generic_string()));
+        manifest_[make_key_(manifest_path.parent_path() / file_name)] = digest;
+    }
+    read_cache_();
+}
+
+void plugin_integrity_verifier::verify(const std::filesystem::path& plugin_path)
+{
+    const std::string key = make_key_(plugin_path);
+    const auto manifest_iter = manifest_.find(key);
+    if (manifest_iter == manifest_.end()) [[unlikely]]
+        throw plugin_integrity_error(
+            std::format("The plugin {} is not in the integrity manifest.", plugin_path.generic_string()));
+    const file_attributes_ attributes = read_attributes_(plugin_path);
+    content_digest digest;
+    bool cached = false;
+    {
+        std::scoped_lock lock(mutex_);
+        if (const auto iter = cache_.find(key); iter != cache_.end() && iter->second.attributes == attributes)
+        {
+            digest = iter->second.digest;
+            cached = true;
+        }
+    }
+    if (!cached)
+    {
+        digest = hash_plugin_file(plugin_path);
+        std::scoped_lock lock(mutex_);
+        cache_[key] = cache_entry_{ .attributes = attributes, .digest = digest };
+        ++hashed_file_count_;
+    }
+    if (digest != manifest_iter->second) [[unlikely]]
+        throw plugin_integrity_error(
+            std::format("The content hash {} of the plugin {} is not the one of the integrity manifest ({}).",
+                        to_hex_string(digest), plugin_path.generic_string(), to_hex_string(manifest_iter->second)));
+}
+
+void plugin_integrity_verifier::verify_all(std::span<const std::filesystem::path> plugin_paths,
+                                           std::size_t max_thread_count)
+{
+    if (plugin_paths.empty())
+        return;
+    std::atomic_size_t next_index = 0;
+    std::mutex error_mutex;
+    std::vector<std::pair<std::size_t, std::string>> errors;
+    const auto verify_next_files = [&] {
+        for (std::size_t index = next_index++; index < plugin_paths.size(); index = next_index++)
+        {
+            try
+            {
+                verify(plugin_paths[index]);
+            }
+            catch (const plugin_integrity_error& error)
+            {
+                std::scoped_lock lock(error_mutex);
+                errors.emplace_back(index, error.what());
+            }
+        }
+    };
+    private_::run_on_threads(std::clamp<std::size_t>(max_thread_count, 1, plugin_paths.size()), verify_next_files);
+
+    if (!errors.empty()) [[unlikely]]
+    {
+        std::ranges::sort(errors);
+        std::string message = std::format("{} plugin(s) failed the integrity verification:", errors.size());
+        for (const auto& [index, error] : errors)
+            message.append("\n").append(error);
+        throw plugin_integrity_error(message);
+    }
+}
+
+void plugin_integrity_verifier::save_cache() const
+{
+    if (cache_path_.empty())
+        return;
+    // The cache is written in a temporary file, then renamed, so that it is never read partially written.
+    std::filesystem::path temporary_path = cache_path_;
+    temporary_path += ".tmp";
+    {
+        std::ofstream stream(temporary_path, std::ios::trunc);
+        std::scoped_lock lock(mutex_);
+        for (const auto& [key, entry] : cache_)
+            stream << std::format("{} {} {} {} {} {} {}\n", to_hex_string(entry.digest), entry.attributes.device,
+                                  entry.attributes.inode, entry.attributes.size, entry.attributes.modification_time,
+                                  entry.attributes.change_time, key);
+        if (!stream.flush()) [[unlikely]]
+            throw plugin_integrity_error(
+                std::format("Cannot write integrity cache '{}'.", temporary_path.generic_string()));
+    }
+    std::error_code error_code;
+    std::filesystem::rename(temporary_path, cache_path_, error_code);
+    if (error_code) [[unlikely]]
+        throw plugin_integrity_error(std::format("Cannot write integrity cache '{}': {}.",
+                                                 cache_path_.generic_string(), error_code.message()));
+}
+
+std::size_t plugin_integrity_verifier::hashed_file_count() const
+{
+    std::scoped_lock lock(mutex_);
+    return hashed_file_count_;
+}
+
+plugin_integrity_verifier::file_attributes_
+plugin_integrity_verifier::read_attributes_(const std::filesystem::path& file_path)
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    std::error_code error_code;
+    const std::uintmax_t size = std::filesystem::file_size(file_path, error_code);
+    const auto modification_time = std::filesystem::last_write_time(file_path, error_code);
+    if (error_code) [[unlikely]]
+        throw_unreadable_file_error(file_path);
+    return file_attributes_{ .size = size,
+                             .modification_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                      modification_time.time_since_epoch())
+                                                      .count() };
+#else
+    struct stat file_status;
+    if (stat(file_path.c_str(), &file_status) != 0) [[unlikely]]
+        throw_unreadable_file_error(file_path);
+#if defined(__APPLE__)
+    const std::int64_t modification_time =
+        std::int64_t(file_status.st_mtimespec.tv_sec) * 1'000'000'000 + file_status.st_mtimespec.tv_nsec;
+    const std::int64_t change_time =
+        std::int64_t(file_status.st_ctimespec.tv_sec) * 1'000'000'000 + file_status.st_ctimespec.tv_nsec;
+#else
+    const std::int64_t modification_time =
+        std::int64_t(file_status.st_mtim.tv_sec) * 1'000'000'000 + file_status.st_mtim.tv_nsec;
+    const std::int64_t change_time =
+        std::int64_t(file_status.st_ctim.tv_sec) * 1'000'000'000 + file_status.st_ctim.tv_nsec;
+#endif
+    return file_attributes_{ .device = static_cast<std::uint64_t>(file_status.st_dev),
+                             .inode = static_cast<std::uint64_t>(file_status.st_ino),
+                             .size = static_cast<std::uint64_t>(file_status.st_size),
+                             .modification_time = modification_time,
+                             .change_time = change_time };
+#endif
+}
+
+std::string plugin_integrity_verifier::make_key_(const std::filesystem::path& file_path)
+{
+    return std::filesystem::absolute(file_path).lexically_normal().generic_string();
+}
+
+void plugin_integrity_verifier::read_cache_()
+{
+    if (cache_path_.empty())
+        return;
+    std::ifstream stream(cache_path_);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        std::istringstream line_stream(line);
+        cache_entry_ entry;
+        std::string digest_text;
+        std::string key;
+        if (!(line_stream >> digest_text >> entry.attributes.device >> entry.attributes.inode >> entry.attributes.size
+              >> entry.attributes.modification_time >> entry.attributes.change_time)
+            || !parse_digest(digest_text, entry.digest) || !std::getline(line_stream >> std::ws, key) || key.empty())
+            [[unlikely]]
+        {
+            cache_.clear();
+            return;
+        }
+        cache_.insert_or_assign(std::move(key), entry);
+    }
+}
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,166 @@
+#include <arba/plug/plugin_overlay.hpp>
+
+#include "loaded_library.hpp"
+#include "symbol_table.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <utility>
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+struct symbol_overlay_index::layer_
+{
+    std::optional<gnu_hash_table> table;
+    // The index of the layer in the stack, from the bottom.
+    std::size_t position = 0;
+};
+
+symbol_overlay_index::symbol_overlay_index() = default;
+symbol_overlay_index::symbol_overlay_index(symbol_overlay_index&&) noexcept = default;
+symbol_overlay_index& symbol_overlay_index::operator=(symbol_overlay_index&&) noexcept = default;
+symbol_overlay_index::~symbol_overlay_index() = default;
+
+void symbol_overlay_index::push_back(const plugin_base& plugin)
+{
+    auto layer = std::make_unique<layer_>();
+    layer->position = layers_.size();
+    const loaded_library* library = plugin.library_.load();
+    if (library)
+        layer->table = gnu_hash_table::from_handle(library->handle);
+    const std::vector<gnu_hash_table::symbol> symbols =
+        layer->table ? layer->table->symbols() : std::vector<gnu_hash_table::symbol>{};
+    const layer_& pushed_layer = *layers_.emplace_back(std::move(layer));
+    for (const gnu_hash_table::symbol& symbol : symbols)
+        insert_(symbol.name, symbol.address, &pushed_layer);
+}
+
+void symbol_overlay_index::erase(std::size_t layer_index)
+{
+    const layer_* layer = layers_[layer_index].get();
+    if (layer->table)
+    {
+        for (const gnu_hash_table::symbol& symbol : layer->table->symbols())
+        {
+            slot_* slot = const_cast<slot_*>(find_slot_(symbol.name, std::hash<std::string_view>{}(symbol.name)));
+            // The symbol is overridden by an upper layer.
+            if (!slot || slot->layer != layer)
+                continue;
+            // Give the symbol back to the topmost layer below which defines it.
+            slot->layer = nullptr;
+            for (std::size_t i = layer_index; i-- > 0;)
+            {
+                const layer_& lower_layer = *layers_[i];
+                if (void* address = lower_layer.table ? lower_layer.table->find(symbol.name) : nullptr)
+                {
+                    slot->address = address;
+                    slot->layer = &lower_layer;
+                    break;
+                }
+            }
+            if (!slot->layer)
+                remove_(*slot);
+        }
+    }
+    layers_.erase(layers_.begin() + layer_index);
+    for (std::size_t i = layer_index; i < layers_.size(); ++i)
+        layers_[i]->position = i;
+}
+
+void* symbol_overlay_index::find(std::string_view symbol_name) const noexcept
+{
+    const slot_* slot = find_slot_(symbol_name, std::hash<std::string_view>{}(symbol_name));
+    return slot ? slot->address : nullptr;
+}
+
+std::size_t symbol_overlay_index::find_layer(std::string_view symbol_name) const noexcept
+{
+    const slot_* slot = find_slot_(symbol_name, std::hash<std::string_view>{}(symbol_name));
+    return slot ? slot->layer->position : layers_.size();
+}
+
+const symbol_overlay_index::slot_* symbol_overlay_index::find_slot_(std::string_view symbol_name,
+                                                                    std::size_t hash) const noexcept
+{
+    if (slots_.empty())
+        return nullptr;
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t index = hash & mask;; index = (index + 1) & mask)
+    {
+        const slot_& slot = slots_[index];
+        if (!slot.layer)
+            return nullptr;
+        if (slot.hash == hash && slot.name == symbol_name)
+            return &slot;
+    }
+}
+
+void symbol_overlay_index::insert_(std::string_view symbol_name, void* address, const layer_* layer)
+{
+    // The load factor is kept under 1/2, so that the probe sequences stay short.
+    if ((symbol_count_ + 1) * 2 > slots_.size())
+        grow_();
+    const std::size_t hash = std::hash<std::string_view>{}(symbol_name);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t index = hash & mask;; index = (index + 1) & mask)
+    {
+        slot_& slot = slots_[index];
+        if (!slot.layer)
+        {
+            slot = slot_{ .name = std::string(symbol_name), .hash = hash, .address = address, .layer = layer };
+            ++symbol_count_;
+            return;
+        }
+        if (slot.hash == hash && slot.name == symbol_name)
+        {
+            slot.address = address;
+            slot.layer = layer;
+            return;
+        }
+    }
+}
+
+void symbol_overlay_index::remove_(const slot_& slot) noexcept
+{
+    // Backward shift deletion: the next slots of the probe sequence are moved into the hole, so that no lookup stops
+    // at it too early.
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t hole = static_cast<std::size_t>(&slot - slots_.data());
+    for (std::size_t index = (hole + 1) & mask; slots_[index].layer; index = (index + 1) & mask)
+    {
+        const std::size_t home = slots_[index].hash & mask;
+        if (((index - home) & mask) >= ((index - hole) & mask))
+        {
+            slots_[hole] = std::move(slots_[index]);
+            hole = index;
+        }
+    }
+    slots_[hole] = slot_{};
+    --symbol_count_;
+}
+
+void symbol_overlay_index::grow_()
+{
+    const std::size_t slot_count = std::max<std::size_t>(16, slots_.size() * 2);
+    std::vector<slot_> old_slots = std::exchange(slots_, std::vector<slot_>(slot_count));
+    const std::size_t mask = slots_.size() - 1;
+    for (slot_& old_slot : old_slots)
+    {
+        if (!old_slot.layer)
+            continue;
+        std::size_t index = old_slot.hash & mask;
+        while (slots_[index].layer)
+            index = (index + 1) & mask;
+        slots_[index] = std::move(old_slot);
+    }
+}
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
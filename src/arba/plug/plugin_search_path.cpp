@@ -0,0 +1,195 @@
+#include <arba/plug/exception.hpp>
+#include <arba/plug/plugin_base.hpp>
+#include <arba/plug/plugin_search_path.hpp>
+
+#include <array>
+#include <format>
+#include <system_error>
+#include <utility>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace
+{
+constexpr char directory_list_separator =
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    ';';
+#else
+    ':';
+#endif
+
+std::vector<std::filesystem::path> split_directory_list(std::string_view directory_list)
+{
+    std::vector<std::filesystem::path> directories;
+    while (!directory_list.empty())
+    {
+        const std::size_t separator_pos = directory_list.find(directory_list_separator);
+        const std::string_view directory = directory_list.substr(0, separator_pos);
+        if (!directory.empty())
+            directories.emplace_back(directory);
+        if (separator_pos == std::string_view::npos)
+            break;
+        directory_list.remove_prefix(separator_pos + 1);
+    }
+    return directories;
+}
+
+[[noreturn]] void throw_not_found_error(const std::string& message)
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    throw plugin_load_error(std::make_error_code(std::errc::no_such_file_or_directory), message);
+#else
+    throw plugin_load_error(message);
+#endif
+}
+} // namespace
+
+plugin_search_path::plugin_search_path(std::vector<std::filesystem::path> directories)
+    : directories_(std::move(directories))
+{
+    build_index_();
+}
+
+plugin_search_path::plugin_search_path(std::string_view directory_list)
+    : plugin_search_path(split_directory_list(directory_list))
+{
+}
+
+plugin_search_path::plugin_search_path(plugin_search_path&& other) noexcept
+    : directories_(std::move(other.directories_)), plugins_(std::move(other.plugins_)),
+      plugin_count_(other.plugin_count_), index_build_count_(other.index_build_count_),
+      watch_descriptor_(std::exchange(other.watch_descriptor_, -1))
+{
+}
+
+plugin_search_path& plugin_search_path::operator=(plugin_search_path&& other) noexcept
+{
+    if (&other != this)
+    {
+        close_watch_();
+        directories_ = std::move(other.directories_);
+        plugins_ = std::move(other.plugins_);
+        plugin_count_ = other.plugin_count_;
+        index_build_count_ = other.index_build_count_;
+        watch_descriptor_ = std::exchange(other.watch_descriptor_, -1);
+    }
+    return *this;
+}
+
+plugin_search_path::~plugin_search_path()
+{
+    close_watch_();
+}
+
+std::optional<std::filesystem::path> plugin_search_path::find(std::string_view plugin_name)
+{
+    if (plugin_name.find_first_of("/\\") != std::string_view::npos)
+        return std::filesystem::path(plugin_name);
+    std::scoped_lock lock(mutex_);
+    if (has_changes_()) [[unlikely]]
+        build_index_();
+    if (const auto iter = plugins_.find(plugin_name); iter != plugins_.end())
+        return iter->second;
+    return std::nullopt;
+}
+
+std::filesystem::path plugin_search_path::resolve(std::string_view plugin_name)
+{
+    std::optional<std::filesystem::path> plugin_path = find(plugin_name);
+    if (!plugin_path) [[unlikely]]
+        throw_not_found_error(std::format("The plugin {} is not found in the search path.", plugin_name));
+    return std::move(*plugin_path);
+}
+
+void plugin_search_path::refresh()
+{
+    std::scoped_lock lock(mutex_);
+    build_index_();
+}
+
+std::size_t plugin_search_path::plugin_count() const
+{
+    std::scoped_lock lock(mutex_);
+    return plugin_count_;
+}
+
+std::uint64_t plugin_search_path::index_build_count() const
+{
+    std::scoped_lock lock(mutex_);
+    return index_build_count_;
+}
+
+void plugin_search_path::build_index_()
+{
+    // The directories are watched before they are read, so that no change made during the read is missed.
+    watch_directories_();
+    plugins_.clear();
+    plugin_count_ = 0;
+    for (const std::filesystem::path& directory : directories_)
+    {
+        std::error_code error_code;
+        for (std::filesystem::directory_iterator iter(directory, error_code), end; !error_code && iter != end;
+             iter.increment(error_code))
+        {
+            const std::filesystem::path& file_path = iter->path();
+            if (file_path.extension() != plugin_file_extension || !iter->is_regular_file(error_code))
+                continue;
+            // The first directory containing a plugin wins.
+            if (plugins_.try_emplace(file_path.filename().string(), file_path).second)
+            {
+                plugins_.try_emplace(file_path.stem().string(), file_path);
+                ++plugin_count_;
+            }
+        }
+    }
+    ++index_build_count_;
+}
+
+void plugin_search_path::watch_directories_()
+{
+#if defined(__linux__)
+    close_watch_();
+    watch_descriptor_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_descriptor_ < 0)
+        return;
+    constexpr std::uint32_t watched_events =
+        IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+    for (const std::filesystem::path& directory : directories_)
+        inotify_add_watch(watch_descriptor_, directory.c_str(), watched_events | IN_ONLYDIR);
+#endif
+}
+
+void plugin_search_path::close_watch_() noexcept
+{
+#if defined(__linux__)
+    if (watch_descriptor_ >= 0)
+        close(watch_descriptor_);
+#endif
+    watch_descriptor_ = -1;
+}
+
+bool plugin_search_path::has_changes_() noexcept
+{
+#if defined(__linux__)
+    if (watch_descriptor_ < 0)
+        return false;
+    // Drain the pending events: one is enough to rebuild the index.
+    alignas(inotify_event) std::array<char, 4096> events;
+    bool changed = false;
+    while (read(watch_descriptor_, events.data(), events.size()) > 0)
+        changed = true;
+    return changed;
+#else
+    return false;
+#endif
+}
+
+} // namespace plug
+} // namespace arba
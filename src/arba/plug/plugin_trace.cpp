@@ -0,0 +1,406 @@
+#include <arba/plug/plugin_trace.hpp>
+
+#include <array>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+
+namespace private_
+{
+std::atomic_bool tracing_enabled = false;
+} // namespace private_
+
+namespace
+{
+// The origin of the timestamps of the events.
+const std::chrono::steady_clock::time_point trace_epoch = std::chrono::steady_clock::now();
+
+struct trace_record
+{
+    std::string_view category;
+    std::string_view name;
+    std::string_view argument;
+    std::chrono::nanoseconds start;
+    std::chrono::nanoseconds duration;
+};
+
+// The events of one thread, written by the thread only and read by the snapshots.
+// The events are stored in a list of chunks which never moves them, and published by the event count: a reader
+// reads the count (acquire), then the events before it, which the writer wrote before storing the count (release).
+class thread_trace_buffer
+{
+public:
+    static constexpr std::size_t chunk_size = 1024;
+
+    explicit thread_trace_buffer(std::uint32_t thread_index) : thread_index_(thread_index) {}
+
+    ~thread_trace_buffer() { release_chunks_(head_.next); }
+
+    thread_trace_buffer(const thread_trace_buffer&) = delete;
+    thread_trace_buffer& operator=(const thread_trace_buffer&) = delete;
+
+    void push(const trace_record& record) noexcept
+    {
+        const std::size_t event_count = event_count_.load(std::memory_order_relaxed);
+        const std::size_t record_index = event_count % chunk_size;
+        if (record_index == 0 && event_count != 0)
+        {
+            chunk_* chunk = new (std::nothrow) chunk_;
+            if (!chunk) [[unlikely]]
+                return;
+            tail_->next = chunk;
+            tail_ = chunk;
+        }
+        tail_->records[record_index] = record;
+        event_count_.store(event_count + 1, std::memory_order_release);
+    }
+
+    void append_to(std::vector<trace_event>& events) const
+    {
+        const std::size_t event_count = event_count_.load(std::memory_order_acquire);
+        const chunk_* chunk = &head_;
+        for (std::size_t i = 0; i < event_count; ++i)
+        {
+            if (i != 0 && i % chunk_size == 0)
+                chunk = chunk->next;
+            const trace_record& record = chunk->records[i % chunk_size];
+            events.push_back(trace_event{ .category = record.category,
+                                          .name = record.name,
+                                          .argument = record.argument,
+                                          .start = record.start,
+                                          .duration = record.duration,
+                                          .thread_index = thread_index_ });
+        }
+    }
+
+    void clear() noexcept
+    {
+        release_chunks_(head_.next);
+        head_.next = nullptr;
+        tail_ = &head_;
+        event_count_.store(0, std::memory_order_release);
+    }
+
+    [[nodiscard]] std::uint32_t thread_index() const noexcept { return thread_index_; }
+
+    // Set when the thread exits: the buffer is not written anymore.
+    std::atomic_bool finished = false;
+
+private:
+    struct chunk_
+    {
+        std::array<trace_record, chunk_size> records;
+        chunk_* next = nullptr;
+    };
+
+    static void release_chunks_(chunk_* chunk) noexcept
+    {
+        while (chunk)
+            delete std::exchange(chunk, chunk->next);
+    }
+
+    chunk_ head_;
+    chunk_* tail_ = &head_;
+    std::atomic<std::size_t> event_count_ = 0;
+    std::uint32_t thread_index_;
+};
+
+class trace_registry
+{
+public:
+    static trace_registry& instance()
+    {
+        static trace_registry registry;
+        return registry;
+    }
+
+    thread_trace_buffer* make_buffer()
+    {
+        std::lock_guard lock(mutex_);
+        return buffers_.emplace_back(std::make_unique<thread_trace_buffer>(next_thread_index_++)).get();
+    }
+
+    std::string_view intern(std::string_view text)
+    {
+        std::lock_guard lock(mutex_);
+        auto iter = strings_.find(text);
+        if (iter == strings_.end())
+            iter = strings_.emplace(text).first;
+        return *iter;
+    }
+
+    std::vector<trace_event> snapshot()
+    {
+        std::vector<trace_event> events;
+        std::lock_guard lock(mutex_);
+        for (const std::unique_ptr<thread_trace_buffer>& buffer : buffers_)
+            buffer->append_to(events);
+        return events;
+    }
+
+    void clear()
+    {
+        std::lock_guard lock(mutex_);
+        std::erase_if(buffers_, [](const std::unique_ptr<thread_trace_buffer>& buffer) {
+            return buffer->finished.load(std::memory_order_acquire);
+        });
+        for (std::unique_ptr<thread_trace_buffer>& buffer : buffers_)
+            buffer->clear();
+    }
+
+private:
+    trace_registry()
+    {
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+        // A forked child must not inherit the mutex locked by another thread.
+        pthread_atfork([] { instance().mutex_.lock(); }, [] { instance().mutex_.unlock(); },
+                       [] { instance().mutex_.unlock(); });
+#endif
+    }
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<thread_trace_buffer>> buffers_;
+    std::uint32_t next_thread_index_ = 0;
+    // The strings live until the end of the program: the events only hold views on them.
+    std::set<std::string, std::less<>> strings_;
+};
+
+// The buffer of the calling thread, created at its first event.
+class local_trace_buffer
+{
+public:
+    ~local_trace_buffer()
+    {
+        if (buffer_)
+            buffer_->finished.store(true, std::memory_order_release);
+    }
+
+    thread_trace_buffer* get() noexcept
+    {
+        if (!buffer_) [[unlikely]]
+        {
+            try
+            {
+                buffer_ = trace_registry::instance().make_buffer();
+            }
+            catch (...)
+            {
+                return nullptr;
+            }
+        }
+        return buffer_;
+    }
+
+private:
+    thread_trace_buffer* buffer_ = nullptr;
+};
+
+thread_local local_trace_buffer local_buffer;
+
+// The interned strings already used by the calling thread, found without lock: the set of the registry is only locked
+// the first time a thread uses a string. The keys are the texts given to the trace scopes (the native format of the
+// paths), the values the interned strings.
+class local_trace_strings
+{
+public:
+    template <class MakeTextFunction>
+    std::string_view intern(std::string_view key, const MakeTextFunction& make_text)
+    {
+        if (const auto iter = strings_.find(key); iter != strings_.end()) [[likely]]
+            return iter->second;
+        const std::string_view interned = trace_registry::instance().intern(make_text());
+        strings_.emplace(key, interned);
+        return interned;
+    }
+
+private:
+    struct string_hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view text) const noexcept { return std::hash<std::string_view>{}(text); }
+    };
+
+    std::unordered_map<std::string, std::string_view, string_hash, std::equal_to<>> strings_;
+};
+
+thread_local local_trace_strings local_strings;
+
+void write_json_string(std::ostream& stream, std::string_view text)
+{
+    stream.put('"');
+    for (const char character : text)
+    {
+        switch (character)
+        {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        case '\t':
+            stream << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(character) < 0x20)
+                stream << std::format("\\u{:04x}", static_cast<unsigned>(character));
+            else
+                stream.put(character);
+        }
+    }
+    stream.put('"');
+}
+
+// The Chrome trace format counts in microseconds: the nanoseconds are kept as decimals.
+std::string to_microseconds(std::chrono::nanoseconds duration)
+{
+    const std::int64_t count = duration.count() > 0 ? duration.count() : 0;
+    return std::format("{}.{:03}", count / 1000, count % 1000);
+}
+
+int process_id()
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+} // namespace
+
+namespace private_
+{
+std::string_view intern_trace_string(std::string_view text)
+{
+    return local_strings.intern(text, [text] { return text; });
+}
+
+void record_trace_event(std::string_view category, std::string_view name, std::string_view argument,
+                        std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) noexcept
+{
+    if (thread_trace_buffer* buffer = local_buffer.get())
+        buffer->push(trace_record{ .category = category,
+                                   .name = name,
+                                   .argument = argument,
+                                   .start = start - trace_epoch,
+                                   .duration = end - start });
+}
+} // namespace private_
+
+std::string_view trace_scope::intern_argument_(std::string_view argument) noexcept
+{
+    try
+    {
+        return private_::intern_trace_string(argument);
+    }
+    catch (...)
+    {
+        return {};
+    }
+}
+
+std::string_view trace_scope::intern_argument_(const std::filesystem::path& path) noexcept
+{
+    try
+    {
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+        return private_::intern_trace_string(path.generic_string());
+#else
+        return local_strings.intern(path.native(), [&path] { return path.generic_string(); });
+#endif
+    }
+    catch (...)
+    {
+        return {};
+    }
+}
+
+void start_tracing() noexcept
+{
+    private_::tracing_enabled.store(true, std::memory_order_relaxed);
+}
+
+void stop_tracing() noexcept
+{
+    private_::tracing_enabled.store(false, std::memory_order_relaxed);
+}
+
+std::vector<trace_event> snapshot_trace()
+{
+    return trace_registry::instance().snapshot();
+}
+
+void clear_trace()
+{
+    trace_registry::instance().clear();
+}
+
+void write_chrome_trace(std::ostream& stream)
+{
+    const std::vector<trace_event> events = snapshot_trace();
+    const int pid = process_id();
+    stream << "{\"traceEvents\":[";
+    bool first_event = true;
+    std::uint32_t named_thread_count = 0;
+    for (const trace_event& event : events)
+    {
+        if (!first_event)
+            stream << ",";
+        first_event = false;
+        // The events are grouped by thread, in the order of the thread indexes: each thread is named once.
+        if (event.thread_index >= named_thread_count)
+        {
+            named_thread_count = event.thread_index + 1;
+            stream << std::format("\n{{\"ph\":\"M\",\"pid\":{},\"tid\":{},\"name\":\"thread_name\","
+                                  "\"args\":{{\"name\":\"thread {}\"}}}},",
+                                  pid, event.thread_index, event.thread_index);
+        }
+        stream << std::format("\n{{\"ph\":\"X\",\"pid\":{},\"tid\":{},\"ts\":{},\"dur\":{},\"cat\":", pid,
+                              event.thread_index, to_microseconds(event.start), to_microseconds(event.duration));
+        write_json_string(stream, event.category);
+        stream << ",\"name\":";
+        write_json_string(stream, event.name);
+        if (!event.argument.empty())
+        {
+            stream << ",\"args\":{\"detail\":";
+            write_json_string(stream, event.argument);
+            stream << "}";
+        }
+        stream << "}";
+    }
+    stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void write_chrome_trace(const std::filesystem::path& trace_path)
+{
+    std::ofstream stream(trace_path, std::ios::binary);
+    if (stream)
+        write_chrome_trace(static_cast<std::ostream&>(stream));
+    if (!stream)
+        throw std::runtime_error(std::format("Cannot write the trace file '{}'.", trace_path.string()));
+}
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,88 @@
+#include <arba/plug/exception.hpp>
+#include <arba/plug/plugin_zygote.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <iostream>
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+
+namespace
+{
+void flush_streams()
+{
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+}
+} // namespace
+
+int fork_process(const std::function<int()>& function)
+{
+    // The buffered outputs would be written by both processes.
+    flush_streams();
+    const int process_id = fork();
+    if (process_id < 0) [[unlikely]]
+        throw plugin_process_error(std::format("Cannot fork the process: {}", std::strerror(errno)));
+    if (process_id > 0)
+        return process_id;
+
+    int exit_code = 1;
+    try
+    {
+        exit_code = function();
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+    }
+    catch (...)
+    {
+        // The exception must not unwind into the stack of the caller, copied from the parent.
+        std::cerr << "The forked process threw an exception which is not a std::exception." << std::endl;
+    }
+    flush_streams();
+    _exit(exit_code);
+}
+
+int wait_process(int process_id)
+{
+    int status = 0;
+    int result = 0;
+    while ((result = waitpid(process_id, &status, 0)) < 0 && errno == EINTR)
+        ;
+    if (result < 0) [[unlikely]]
+        throw plugin_process_error(std::format("Cannot wait for the process {}: {}", process_id, std::strerror(errno)));
+    return WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+}
+
+#else
+
+int fork_process(const std::function<int()>&)
+{
+    throw plugin_process_error("Forking a process is not supported on this platform.");
+}
+
+int wait_process(int)
+{
+    throw plugin_process_error("Forking a process is not supported on this platform.");
+}
+
+#endif
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,423 @@
+#include <arba/plug/exception.hpp>
+#include <arba/plug/process_channel.hpp>
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <new>
+#include <string>
+#include <thread>
+#if defined(__linux__)
+#include <csignal>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+#if defined(__linux__)
+
+namespace
+{
+enum slot_state : std::uint32_t
+{
+    free_slot,
+    submitted,
+    done,
+    failed,
+    symbol_not_found,
+};
+
+enum server_state : std::uint32_t
+{
+    starting,
+    ready,
+    start_failed,
+};
+
+constexpr int spin_count = 64;
+constexpr std::chrono::milliseconds crash_check_period(10);
+
+// The futexes are shared between processes: the FUTEX_PRIVATE_FLAG variants cannot be used.
+void futex_wait(std::atomic_uint32_t& word, std::uint32_t expected_value, const timespec* timeout = nullptr) noexcept
+{
+    static_assert(sizeof(std::atomic_uint32_t) == sizeof(std::uint32_t));
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected_value, timeout, nullptr, 0);
+}
+
+void futex_wake(std::atomic_uint32_t& word) noexcept
+{
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+void copy_message(std::span<std::byte> buffer, std::string_view message) noexcept
+{
+    const std::size_t size = std::min(message.size(), buffer.size() - 1);
+    std::memcpy(buffer.data(), message.data(), size);
+    buffer[size] = std::byte(0);
+}
+
+std::string_view read_message(std::span<const std::byte> buffer) noexcept
+{
+    const char* message = reinterpret_cast<const char*>(buffer.data());
+    return std::string_view(message, ::strnlen(message, buffer.size()));
+}
+} // namespace
+
+struct process_channel::shared_region
+{
+    struct alignas(64) ring_cell
+    {
+        std::atomic_uint64_t sequence;
+        std::uint32_t slot_index;
+    };
+
+    struct alignas(64) call_slot
+    {
+        std::atomic_uint32_t state = free_slot;
+        std::atomic_uint32_t host_waiting = 0;
+        remote_invoker_type invoker = nullptr;
+        void* function = nullptr;
+        std::array<std::byte, buffer_size> buffer;
+    };
+
+    shared_region()
+    {
+        for (std::uint64_t i = 0; i < slot_count; ++i)
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Push an index to the ring (Vyukov bounded queue). The ring never fills up: it has one cell per call slot.
+    void push(std::uint32_t slot_index) noexcept
+    {
+        std::uint64_t position = enqueue_position.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            ring_cell& cell = ring[position % slot_count];
+            const std::uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position)
+            {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.slot_index = slot_index;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (sequence < position)
+                std::this_thread::yield();
+            else
+                position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Pop an index from the ring, only called by the server.
+    bool try_pop(std::uint32_t& slot_index) noexcept
+    {
+        ring_cell& cell = ring[dequeue_position % slot_count];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeue_position + 1)
+            return false;
+        slot_index = cell.slot_index;
+        cell.sequence.store(dequeue_position + slot_count, std::memory_order_release);
+        ++dequeue_position;
+        return true;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return ring[dequeue_position % slot_count].sequence.load(std::memory_order_acquire) != dequeue_position + 1;
+    }
+
+    alignas(64) std::atomic_uint32_t state = starting;
+    std::array<std::byte, buffer_size> start_error;
+    alignas(64) std::atomic_uint64_t enqueue_position = 0;
+    alignas(64) std::uint64_t dequeue_position = 0;
+    alignas(64) std::atomic_uint32_t submit_count = 0;
+    std::atomic_uint32_t server_waiting = 0;
+    std::atomic_uint32_t stopping = 0;
+    std::array<ring_cell, slot_count> ring;
+    std::array<call_slot, slot_count> slots;
+};
+
+process_channel::process_channel(const std::function<void*()>& start_server)
+{
+    void* memory = mmap(nullptr, sizeof(shared_region), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) [[unlikely]]
+        throw plugin_load_error(std::format("Cannot map the memory shared with the plugin process: {}",
+                                            std::strerror(errno)));
+    region_ = new (memory) shared_region();
+
+    process_id_ = fork();
+    if (process_id_ < 0) [[unlikely]]
+    {
+        const int error = errno;
+        munmap(region_, sizeof(shared_region));
+        throw plugin_load_error(std::format("Cannot fork the plugin process: {}", std::strerror(error)));
+    }
+    if (process_id_ == 0)
+        run_server_(start_server);
+
+    // Wait for the server to be ready.
+    const timespec timeout{ .tv_sec = 0, .tv_nsec = std::chrono::nanoseconds(crash_check_period).count() };
+    std::uint32_t state;
+    while ((state = region_->state.load(std::memory_order_acquire)) == starting)
+    {
+        if (!is_running()) [[unlikely]]
+            break;
+        futex_wait(region_->state, starting, &timeout);
+    }
+    if (state != ready) [[unlikely]]
+    {
+        const std::string message = state == start_failed ? std::string(read_message(region_->start_error))
+                                                          : std::string("the plugin process ended");
+        stop_();
+        throw plugin_load_error(std::format("Exception occurred while loading plugin in a process: {}", message));
+    }
+}
+
+process_channel::~process_channel()
+{
+    stop_();
+}
+
+void process_channel::stop_() noexcept
+{
+    if (!region_)
+        return;
+    region_->stopping.store(1, std::memory_order_seq_cst);
+    region_->submit_count.fetch_add(1, std::memory_order_seq_cst);
+    futex_wake(region_->submit_count);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (is_running() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (is_running())
+    {
+        kill(process_id_, SIGKILL);
+        waitpid(process_id_, nullptr, 0);
+    }
+    munmap(region_, sizeof(shared_region));
+    region_ = nullptr;
+}
+
+void process_channel::run_server_(const std::function<void*()>& start_server)
+{
+    // The plugin process must not survive the host.
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    shared_region& region = *region_;
+    // No exception must unwind into the stack of the host, copied from the parent: the process ends with _exit().
+    const auto fail_start = [&region](std::string_view message) {
+        copy_message(region.start_error, message);
+        region.state.store(start_failed, std::memory_order_release);
+        futex_wake(region.state);
+        _exit(EXIT_FAILURE);
+    };
+    void* context = nullptr;
+    try
+    {
+        context = start_server();
+    }
+    catch (const std::exception& exception)
+    {
+        fail_start(exception.what());
+    }
+    catch (...)
+    {
+        fail_start("The plugin process threw an exception which is not a std::exception.");
+    }
+    region.state.store(ready, std::memory_order_release);
+    futex_wake(region.state);
+
+    try
+    {
+        serve_calls_(context);
+    }
+    catch (...)
+    {
+        _exit(EXIT_FAILURE);
+    }
+    _exit(EXIT_SUCCESS);
+}
+
+void process_channel::serve_calls_(void* context)
+{
+    shared_region& region = *region_;
+    for (;;)
+    {
+        std::uint32_t slot_index;
+        int spin = 0;
+        while (!region.try_pop(slot_index))
+        {
+            if (region.stopping.load(std::memory_order_acquire))
+                return;
+            if (++spin < spin_count)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            // Sleep until a submission. The count is read after announcing the wait, so that a submitter either
+            // sees the server waiting or changes the count before the futex wait.
+            region.server_waiting.store(1, std::memory_order_seq_cst);
+            const std::uint32_t submit_count = region.submit_count.load(std::memory_order_seq_cst);
+            if (region.empty() && !region.stopping.load(std::memory_order_seq_cst))
+                futex_wait(region.submit_count, submit_count);
+            region.server_waiting.store(0, std::memory_order_relaxed);
+            spin = 0;
+        }
+
+        shared_region::call_slot& slot = region.slots[slot_index];
+        std::uint32_t state = done;
+        try
+        {
+            slot.invoker(context, slot.function, slot.buffer.data());
+        }
+        catch (const plugin_find_symbol_error& exception)
+        {
+            copy_message(slot.buffer, exception.what());
+            state = symbol_not_found;
+        }
+        catch (const std::exception& exception)
+        {
+            copy_message(slot.buffer, exception.what());
+            state = failed;
+        }
+        catch (...)
+        {
+            copy_message(slot.buffer, "Unknown exception.");
+            state = failed;
+        }
+        slot.state.store(state, std::memory_order_seq_cst);
+        if (slot.host_waiting.load(std::memory_order_seq_cst))
+            futex_wake(slot.state);
+    }
+}
+
+std::uint32_t process_channel::submit(remote_invoker_type invoker, void* function,
+                                      std::span<const std::byte> arguments)
+{
+    if (ended_.load(std::memory_order_relaxed)) [[unlikely]]
+        throw_if_ended_("submitting a call");
+    free_slot_count_.acquire();
+    std::uint64_t used_slots = used_slots_.load(std::memory_order_relaxed);
+    std::uint32_t slot_index;
+    do
+        slot_index = std::countr_one(used_slots);
+    while (!used_slots_.compare_exchange_weak(used_slots, used_slots | (std::uint64_t(1) << slot_index),
+                                              std::memory_order_acquire, std::memory_order_relaxed));
+
+    shared_region::call_slot& slot = region_->slots[slot_index];
+    slot.invoker = invoker;
+    slot.function = function;
+    std::memcpy(slot.buffer.data(), arguments.data(), arguments.size());
+    slot.state.store(submitted, std::memory_order_relaxed);
+    region_->push(slot_index);
+    region_->submit_count.fetch_add(1, std::memory_order_seq_cst);
+    if (region_->server_waiting.load(std::memory_order_seq_cst))
+        futex_wake(region_->submit_count);
+    return slot_index;
+}
+
+void process_channel::wait(std::uint32_t slot_index, std::span<std::byte> result)
+{
+    shared_region::call_slot& slot = region_->slots[slot_index];
+    std::uint32_t state = slot.state.load(std::memory_order_acquire);
+    for (int spin = 0; state == submitted && spin < spin_count; ++spin)
+    {
+        std::this_thread::yield();
+        state = slot.state.load(std::memory_order_acquire);
+    }
+    if (state == submitted)
+    {
+        const timespec timeout{ .tv_sec = 0, .tv_nsec = std::chrono::nanoseconds(crash_check_period).count() };
+        slot.host_waiting.store(1, std::memory_order_seq_cst);
+        while ((state = slot.state.load(std::memory_order_seq_cst)) == submitted)
+        {
+            futex_wait(slot.state, submitted, &timeout);
+            if (slot.state.load(std::memory_order_acquire) == submitted && !is_running()) [[unlikely]]
+                throw_if_ended_("calling a function");
+        }
+        slot.host_waiting.store(0, std::memory_order_relaxed);
+    }
+
+    std::string message;
+    if (state == done)
+        std::memcpy(result.data(), slot.buffer.data(), result.size());
+    else
+        message = read_message(slot.buffer);
+    slot.state.store(free_slot, std::memory_order_relaxed);
+    used_slots_.fetch_and(~(std::uint64_t(1) << slot_index), std::memory_order_release);
+    free_slot_count_.release();
+
+    if (state == symbol_not_found) [[unlikely]]
+        throw plugin_find_symbol_error(message);
+    if (state == failed) [[unlikely]]
+        throw std::runtime_error(std::format("Exception occurred in the plugin process: {}", message));
+}
+
+bool process_channel::is_running()
+{
+    if (ended_.load(std::memory_order_acquire))
+        return false;
+    std::lock_guard lock(exit_mutex_);
+    if (!ended_.load(std::memory_order_relaxed) && waitpid(process_id_, &exit_status_, WNOHANG) == process_id_)
+        ended_.store(true, std::memory_order_release);
+    return !ended_.load(std::memory_order_relaxed);
+}
+
+void process_channel::throw_if_ended_(std::string_view action)
+{
+    if (is_running())
+        return;
+    std::string reason = WIFSIGNALED(exit_status_) ? std::format("killed by signal {}", WTERMSIG(exit_status_))
+                                                   : std::format("exit code {}", WEXITSTATUS(exit_status_));
+    throw plugin_process_error(std::format("The plugin process {} ended ({}) before {}.", process_id_, reason, action));
+}
+
+#else
+
+process_channel::process_channel(const std::function<void*()>&)
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    throw plugin_load_error(std::make_error_code(std::errc::not_supported),
+                            "Out-of-process plugins are only supported on Linux.");
+#else
+    throw plugin_load_error("Out-of-process plugins are only supported on Linux.");
+#endif
+}
+
+process_channel::~process_channel() = default;
+
+void process_channel::stop_() noexcept
+{
+}
+
+std::uint32_t process_channel::submit(remote_invoker_type, void*, std::span<const std::byte>)
+{
+    throw plugin_process_error("Out-of-process plugins are only supported on Linux.");
+}
+
+void process_channel::wait(std::uint32_t, std::span<std::byte>)
+{
+    throw plugin_process_error("Out-of-process plugins are only supported on Linux.");
+}
+
+bool process_channel::is_running()
+{
+    return false;
+}
+
+#endif
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
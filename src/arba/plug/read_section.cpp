@@ -0,0 +1,84 @@
+#include <arba/plug/read_section.hpp>
+
+#include <array>
+#include <mutex>
+#include <thread>
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+#include <pthread.h>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+namespace
+{
+constexpr std::size_t shard_count = 16;
+
+// The sections are counted by parity of the epoch they were entered in: synchronize() moves the readers to the other
+// counter by incrementing the epoch, then waits for the old counter to drain.
+struct alignas(64) reader_shard
+{
+    std::array<std::atomic<std::uint64_t>, 2> reader_counts{};
+};
+
+constinit std::array<reader_shard, shard_count> reader_shards{};
+constinit std::atomic<std::uint64_t> epoch = 0;
+constinit std::mutex synchronize_mutex;
+
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+// Only the forking thread lives in a forked child: the sections of the other threads will never end, so the counts
+// are reset. The mutex is held by the forking thread during the fork, so that no synchronize() is half done.
+[[maybe_unused]] const bool fork_handlers_registered = [] {
+    pthread_atfork([] { synchronize_mutex.lock(); }, [] { synchronize_mutex.unlock(); },
+                   [] {
+                       for (reader_shard& shard : reader_shards)
+                           for (std::atomic<std::uint64_t>& reader_count : shard.reader_counts)
+                               reader_count.store(0, std::memory_order_relaxed);
+                       synchronize_mutex.unlock();
+                   });
+    return true;
+}();
+#endif
+
+std::size_t local_shard_index() noexcept
+{
+    static std::atomic<std::size_t> thread_counter = 0;
+    thread_local const std::size_t shard_index = thread_counter.fetch_add(1, std::memory_order_relaxed) % shard_count;
+    return shard_index;
+}
+} // namespace
+
+read_section::read_section() noexcept
+    : reader_count_(&reader_shards[local_shard_index()].reader_counts[epoch.load() & 1])
+{
+    // Sequentially consistent, like the load of the plugin state which follows: either synchronize() sees this
+    // reader, or the reader sees the plugin unpublished.
+    reader_count_->fetch_add(1);
+}
+
+read_section::~read_section()
+{
+    reader_count_->fetch_sub(1, std::memory_order_release);
+}
+
+void read_section::synchronize()
+{
+    std::lock_guard lock(synchronize_mutex);
+    // A reader may have read the epoch before the previous increment, then counted itself in the other parity: the
+    // second round waits for it.
+    for (int round = 0; round < 2; ++round)
+    {
+        const std::size_t parity = epoch.fetch_add(1) & 1;
+        for (reader_shard& shard : reader_shards)
+            while (shard.reader_counts[parity].load() != 0)
+                std::this_thread::yield();
+    }
+}
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,61 @@
+#include <arba/plug/service_registry.hpp>
+
+#include <algorithm>
+
+inline namespace arba
+{
+namespace plug
+{
+
+std::size_t service_registry::add(const plugin_base& plugin)
+{
+    if (std::ranges::find(plugins_, &plugin) != plugins_.end()) [[unlikely]]
+        throw std::invalid_argument(
+            std::format("The plugin {} is already registered.", plugin.plugin_path().generic_string()));
+    void* service_register = plugin.try_find_symbol_pointer(std::string(private_::service_register_fname));
+    plugins_.push_back(&plugin);
+    if (!service_register)
+        return 0;
+    const std::span<const service_entry> entries =
+        reinterpret_cast<private_::service_register_type>(service_register)();
+    for (const service_entry& entry : entries)
+        providers_[entry.interface_id].push_back(service_provider{ .plugin = &plugin,
+                                                                   .interface_name = entry.interface_name,
+                                                                   .make_shared_void_instance =
+                                                                       entry.make_shared_instance });
+    return entries.size();
+}
+
+bool service_registry::remove(const plugin_base& plugin)
+{
+    const auto iter = std::ranges::find(plugins_, &plugin);
+    if (iter == plugins_.end())
+        return false;
+    plugins_.erase(iter);
+    for (auto providers_iter = providers_.begin(); providers_iter != providers_.end();)
+    {
+        std::erase_if(providers_iter->second,
+                      [&plugin](const service_provider& provider) { return provider.plugin == &plugin; });
+        if (providers_iter->second.empty())
+            providers_iter = providers_.erase(providers_iter);
+        else
+            ++providers_iter;
+    }
+    return true;
+}
+
+void service_registry::clear() noexcept
+{
+    providers_.clear();
+    plugins_.clear();
+}
+
+std::span<const service_provider> service_registry::providers(std::uint64_t interface_id) const noexcept
+{
+    const auto iter = providers_.find(interface_id);
+    return iter != providers_.end() ? std::span<const service_provider>(iter->second)
+                                    : std::span<const service_provider>();
+}
+
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,162 @@
+#include "symbol_table.hpp"
+
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+#include <dlfcn.h>
+#include <link.h>
+
+#include <cstring>
+#endif
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__) || !defined(DT_GNU_HASH)
+
+std::optional<gnu_hash_table> gnu_hash_table::from_handle(void*)
+{
+    return std::nullopt;
+}
+
+void* gnu_hash_table::find(std::string_view) const noexcept
+{
+    return nullptr;
+}
+
+std::vector<gnu_hash_table::symbol> gnu_hash_table::symbols() const
+{
+    return {};
+}
+
+#else
+
+namespace
+{
+constexpr std::uint32_t gnu_hash(std::string_view name) noexcept
+{
+    std::uint32_t hash = 5381;
+    for (const char character : name)
+        hash = hash * 33 + static_cast<unsigned char>(character);
+    return hash;
+}
+
+bool is_found_symbol(const ElfW(Sym)& symbol) noexcept
+{
+    // ELF32_ST_* and ELF64_ST_* are identical.
+    const unsigned char type = ELF64_ST_TYPE(symbol.st_info);
+    const unsigned char binding = ELF64_ST_BIND(symbol.st_info);
+    return symbol.st_shndx != SHN_UNDEF && type != STT_GNU_IFUNC && type != STT_TLS
+           && (binding == STB_GLOBAL || binding == STB_WEAK || binding == STB_GNU_UNIQUE);
+}
+} // namespace
+
+std::optional<gnu_hash_table> gnu_hash_table::from_handle(void* handle)
+{
+    link_map* plugin_link_map = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &plugin_link_map) != 0 || !plugin_link_map || !plugin_link_map->l_ld)
+        [[unlikely]]
+        return std::nullopt;
+
+    const std::uintptr_t base_address = plugin_link_map->l_addr;
+    // The loader relocates the addresses of the dynamic section, except on platforms where it is read only.
+    const auto to_address = [base_address](ElfW(Addr) address) {
+        return address < base_address ? base_address + address : address;
+    };
+    std::uintptr_t hash_table_address = 0;
+    gnu_hash_table table;
+    table.base_address_ = base_address;
+    for (const ElfW(Dyn)* entry = plugin_link_map->l_ld; entry->d_tag != DT_NULL; ++entry)
+    {
+        switch (entry->d_tag)
+        {
+        case DT_GNU_HASH:
+            hash_table_address = to_address(entry->d_un.d_ptr);
+            break;
+        case DT_STRTAB:
+            table.string_table_ = reinterpret_cast<const char*>(to_address(entry->d_un.d_ptr));
+            break;
+        case DT_SYMTAB:
+            table.symbol_table_ = reinterpret_cast<const void*>(to_address(entry->d_un.d_ptr));
+            break;
+        default:
+            break;
+        }
+    }
+    if (!hash_table_address || !table.string_table_ || !table.symbol_table_) [[unlikely]]
+        return std::nullopt;
+
+    const std::uint32_t* header = reinterpret_cast<const std::uint32_t*>(hash_table_address);
+    table.bucket_count_ = header[0];
+    table.first_symbol_index_ = header[1];
+    table.bloom_size_ = header[2];
+    table.bloom_shift_ = header[3];
+    if (table.bucket_count_ == 0 || table.bloom_size_ == 0) [[unlikely]]
+        return std::nullopt;
+    table.bloom_ = reinterpret_cast<const std::uintptr_t*>(header + 4);
+    table.buckets_ = reinterpret_cast<const std::uint32_t*>(table.bloom_ + table.bloom_size_);
+    table.chains_ = table.buckets_ + table.bucket_count_;
+    return table;
+}
+
+void* gnu_hash_table::find(std::string_view symbol_name) const noexcept
+{
+    constexpr std::uint32_t word_bits = sizeof(std::uintptr_t) * 8;
+    const std::uint32_t hash = gnu_hash(symbol_name);
+
+    const std::uintptr_t bloom_word = bloom_[(hash / word_bits) % bloom_size_];
+    const std::uintptr_t bloom_mask =
+        (std::uintptr_t(1) << (hash % word_bits)) | (std::uintptr_t(1) << ((hash >> bloom_shift_) % word_bits));
+    if ((bloom_word & bloom_mask) != bloom_mask)
+        return nullptr;
+
+    std::uint32_t symbol_index = buckets_[hash % bucket_count_];
+    if (symbol_index < first_symbol_index_)
+        return nullptr;
+
+    const ElfW(Sym)* symbols = static_cast<const ElfW(Sym)*>(symbol_table_);
+    for (;; ++symbol_index)
+    {
+        const std::uint32_t chain_hash = chains_[symbol_index - first_symbol_index_];
+        if ((hash | 1) == (chain_hash | 1))
+        {
+            const ElfW(Sym)& symbol = symbols[symbol_index];
+            const char* name = string_table_ + symbol.st_name;
+            if (std::strncmp(name, symbol_name.data(), symbol_name.size()) == 0 && name[symbol_name.size()] == '\0')
+                return is_found_symbol(symbol) ? reinterpret_cast<void*>(base_address_ + symbol.st_value) : nullptr;
+        }
+        if (chain_hash & 1)
+            return nullptr;
+    }
+}
+
+std::vector<gnu_hash_table::symbol> gnu_hash_table::symbols() const
+{
+    std::vector<symbol> result;
+    const ElfW(Sym)* elf_symbols = static_cast<const ElfW(Sym)*>(symbol_table_);
+    // Each bucket starts a chain of symbols, which ends with an odd hash.
+    for (std::uint32_t bucket = 0; bucket < bucket_count_; ++bucket)
+    {
+        std::uint32_t symbol_index = buckets_[bucket];
+        if (symbol_index < first_symbol_index_)
+            continue;
+        for (;; ++symbol_index)
+        {
+            const ElfW(Sym)& elf_symbol = elf_symbols[symbol_index];
+            if (is_found_symbol(elf_symbol))
+                result.push_back(symbol{ .name = string_table_ + elf_symbol.st_name,
+                                         .address = reinterpret_cast<void*>(base_address_ + elf_symbol.st_value) });
+            if (chains_[symbol_index - first_symbol_index_] & 1)
+                break;
+        }
+    }
+    return result;
+}
+
+#endif
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+inline namespace arba
+{
+namespace plug
+{
+namespace private_
+{
+
+/**
+ * @brief The gnu_hash_table class looks up the symbols defined by a plugin in its GNU hash table (DT_GNU_HASH).
+ * @details The lookup is restricted to the plugin itself (dlsym() also searches its dependencies), and skips
+ * indirect functions (STT_GNU_IFUNC), whose address is given by a resolver: such symbols must be found with dlsym().
+ */
+class gnu_hash_table
+{
+public:
+    struct symbol
+    {
+        // A view on the string table of the plugin, valid while it is loaded.
+        std::string_view name;
+        void* address = nullptr;
+    };
+
+    /**
+     * @brief from_handle Read the tables of a loaded plugin.
+     * @return The hash table, or std::nullopt if the plugin has no GNU hash table or on platforms without it.
+     */
+    static std::optional<gnu_hash_table> from_handle(void* handle);
+
+    /**
+     * @brief find Find the address of a symbol defined by the plugin.
+     * @return The address of the symbol, or nullptr if it is not found.
+     */
+    void* find(std::string_view symbol_name) const noexcept;
+
+    /**
+     * @brief symbols List the symbols defined by the plugin which find() finds.
+     */
+    std::vector<symbol> symbols() const;
+
+private:
+    gnu_hash_table() = default;
+
+    std::uintptr_t base_address_ = 0;
+    const char* string_table_ = nullptr;
+    const void* symbol_table_ = nullptr;
+    std::uint32_t bucket_count_ = 0;
+    std::uint32_t first_symbol_index_ = 0;
+    std::uint32_t bloom_size_ = 0;
+    std::uint32_t bloom_shift_ = 0;
+    const std::uintptr_t* bloom_ = nullptr;
+    const std::uint32_t* buckets_ = nullptr;
+    const std::uint32_t* chains_ = nullptr;
+};
+
+} // namespace private_
+} // namespace plug
+} // namespace arba
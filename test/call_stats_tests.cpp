@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/call_stats.hpp>
+
+#include <arba/plug/plugin.hpp>
+#include <arba/plug/safe_plugin.hpp>
+
+#include <thread>
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+#ifdef ARBA_PLUG_ENABLE_INSTRUMENTATION
+namespace
+{
+const plug::symbol_call_stats_snapshot* find_symbol_stats(const std::vector<plug::plugin_call_stats_snapshot>& stats,
+                                                          const std::filesystem::path& plugin_path,
+                                                          std::string_view symbol_name)
+{
+    for (const plug::plugin_call_stats_snapshot& plugin_stats : stats)
+    {
+        if (plugin_stats.plugin_path != plugin_path)
+            continue;
+        for (const plug::symbol_call_stats_snapshot& symbol_stats : plugin_stats.symbols)
+            if (symbol_stats.symbol_name == symbol_name)
+                return &symbol_stats;
+    }
+    return nullptr;
+}
+} // namespace
+#endif
+
+// BindFunction
+
+TEST(CallStatsTest, BindFunction_FunctionName_ReturnCallableFunction)
+{
+    std::string res;
+    plug::plugin plugin(plugin_fpath);
+    auto execute = plugin.bind_function<void (*)(std::string&, std::string_view, const std::string&)>("execute");
+    ASSERT_TRUE(execute);
+    execute(res, "a", "b");
+    ASSERT_EQ(res, "a-b");
+}
+
+TEST(CallStatsTest, BindFunction_SafePluginBadFunctionType_ExpectException)
+{
+    plug::safe_plugin plugin(plugin_fpath);
+    ASSERT_THROW(std::ignore = plugin.bind_function<void (*)(float&)>("execute"), std::runtime_error);
+}
+
+// SnapshotCallStats
+
+#ifdef ARBA_PLUG_ENABLE_INSTRUMENTATION
+TEST(CallStatsTest, SnapshotCallStats_CallsFromSeveralThreads_ExpectAllCallsCounted)
+{
+    plug::reset_call_stats();
+    plug::plugin plugin(plugin_fpath);
+    auto execute = plugin.bind_function<void (*)(std::string&, std::string_view, const std::string&)>("execute");
+
+    constexpr std::size_t thread_count = 4;
+    constexpr std::size_t call_count = 100;
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back([&] {
+            std::string res;
+            for (std::size_t j = 0; j < call_count; ++j)
+                execute(res, "a", "b");
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    const std::vector<plug::plugin_call_stats_snapshot> stats = plug::snapshot_call_stats();
+    const plug::symbol_call_stats_snapshot* execute_stats = find_symbol_stats(stats, plugin.plugin_path(), "execute");
+    ASSERT_NE(execute_stats, nullptr);
+    ASSERT_EQ(execute_stats->call_count, thread_count * call_count);
+    std::uint64_t histogram_count = 0;
+    for (std::uint64_t bucket_count : execute_stats->latency_histogram)
+        histogram_count += bucket_count;
+    ASSERT_EQ(histogram_count, thread_count * call_count);
+    ASSERT_LE(execute_stats->mean_duration(), execute_stats->latency_percentile(1.0));
+}
+
+TEST(CallStatsTest, ResetCallStats_NominalCase_ExpectZeroCall)
+{
+    plug::plugin plugin(plugin_fpath);
+    auto execute = plugin.bind_function<void (*)(std::string&, std::string_view, const std::string&)>("execute");
+    std::string res;
+    execute(res, "a", "b");
+    plug::reset_call_stats();
+
+    const std::vector<plug::plugin_call_stats_snapshot> stats = plug::snapshot_call_stats();
+    const plug::symbol_call_stats_snapshot* execute_stats = find_symbol_stats(stats, plugin.plugin_path(), "execute");
+    ASSERT_NE(execute_stats, nullptr);
+    ASSERT_EQ(execute_stats->call_count, 0);
+}
+#else
+TEST(CallStatsTest, SnapshotCallStats_InstrumentationDisabled_ReturnEmptyVector)
+{
+    plug::plugin plugin(plugin_fpath);
+    auto execute = plugin.bind_function<void (*)(std::string&, std::string_view, const std::string&)>("execute");
+    static_assert(sizeof(execute) == sizeof(void (*)()));
+    std::string res;
+    execute(res, "a", "b");
+    ASSERT_TRUE(plug::snapshot_call_stats().empty());
+}
+#endif
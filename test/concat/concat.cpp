@@ -1,8 +1,19 @@
 #include "concat.hpp"
 
+#include <concat_interface/concat_function_table.hpp>
+
+#include <arba/plug/host_services.hpp>
+#include <arba/plug/lifecycle.hpp>
 #include <arba/plug/safe_plugin.hpp>
+#include <arba/plug/service_registry.hpp>
+#include <arba/plug/signed_plugin.hpp>
 
+#include <atomic>
+#include <cstdlib>
 #include <format>
+#include <string>
+#include <stdexcept>
+#include <thread>
 #include <iostream>
 
 Concat::Concat() : Concat("", "")
@@ -55,6 +66,18 @@ extern "C" std::shared_ptr<ConcatInterface> make_shared_instance_from_args(std::
     return std::make_shared<Concat>(second_left_decorator, right_decorator);
 }
 
+extern "C" plug::instance_batch<ConcatInterface> make_instances(std::size_t count)
+{
+    return plug::make_contiguous_instance_batch<Concat, ConcatInterface>(count);
+}
+
+extern "C" plug::instance_batch<ConcatInterface> make_instances_from_args(std::size_t count,
+                                                                         std::string_view left_decorator,
+                                                                         std::string_view right_decorator)
+{
+    return plug::make_contiguous_instance_batch<Concat, ConcatInterface>(count, left_decorator, right_decorator);
+}
+
 // The purpose is to test that all ways of providing an argument is working well with
 // (unsafe_)plugin::find_function_ptr():
 // - value copy with left_value
@@ -77,17 +100,189 @@ extern "C" const ConcatInterface& default_const_concat()
     return instance;
 }
 
+static std::atomic_int thread_instances_made = 0;
+
+extern "C" std::unique_ptr<ConcatInterface> make_thread_instance()
+{
+    ++thread_instances_made;
+    return std::make_unique<Concat>();
+}
+
+extern "C" int thread_instance_made_count()
+{
+    return thread_instances_made;
+}
+
+static std::atomic_int reset_instance_calls = 0;
+
+extern "C" void reset_instance(ConcatInterface&)
+{
+    ++reset_instance_calls;
+}
+
+extern "C" int reset_instance_call_count()
+{
+    return reset_instance_calls;
+}
+
+static std::atomic_int live_counted_instances = 0;
+
+// A Concat counting its live instances, to observe their destruction.
+class CountedConcat : public Concat
+{
+public:
+    CountedConcat() { ++live_counted_instances; }
+    ~CountedConcat() override { --live_counted_instances; }
+};
+
+extern "C" std::unique_ptr<ConcatInterface> make_counted_instance()
+{
+    return std::make_unique<CountedConcat>();
+}
+
+extern "C" int live_counted_instance_count()
+{
+    return live_counted_instances;
+}
+
+static bool warmed_up = false;
+
+extern "C" void warmup()
+{
+    warmed_up = true;
+}
+
+extern "C" bool is_warmed_up()
+{
+    return warmed_up;
+}
+
+// Signal its start, then run until it is released.
+extern "C" void run_until_released(std::atomic_bool& started, const std::atomic_bool& released)
+{
+    started = true;
+    while (!released)
+        std::this_thread::yield();
+}
+
+static std::atomic_int load_hook_calls = 0;
+static std::atomic_int unload_hook_calls = 0;
+static std::atomic_bool load_hook_failure = false;
+static std::atomic_bool load_hook_non_standard_failure = false;
+
+static void on_load()
+{
+    if (load_hook_failure)
+        throw std::runtime_error("Load hook failure.");
+    if (load_hook_non_standard_failure)
+        throw 42;
+    ++load_hook_calls;
+}
+
+static void on_unload()
+{
+    ++unload_hook_calls;
+}
+
+extern "C" int load_hook_call_count()
+{
+    return load_hook_calls;
+}
+
+extern "C" int unload_hook_call_count()
+{
+    return unload_hook_calls;
+}
+
+extern "C" void set_load_hook_failure(bool failure)
+{
+    load_hook_failure = failure;
+}
+
+// Make the load hook throw an exception which is not a std::exception.
+extern "C" void set_load_hook_non_standard_failure(bool failure)
+{
+    load_hook_non_standard_failure = failure;
+}
+
+ARBA_PLUG_ON_LOAD(on_load)
+ARBA_PLUG_ON_UNLOAD(on_unload)
+
+static const plug::host_services* host = nullptr;
+static std::atomic_bool host_binding_failure = false;
+
+static bool bind_host(const plug::host_services& services)
+{
+    if (host_binding_failure || services.version < 1)
+        return false;
+    host = &services;
+    host->write_log(plug::host_log_level::info, "concat bound");
+    return true;
+}
+
+extern "C" void set_host_binding_failure(bool failure)
+{
+    host_binding_failure = failure;
+}
+
+// Concatenate the values in a string allocated by the host, and record its length as a metric.
+extern "C" std::pmr::string concat_with_host(std::string_view left_value, std::string_view right_value)
+{
+    if (host == nullptr) [[unlikely]]
+        throw std::runtime_error("The concat plugin is not bound to host services.");
+    std::pmr::string res(host->resource());
+    res.append(left_value).append("-").append(right_value);
+    host->add_metric("concat_length", static_cast<double>(res.size()));
+    return res;
+}
+
+ARBA_PLUG_BIND_HOST(bind_host)
+
+extern "C" int sum(int left_value, int right_value)
+{
+    return left_value + right_value;
+}
+
+extern "C" int fail(int)
+{
+    throw std::runtime_error("Failure.");
+}
+
+extern "C" void abort_process()
+{
+    std::abort();
+}
+
 extern "C" int unregistered_function(std::string_view)
 {
     return 0;
 }
 
+ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION(make_unique_instance)
+ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION(make_unique_instance_from_args)
+ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION(execute)
+ARBA_PLUG_REGISTER_SIGNED_PLUGIN_FUNCTION(default_concat)
+
+ARBA_PLUG_DEFINE_FUNCTION_TABLE(concat_function_table, CONCAT_FUNCTION_TABLE_FUNCTIONS)
+
 ARBA_PLUG_BEGIN_SAFE_PLUGIN_FUNCTION_REGISTER()
 ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(make_unique_instance)
 ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(make_unique_instance_from_args)
 ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(make_shared_instance)
 ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(make_shared_instance_from_args)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(make_instances)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(make_instances_from_args)
 ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(execute)
 ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(default_concat)
 ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(default_const_concat)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(make_thread_instance)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(reset_instance)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(warmup)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(is_warmed_up)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(run_until_released)
+ARBA_PLUG_REGISTER_SAFE_PLUGIN_FUNCTION(sum)
 ARBA_PLUG_END_SAFE_PLUGIN_FUNCTION_REGISTER()
+
+ARBA_PLUG_BEGIN_SERVICE_REGISTER()
+ARBA_PLUG_REGISTER_SERVICE(ConcatInterface, make_shared_instance)
+ARBA_PLUG_END_SERVICE_REGISTER()
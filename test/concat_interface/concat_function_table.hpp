@@ -0,0 +1,16 @@
+#pragma once
+
+#include "concat_interface.hpp"
+
+#include <arba/plug/function_table.hpp>
+
+#include <memory>
+
+// The function table of the concat plugin, used to find all its functions with one lookup.
+
+#define CONCAT_FUNCTION_TABLE_FUNCTIONS(ENTRY)                                                                         \
+    ENTRY(make_unique_instance, std::unique_ptr<ConcatInterface> (*)())                                                \
+    ENTRY(execute, void (*)(std::string&, std::string_view, const std::string&))                                       \
+    ENTRY(default_concat, ConcatInterface& (*)())
+
+ARBA_PLUG_DECLARE_FUNCTION_TABLE(concat_function_table, 1, CONCAT_FUNCTION_TABLE_FUNCTIONS)
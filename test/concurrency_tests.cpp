@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+
+// classes to test
+#include <arba/plug/plugin.hpp>
+#include <arba/plug/safe_plugin.hpp>
+#include <arba/plug/signed_plugin.hpp>
+
+#include <concat_interface/concat_function_table.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+#if defined(__SANITIZE_THREAD__)
+#define ARBA_PLUG_TSAN
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define ARBA_PLUG_TSAN
+#endif
+#endif
+
+#ifdef ARBA_PLUG_TSAN
+// Load the suppressions of the races ThreadSanitizer reports in the dynamic loader (see tsan.supp).
+extern "C" const char* __tsan_default_options()
+{
+    return "suppressions=" TSAN_SUPPRESSIONS_PATH;
+}
+#endif
+
+namespace
+{
+using execute_function = void (*)(std::string&, std::string_view, const std::string&);
+
+constexpr std::size_t reader_count = 8;
+constexpr std::size_t reload_count = 100;
+
+// Readers look up and call a function of the plugin while the main thread unloads and reloads it.
+// A second plugin instance keeps the library mapped, so that the found functions stay callable after an unload.
+template <class PluginType, class LookupFunction>
+void stress_lookups_during_reloads(LookupFunction lookup_function)
+{
+    plug::plugin keeper(plugin_fpath);
+    PluginType plugin(plugin_fpath);
+    const std::filesystem::path loaded_plugin_path = plugin.plugin_path();
+    std::atomic_bool stop = false;
+    std::atomic<std::size_t> found_count = 0;
+    std::atomic<std::size_t> error_count = 0;
+
+    std::vector<std::thread> readers;
+    for (std::size_t i = 0; i < reader_count; ++i)
+    {
+        readers.emplace_back([&] {
+            std::string res;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    execute_function execute = lookup_function(plugin);
+                    execute(res, "a", "b");
+                    if (res != "a-b")
+                        error_count.fetch_add(1);
+                    found_count.fetch_add(1, std::memory_order_relaxed);
+                }
+                catch (const plug::plugin_find_symbol_error&)
+                {
+                    std::this_thread::yield();
+                }
+                const std::filesystem::path plugin_path = plugin.plugin_path();
+                if (!plugin_path.empty() && plugin_path != loaded_plugin_path)
+                    error_count.fetch_add(1);
+            }
+        });
+    }
+
+    for (std::size_t i = 0; i < reload_count; ++i)
+    {
+        plugin.unload();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        plugin.load_from_file(plugin_fpath);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    stop = true;
+    for (std::thread& reader : readers)
+        reader.join();
+
+    ASSERT_EQ(error_count.load(), 0);
+    ASSERT_GT(found_count.load(), 0);
+    ASSERT_TRUE(plugin.is_loaded());
+}
+} // namespace
+
+TEST(ConcurrencyTest, FindFunctionPtr_ConcurrentReloads_ExpectFoundOrNotLoaded)
+{
+    stress_lookups_during_reloads<plug::plugin>(
+        [](plug::plugin& plugin) { return plugin.find_function_ptr<execute_function>("execute"); });
+}
+
+TEST(ConcurrencyTest, SafeFindFunctionPtr_ConcurrentReloads_ExpectFoundOrNotLoaded)
+{
+    stress_lookups_during_reloads<plug::safe_plugin>(
+        [](plug::safe_plugin& plugin) { return plugin.find_function_ptr<execute_function>("execute"); });
+}
+
+TEST(ConcurrencyTest, SignedFindFunctionPtr_ConcurrentReloads_ExpectFoundOrNotLoaded)
+{
+    stress_lookups_during_reloads<plug::signed_plugin>(
+        [](plug::signed_plugin& plugin) { return plugin.find_function_ptr<execute_function>("execute"); });
+}
+
+TEST(ConcurrencyTest, FindSymbols_ConcurrentReloads_ExpectFoundOrNotLoaded)
+{
+    stress_lookups_during_reloads<plug::plugin>([](plug::plugin& plugin) {
+        const std::array<std::string_view, 1> names{ "execute" };
+        std::array<void*, 1> pointers{};
+        plugin.find_symbols(names, pointers);
+        return reinterpret_cast<execute_function>(pointers[0]);
+    });
+}
+
+TEST(ConcurrencyTest, FindFunctionTable_ConcurrentReloads_ExpectFoundOrNotLoaded)
+{
+    stress_lookups_during_reloads<plug::plugin>(
+        [](plug::plugin& plugin) { return plugin.find_function_table<concat_function_table>().execute; });
+}
+
+TEST(ConcurrencyTest, TrackedCall_ConcurrentReloads_ExpectCalledOrUnloaded)
+{
+    // No other instance keeps the library mapped: only the tracking of the calls keeps them valid.
+    plug::plugin plugin(plugin_fpath);
+    std::atomic_bool stop = false;
+    std::atomic<std::size_t> call_count = 0;
+    std::atomic<std::size_t> error_count = 0;
+
+    std::vector<std::thread> callers;
+    for (std::size_t i = 0; i < reader_count; ++i)
+    {
+        callers.emplace_back([&] {
+            std::string res;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    plug::tracked_function execute = plugin.bind_tracked_function<execute_function>("execute");
+                    for (std::size_t j = 0; j < 10; ++j)
+                    {
+                        execute(res, "a", "b");
+                        if (res != "a-b")
+                            error_count.fetch_add(1);
+                        call_count.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                catch (const plug::plugin_find_symbol_error&)
+                {
+                    std::this_thread::yield();
+                }
+                catch (const plug::plugin_unloaded_error&)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (std::size_t i = 0; i < reload_count; ++i)
+    {
+        if (i % 2 == 0)
+            plugin.unload();
+        else
+            plugin.unload_in_background();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        plugin.load_from_file(plugin_fpath);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    stop = true;
+    for (std::thread& caller : callers)
+        caller.join();
+    plug::wait_for_background_unloads();
+
+    ASSERT_EQ(error_count.load(), 0);
+    ASSERT_GT(call_count.load(), 0);
+}
+
+TEST(ConcurrencyTest, LoadStats_ConcurrentWarmUps_ExpectConsistentStats)
+{
+    plug::plugin plugin(plugin_fpath);
+    const std::size_t mapped_bytes = plugin.load_stats().mapped_bytes;
+    std::atomic_bool stop = false;
+    std::thread reader([&] {
+        while (!stop.load(std::memory_order_relaxed))
+            ASSERT_EQ(plugin.load_stats().mapped_bytes, mapped_bytes);
+    });
+    for (std::size_t i = 0; i < 100; ++i)
+        std::ignore = plugin.warm_up();
+    stop = true;
+    reader.join();
+}
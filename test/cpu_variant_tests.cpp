@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/cpu_variant.hpp>
+
+#include <arba/plug/plugin.hpp>
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+namespace
+{
+// Make a directory holding copies of the test plugin, named as some variants of the plugin "variant".
+std::filesystem::path make_variant_dir(std::initializer_list<plug::cpu_variant> variants)
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "arba_plug_cpu_variant_tests";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::filesystem::path source_path = plugin_fpath;
+    source_path += plug::plugin_file_extension;
+    for (plug::cpu_variant variant : variants)
+    {
+        std::string file_name = "variant";
+        if (variant != plug::cpu_variant::baseline)
+            file_name += std::format(".{}", plug::cpu_variant_name(variant));
+        std::filesystem::copy_file(source_path, dir / (file_name + std::string(plug::plugin_file_extension)));
+    }
+    return dir / "variant";
+}
+} // namespace
+
+TEST(CpuVariantTest, BestCpuVariant_ExpectSupported)
+{
+    ASSERT_TRUE(plug::is_cpu_variant_supported(plug::cpu_variant::baseline));
+    ASSERT_TRUE(plug::is_cpu_variant_supported(plug::best_cpu_variant()));
+    if (plug::best_cpu_variant() == plug::cpu_variant::avx512)
+    {
+        ASSERT_TRUE(plug::is_cpu_variant_supported(plug::cpu_variant::avx2));
+    }
+}
+
+TEST(CpuVariantTest, SelectPluginVariant_BaselineOnly_ExpectBaseline)
+{
+    const std::filesystem::path base_path = make_variant_dir({ plug::cpu_variant::baseline });
+    const plug::plugin_variant_selection selection = plug::select_plugin_variant(base_path);
+    ASSERT_EQ(selection.variant, plug::cpu_variant::baseline);
+    ASSERT_EQ(selection.plugin_path.filename(), std::format("variant{}", plug::plugin_file_extension));
+    ASSERT_EQ(selection.available_variants, std::vector{ plug::cpu_variant::baseline });
+}
+
+TEST(CpuVariantTest, SelectPluginVariant_AllVariants_ExpectBestSupported)
+{
+    const std::filesystem::path base_path =
+        make_variant_dir({ plug::cpu_variant::baseline, plug::cpu_variant::avx2, plug::cpu_variant::avx512 });
+    const plug::plugin_variant_selection selection = plug::select_plugin_variant(base_path);
+    ASSERT_EQ(selection.variant, plug::best_cpu_variant());
+    ASSERT_EQ(selection.available_variants.size(), 3);
+}
+
+TEST(CpuVariantTest, SelectPluginVariant_PathWithExtension_ExpectSameSelection)
+{
+    std::filesystem::path base_path = make_variant_dir({ plug::cpu_variant::baseline, plug::cpu_variant::avx2 });
+    const plug::plugin_variant_selection selection = plug::select_plugin_variant(base_path);
+    base_path += plug::plugin_file_extension;
+    ASSERT_EQ(plug::select_plugin_variant(base_path).plugin_path, selection.plugin_path);
+}
+
+TEST(CpuVariantTest, SelectPluginVariant_ForcedBaseline_ExpectBaseline)
+{
+    const std::filesystem::path base_path =
+        make_variant_dir({ plug::cpu_variant::baseline, plug::cpu_variant::avx2, plug::cpu_variant::avx512 });
+    const plug::plugin_variant_selection selection =
+        plug::select_plugin_variant(base_path, plug::cpu_variant::baseline);
+    ASSERT_EQ(selection.variant, plug::cpu_variant::baseline);
+}
+
+TEST(CpuVariantTest, SelectPluginVariant_ForcedMissingVariant_ExpectException)
+{
+    const std::filesystem::path base_path = make_variant_dir({ plug::cpu_variant::baseline });
+    ASSERT_THROW(std::ignore = plug::select_plugin_variant(base_path, plug::cpu_variant::avx2),
+                 plug::plugin_load_error);
+}
+
+TEST(CpuVariantTest, SelectPluginVariant_NoSupportedVariant_ExpectException)
+{
+    const std::filesystem::path base_path = make_variant_dir({});
+    ASSERT_THROW(std::ignore = plug::select_plugin_variant(base_path), plug::plugin_load_error);
+}
+
+TEST(CpuVariantTest, LoadFromFile_SelectCpuVariant_ExpectVariantLoaded)
+{
+    const std::filesystem::path base_path = make_variant_dir({ plug::cpu_variant::baseline, plug::cpu_variant::avx2 });
+    const plug::cpu_variant expected_variant = plug::is_cpu_variant_supported(plug::cpu_variant::avx2)
+                                                   ? plug::cpu_variant::avx2
+                                                   : plug::cpu_variant::baseline;
+    plug::plugin plugin(base_path, plug::plugin_load_options{ .select_cpu_variant = true });
+    ASSERT_EQ(plugin.load_stats().variant, expected_variant);
+    ASSERT_EQ(plugin.plugin_path(), plug::select_plugin_variant(base_path).plugin_path);
+    ASSERT_EQ(plugin.find_function_ptr<int (*)(int, int)>("sum")(2, 3), 5);
+}
+
+TEST(CpuVariantTest, LoadFromFile_ForcedCpuVariant_ExpectForcedVariantLoaded)
+{
+    const std::filesystem::path base_path = make_variant_dir({ plug::cpu_variant::baseline, plug::cpu_variant::avx2 });
+    plug::plugin plugin(base_path, plug::plugin_load_options{ .forced_cpu_variant = plug::cpu_variant::baseline });
+    ASSERT_EQ(plugin.load_stats().variant, plug::cpu_variant::baseline);
+    ASSERT_EQ(plugin.plugin_path().filename(), std::format("variant{}", plug::plugin_file_extension));
+}
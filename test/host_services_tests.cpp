@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/host_services.hpp>
+
+#include <arba/plug/plugin.hpp>
+
+#include <string>
+#include <vector>
+
+std::filesystem::path concat_plugin_fpath = CONCAT_PLUGIN_PATH;
+std::filesystem::path strgen_plugin_fpath = STRGEN_PLUGIN_PATH;
+
+namespace
+{
+using concat_with_host_function = std::pmr::string (*)(std::string_view, std::string_view);
+using set_host_binding_failure_function = void (*)(bool);
+
+struct test_host
+{
+    std::vector<std::string> messages;
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+void log_message(void* context, plug::host_log_level, std::string_view message) noexcept
+{
+    static_cast<test_host*>(context)->messages.emplace_back(message);
+}
+
+void record_metric(void* context, std::string_view name, double value) noexcept
+{
+    static_cast<test_host*>(context)->metrics.emplace_back(name, value);
+}
+
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+    std::size_t allocation_count = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocation_count;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+} // namespace
+
+TEST(HostServicesTest, Constructor_HostOption_ExpectPluginBound)
+{
+    test_host host;
+    const plug::host_services services{ .context = &host, .log = &log_message };
+    plug::plugin plugin(concat_plugin_fpath, plug::plugin_load_options{ .host = &services });
+    ASSERT_EQ(host.messages, std::vector<std::string>{ "concat bound" });
+}
+
+TEST(HostServicesTest, BindHost_PluginWithoutEntry_ExpectFalse)
+{
+    const plug::host_services services;
+    plug::plugin plugin(strgen_plugin_fpath);
+    ASSERT_FALSE(plugin.bind_host(services));
+}
+
+TEST(HostServicesTest, BindHost_RejectedTable_ExpectException)
+{
+    const plug::host_services services;
+    plug::plugin plugin(concat_plugin_fpath);
+    auto set_host_binding_failure =
+        plugin.find_function_ptr<set_host_binding_failure_function>("set_host_binding_failure");
+    set_host_binding_failure(true);
+    ASSERT_THROW(plugin.bind_host(services), plug::plugin_load_error);
+    set_host_binding_failure(false);
+    ASSERT_TRUE(plugin.bind_host(services));
+}
+
+TEST(HostServicesTest, LoadFromFile_HostOptionAndRejectedTable_ExpectExceptionAndUnloaded)
+{
+    const plug::host_services services;
+    plug::plugin other_plugin(concat_plugin_fpath);
+    auto set_host_binding_failure =
+        other_plugin.find_function_ptr<set_host_binding_failure_function>("set_host_binding_failure");
+    set_host_binding_failure(true);
+    plug::plugin plugin;
+    ASSERT_THROW(plugin.load_from_file(concat_plugin_fpath, plug::plugin_load_options{ .host = &services }),
+                 plug::plugin_load_error);
+    set_host_binding_failure(false);
+    ASSERT_FALSE(plugin.is_loaded());
+}
+
+TEST(HostServicesTest, CallHostServices_ExpectHostResourceAndMetrics)
+{
+    test_host host;
+    counting_resource resource;
+    const plug::host_services services{
+        .context = &host, .log = &log_message, .record_metric = &record_metric, .memory_resource = &resource
+    };
+    plug::plugin plugin(concat_plugin_fpath);
+    ASSERT_TRUE(plugin.bind_host(services));
+    auto concat_with_host = plugin.find_function_ptr<concat_with_host_function>("concat_with_host");
+    const std::string long_value(64, 'x');
+    const std::pmr::string res = concat_with_host(long_value, "b");
+    ASSERT_EQ(std::string_view(res), long_value + "-b");
+    ASSERT_EQ(res.get_allocator().resource(), &resource);
+    ASSERT_GT(resource.allocation_count, 0);
+    ASSERT_EQ(host.metrics.size(), 1);
+    ASSERT_EQ(host.metrics.front().first, "concat_length");
+    ASSERT_EQ(host.metrics.front().second, static_cast<double>(res.size()));
+}
+
+TEST(HostServicesTest, CallHostServices_MissingServices_ExpectDefaults)
+{
+    const plug::host_services services;
+    plug::plugin plugin(concat_plugin_fpath, plug::plugin_load_options{ .host = &services });
+    auto concat_with_host = plugin.find_function_ptr<concat_with_host_function>("concat_with_host");
+    const std::pmr::string res = concat_with_host("a", "b");
+    ASSERT_EQ(std::string_view(res), "a-b");
+    ASSERT_EQ(res.get_allocator().resource(), std::pmr::get_default_resource());
+}
+
+TEST(HostServicesTest, CallHostServices_NotBound_ExpectException)
+{
+    plug::plugin plugin(concat_plugin_fpath);
+    auto concat_with_host = plugin.find_function_ptr<concat_with_host_function>("concat_with_host");
+    ASSERT_THROW(std::ignore = concat_with_host("a", "b"), std::runtime_error);
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/instance_accessor.hpp>
+
+#include <arba/plug/plugin.hpp>
+#include <arba/plug/safe_plugin.hpp>
+#include <concat_interface/concat_interface.hpp>
+
+#include <thread>
+#include <vector>
+
+#include "test_helpers.hpp"
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+namespace
+{
+using count_function = int (*)();
+} // namespace
+
+// Load identifier
+
+TEST(InstanceAccessorTest, LoadId_LoadAndUnload_ExpectNewIdAtEachLoad)
+{
+    plug::plugin plugin(plugin_fpath);
+    const std::uint64_t load_id = plugin.load_id();
+    ASSERT_NE(load_id, 0);
+    plugin.load_from_file(plugin_fpath);
+    ASSERT_NE(plugin.load_id(), 0);
+    ASSERT_NE(plugin.load_id(), load_id);
+    plugin.unload();
+    ASSERT_EQ(plugin.load_id(), 0);
+}
+
+// BindInstanceRef & BindInstanceCref
+
+TEST(InstanceAccessorTest, BindInstanceRef_FunctionExists_ExpectSameReference)
+{
+    plug::plugin plugin(plugin_fpath);
+    plug::basic_instance_accessor concat = plugin.bind_instance_ref<ConcatInterface>("default_concat");
+    ASSERT_EQ(&concat.get(), &plugin.instance_ref<ConcatInterface>("default_concat"));
+    ASSERT_EQ(concat->concat("a", "b"), "a-b");
+    ASSERT_EQ(&*concat, &concat.get());
+}
+
+TEST(InstanceAccessorTest, BindInstanceCref_FunctionExists_ExpectSameConstReference)
+{
+    plug::safe_plugin plugin(plugin_fpath);
+    plug::basic_instance_accessor concat = plugin.bind_instance_cref<ConcatInterface>("default_const_concat");
+    static_assert(std::is_same_v<decltype(concat.get()), const ConcatInterface&>);
+    ASSERT_EQ(&concat.get(), &plugin.instance_cref<ConcatInterface>("default_const_concat"));
+}
+
+TEST(InstanceAccessorTest, BindInstanceRef_FunctionNotFound_ExpectException)
+{
+    plug::plugin plugin(plugin_fpath);
+    ASSERT_THROW(std::ignore = plugin.bind_instance_ref<ConcatInterface>("unknown_getter"),
+                 plug::plugin_find_symbol_error);
+}
+
+TEST(InstanceAccessorTest, Get_UnloadedPlugin_ExpectException)
+{
+    plug::plugin plugin(plugin_fpath);
+    plug::basic_instance_accessor concat = plugin.bind_instance_ref<ConcatInterface>("default_concat");
+    plugin.unload();
+    ASSERT_THROW(std::ignore = concat.get(), plug::plugin_find_symbol_error);
+    plugin.load_from_file(plugin_fpath);
+    ASSERT_EQ(&concat.get(), &plugin.instance_ref<ConcatInterface>("default_concat"));
+}
+
+// BindThreadInstance
+
+TEST(InstanceAccessorTest, BindThreadInstance_SameThread_ExpectOneInstance)
+{
+    plug::plugin plugin(plugin_fpath);
+    auto thread_instance_made_count = plugin.find_function_ptr<count_function>("thread_instance_made_count");
+    const int made_count = thread_instance_made_count();
+    plug::basic_thread_instance_accessor concat = plugin.bind_thread_instance<ConcatInterface>();
+    ConcatInterface& instance = concat.get();
+    ASSERT_EQ(&concat.get(), &instance);
+    ASSERT_EQ(concat->concat("a", "b"), "a-b");
+    ASSERT_EQ(concat.instance_count(), 1);
+    ASSERT_EQ(thread_instance_made_count(), made_count + 1);
+}
+
+TEST(InstanceAccessorTest, BindThreadInstance_SeveralThreads_ExpectOneInstancePerThread)
+{
+    constexpr std::size_t thread_count = 4;
+    plug::plugin plugin(plugin_fpath);
+    plug::basic_thread_instance_accessor concat = plugin.bind_thread_instance<ConcatInterface>();
+    std::vector<ConcatInterface*> instances(thread_count);
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0; i < thread_count; ++i)
+            threads.emplace_back([&concat, &instance = instances[i]] {
+                instance = &concat.get();
+                for (int j = 0; j < 100; ++j)
+                    if (&concat.get() != instance)
+                        instance = nullptr;
+            });
+    }
+    ASSERT_EQ(concat.instance_count(), thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+        ASSERT_NE(instances[i], nullptr);
+        for (std::size_t j = i + 1; j < thread_count; ++j)
+            ASSERT_NE(instances[i], instances[j]);
+    }
+}
+
+TEST(InstanceAccessorTest, Reset_ExpectNewInstance)
+{
+    plug::plugin plugin(plugin_fpath);
+    plug::basic_thread_instance_accessor concat = plugin.bind_thread_instance<ConcatInterface>();
+    std::ignore = concat.get();
+    concat.reset();
+    ASSERT_EQ(concat.instance_count(), 0);
+    std::ignore = concat.get();
+    ASSERT_EQ(concat.instance_count(), 1);
+}
+
+TEST(InstanceAccessorTest, BindThreadInstance_ReloadFromOtherFile_ExpectInstancesDestroyedBeforeClose)
+{
+    // The copy is only loaded by this test: the reload closes it and unmaps the code of its instances.
+    plug::plugin plugin(make_plugin_copy(plugin_fpath, "arba_plug_instance_accessor_tests"));
+    plug::basic_thread_instance_accessor concat = plugin.bind_thread_instance<ConcatInterface>();
+    std::ignore = concat.get();
+    std::jthread([&concat] { std::ignore = concat.get(); }).join();
+    ASSERT_EQ(concat.instance_count(), 2);
+    plugin.load_from_file(plugin_fpath);
+    ASSERT_EQ(concat.instance_count(), 0);
+    ASSERT_EQ(concat->concat("a", "b"), "a-b");
+    ASSERT_EQ(concat.instance_count(), 1);
+    plugin.unload();
+    ASSERT_EQ(concat.instance_count(), 0);
+    ASSERT_THROW(std::ignore = concat.get(), plug::plugin_find_symbol_error);
+}
+
+TEST(InstanceAccessorTest, BindThreadInstance_MakerNotFound_ExpectException)
+{
+    plug::plugin plugin(plugin_fpath);
+    ASSERT_THROW(std::ignore = plugin.bind_thread_instance<ConcatInterface>("unknown_maker"),
+                 plug::plugin_find_symbol_error);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/lifecycle.hpp>
+
+#include <arba/plug/plugin.hpp>
+#include <arba/plug/plugin_manager.hpp>
+
+std::filesystem::path concat_plugin_fpath = CONCAT_PLUGIN_PATH;
+std::filesystem::path strgen_plugin_fpath = STRGEN_PLUGIN_PATH;
+
+namespace
+{
+using hook_call_count_function = int (*)();
+using set_load_hook_failure_function = void (*)(bool);
+} // namespace
+
+// Initialize
+
+TEST(LifecycleTest, Initialize_LoadHook_ExpectHookCalledOnce)
+{
+    plug::plugin plugin(concat_plugin_fpath);
+    auto load_hook_call_count = plugin.find_function_ptr<hook_call_count_function>("load_hook_call_count");
+    const int call_count = load_hook_call_count();
+    ASSERT_FALSE(plugin.is_initialized());
+    ASSERT_TRUE(plugin.initialize());
+    ASSERT_TRUE(plugin.is_initialized());
+    ASSERT_FALSE(plugin.initialize());
+    ASSERT_EQ(load_hook_call_count(), call_count + 1);
+    ASSERT_GT(plugin.load_stats().initialize_duration.count(), 0);
+}
+
+TEST(LifecycleTest, Initialize_NoHook_ExpectInitialized)
+{
+    plug::plugin plugin(strgen_plugin_fpath);
+    ASSERT_TRUE(plugin.initialize());
+    ASSERT_TRUE(plugin.is_initialized());
+}
+
+TEST(LifecycleTest, Initialize_FailingLoadHook_ExpectExceptionAndNotInitialized)
+{
+    plug::plugin plugin(concat_plugin_fpath);
+    auto set_load_hook_failure = plugin.find_function_ptr<set_load_hook_failure_function>("set_load_hook_failure");
+    set_load_hook_failure(true);
+    ASSERT_THROW(plugin.initialize(), std::runtime_error);
+    ASSERT_FALSE(plugin.is_initialized());
+    set_load_hook_failure(false);
+}
+
+TEST(LifecycleTest, Constructor_InitializeOption_ExpectInitialized)
+{
+    plug::plugin plugin(concat_plugin_fpath, plug::plugin_load_options{ .initialize = true });
+    ASSERT_TRUE(plugin.is_initialized());
+}
+
+TEST(LifecycleTest, LoadFromFile_InitializeOptionAndFailingLoadHook_ExpectExceptionAndUnloaded)
+{
+    plug::plugin other_plugin(concat_plugin_fpath);
+    auto set_load_hook_failure =
+        other_plugin.find_function_ptr<set_load_hook_failure_function>("set_load_hook_failure");
+    set_load_hook_failure(true);
+    plug::plugin plugin;
+    ASSERT_THROW(plugin.load_from_file(concat_plugin_fpath, plug::plugin_load_options{ .initialize = true }),
+                 std::runtime_error);
+    set_load_hook_failure(false);
+    ASSERT_FALSE(plugin.is_loaded());
+}
+
+TEST(LifecycleTest, Unload_Initialized_ExpectUnloadHookCalled)
+{
+    // The plugin is kept mapped, to read its counter after the unload.
+    const plug::plugin_load_options options{ .unload_policy = plug::plugin_unload_policy::keep_mapped };
+    plug::plugin plugin(concat_plugin_fpath, options);
+    auto unload_hook_call_count = plugin.find_function_ptr<hook_call_count_function>("unload_hook_call_count");
+    const int call_count = unload_hook_call_count();
+    plugin.initialize();
+    plugin.unload();
+    ASSERT_EQ(unload_hook_call_count(), call_count + 1);
+}
+
+TEST(LifecycleTest, Unload_NotInitialized_ExpectUnloadHookNotCalled)
+{
+    const plug::plugin_load_options options{ .unload_policy = plug::plugin_unload_policy::keep_mapped };
+    plug::plugin plugin(concat_plugin_fpath, options);
+    auto unload_hook_call_count = plugin.find_function_ptr<hook_call_count_function>("unload_hook_call_count");
+    const int call_count = unload_hook_call_count();
+    plugin.unload();
+    ASSERT_EQ(unload_hook_call_count(), call_count);
+}
+
+// InitializeAll
+
+TEST(LifecycleTest, InitializeAll_TwoPlugins_ReturnReport)
+{
+    plug::plugin_manager manager;
+    manager.load("concat", concat_plugin_fpath);
+    manager.load("strgen", strgen_plugin_fpath, plug::plugin_load_options{ .initialize = true });
+    const std::vector<plug::plugin_initialize_report_entry> report = manager.initialize_all(2);
+    ASSERT_EQ(report.size(), 2);
+    ASSERT_GE(report[0].initialize_duration, report[1].initialize_duration);
+    for (const plug::plugin_initialize_report_entry& entry : report)
+    {
+        if (entry.name == "concat")
+            ASSERT_EQ(entry.status, plug::plugin_initialize_status::initialized);
+        else
+            ASSERT_EQ(entry.status, plug::plugin_initialize_status::already_initialized);
+    }
+    ASSERT_TRUE(manager.get("concat").is_initialized());
+}
+
+TEST(LifecycleTest, InitializeAll_FailingLoadHook_ReturnFailedEntry)
+{
+    plug::plugin_manager manager;
+    plug::plugin& concat_plugin = manager.load("concat", concat_plugin_fpath);
+    auto set_load_hook_failure =
+        concat_plugin.find_function_ptr<set_load_hook_failure_function>("set_load_hook_failure");
+    set_load_hook_failure(true);
+    const std::vector<plug::plugin_initialize_report_entry> report = manager.initialize_all();
+    set_load_hook_failure(false);
+    ASSERT_EQ(report.size(), 1);
+    ASSERT_EQ(report[0].status, plug::plugin_initialize_status::failed);
+    ASSERT_EQ(report[0].error_message, "Load hook failure.");
+    ASSERT_FALSE(concat_plugin.is_initialized());
+}
+
+TEST(LifecycleTest, InitializeAll_TimeLimitReached_ReturnTimedOutEntries)
+{
+    plug::plugin_manager manager;
+    manager.load("concat", concat_plugin_fpath);
+    manager.load("strgen", strgen_plugin_fpath);
+    const std::vector<plug::plugin_initialize_report_entry> report =
+        manager.initialize_all(1, std::chrono::nanoseconds(0));
+    ASSERT_EQ(report.size(), 2);
+    for (const plug::plugin_initialize_report_entry& entry : report)
+        ASSERT_EQ(entry.status, plug::plugin_initialize_status::timed_out);
+    ASSERT_FALSE(manager.get("concat").is_initialized());
+}
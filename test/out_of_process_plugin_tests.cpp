@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/out_of_process_plugin.hpp>
+
+#include <arba/plug/safe_plugin.hpp>
+
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+namespace
+{
+using sum_function = int (*)(int, int);
+} // namespace
+
+// Constructor
+
+TEST(OutOfProcessPluginTest, Constructor_ExistingLibrary_ExpectRunningProcess)
+{
+    plug::out_of_process_plugin plugin(plugin_fpath);
+    ASSERT_TRUE(plugin.is_running());
+    ASSERT_NE(plugin.process_id(), getpid());
+}
+
+TEST(OutOfProcessPluginTest, Constructor_UnfoundLibrary_ExpectException)
+{
+    ASSERT_THROW(plug::out_of_process_plugin(std::filesystem::current_path() / "concat/libunfound"),
+                 plug::plugin_load_error);
+}
+
+TEST(OutOfProcessPluginTest, Constructor_NonStandardExceptionInLoadHook_ExpectExceptionAndProcessEnded)
+{
+    // The helper process is forked from the host: it inherits the failure mode set in the plugin loaded by the host.
+    plug::plugin host_plugin(plugin_fpath);
+    auto set_load_hook_non_standard_failure =
+        host_plugin.find_function_ptr<void (*)(bool)>("set_load_hook_non_standard_failure");
+    set_load_hook_non_standard_failure(true);
+    const pid_t host_process_id = getpid();
+    try
+    {
+        plug::out_of_process_plugin plugin(plugin_fpath, plug::plugin_load_options{ .initialize = true });
+        set_load_hook_non_standard_failure(false);
+        FAIL() << "The load hook is expected to fail.";
+    }
+    catch (const plug::plugin_load_error& error)
+    {
+        set_load_hook_non_standard_failure(false);
+        ASSERT_EQ(getpid(), host_process_id);
+        ASSERT_NE(std::string_view(error.what()).find("not a std::exception"), std::string_view::npos);
+    }
+}
+
+// FindFunction
+
+TEST(OutOfProcessPluginTest, FindFunction_ExistingFunction_ReturnCallableFunction)
+{
+    plug::out_of_process_plugin plugin(plugin_fpath);
+    plug::remote_function sum = plugin.find_function<sum_function>("sum");
+    ASSERT_TRUE(sum.is_callable());
+    ASSERT_EQ(sum(2, 3), 5);
+}
+
+TEST(OutOfProcessPluginTest, FindFunction_UnfoundFunction_ExpectException)
+{
+    plug::out_of_process_plugin plugin(plugin_fpath);
+    ASSERT_THROW(std::ignore = plugin.find_function<sum_function>("unfound"), plug::plugin_find_symbol_error);
+}
+
+TEST(OutOfProcessPluginTest, FindFunction_SafePluginBadFunctionType_ExpectException)
+{
+    plug::basic_out_of_process_plugin<plug::safe_plugin> plugin(plugin_fpath);
+    ASSERT_EQ(plugin.find_function<sum_function>("sum")(1, 1), 2);
+    ASSERT_THROW(std::ignore = plugin.find_function<int (*)(float)>("sum"), std::runtime_error);
+}
+
+// Call
+
+TEST(OutOfProcessPluginTest, Submit_SeveralCalls_ReturnAllResults)
+{
+    plug::out_of_process_plugin plugin(plugin_fpath);
+    plug::remote_function sum = plugin.find_function<sum_function>("sum");
+    std::vector<plug::pending_call<int>> calls;
+    for (int i = 0; i < 32; ++i)
+        calls.push_back(sum.submit(i, 1));
+    for (int i = 0; i < 32; ++i)
+        ASSERT_EQ(calls[i].get(), i + 1);
+}
+
+TEST(OutOfProcessPluginTest, Call_ConcurrentThreads_ReturnAllResults)
+{
+    plug::out_of_process_plugin plugin(plugin_fpath);
+    plug::remote_function sum = plugin.find_function<sum_function>("sum");
+    std::atomic_int error_count = 0;
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < 200; ++i)
+                    if (sum(t, i) != t + i)
+                        ++error_count;
+            });
+    }
+    ASSERT_EQ(error_count, 0);
+}
+
+TEST(OutOfProcessPluginTest, Call_FunctionThrows_ExpectException)
+{
+    plug::out_of_process_plugin plugin(plugin_fpath);
+    plug::remote_function fail = plugin.find_function<int (*)(int)>("fail");
+    ASSERT_THROW(fail(0), std::runtime_error);
+    ASSERT_TRUE(plugin.is_running());
+}
+
+TEST(OutOfProcessPluginTest, Call_PluginCrashes_ExpectExceptionAndHostAlive)
+{
+    plug::out_of_process_plugin plugin(plugin_fpath);
+    plug::remote_function abort_process = plugin.find_function<void (*)()>("abort_process");
+    plug::remote_function sum = plugin.find_function<sum_function>("sum");
+    ASSERT_THROW(abort_process(), plug::plugin_process_error);
+    ASSERT_FALSE(plugin.is_running());
+    ASSERT_THROW(sum(1, 2), plug::plugin_process_error);
+}
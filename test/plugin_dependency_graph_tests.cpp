@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/plugin_dependency_graph.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+#include "test_helpers.hpp"
+
+namespace
+{
+std::size_t position(const std::vector<std::size_t>& order, std::size_t node)
+{
+    return std::ranges::find(order, node) - order.begin();
+}
+} // namespace
+
+// Constructor
+
+TEST(PluginDependencyGraphTest, Constructor_Diamond_ReturnTopologicalOrder)
+{
+    const std::vector<plug::plugin_load_spec> specs{ make_spec("app", {}, { "left", "right" }),
+                                                     make_spec("left", {}, { "base" }),
+                                                     make_spec("right", {}, { "base" }), make_spec("base") };
+    const plug::plugin_dependency_graph graph(specs);
+    ASSERT_EQ(graph.size(), 4);
+    ASSERT_EQ(graph.dependency_count(0), 2);
+    ASSERT_EQ(graph.dependency_count(3), 0);
+    ASSERT_EQ(graph.dependents(3).size(), 2);
+    const std::vector<std::size_t>& order = graph.topological_order();
+    ASSERT_EQ(order.size(), 4);
+    ASSERT_EQ(order.front(), 3);
+    ASSERT_EQ(order.back(), 0);
+    ASSERT_LT(position(order, 3), position(order, 1));
+    ASSERT_LT(position(order, 2), position(order, 0));
+}
+
+TEST(PluginDependencyGraphTest, Constructor_DependencyAlreadyLoaded_ExpectNoException)
+{
+    const std::vector<plug::plugin_load_spec> specs{ make_spec("app", {}, { "base" }) };
+    const std::vector<std::string_view> loaded_names{ "base" };
+    const plug::plugin_dependency_graph graph(specs, loaded_names);
+    ASSERT_EQ(graph.dependency_count(0), 0);
+}
+
+TEST(PluginDependencyGraphTest, Constructor_UnknownDependency_ExpectException)
+{
+    const std::vector<plug::plugin_load_spec> specs{ make_spec("app", {}, { "base" }) };
+    ASSERT_THROW(plug::plugin_dependency_graph{ specs }, std::invalid_argument);
+}
+
+TEST(PluginDependencyGraphTest, Constructor_DuplicateNameInSpecs_ExpectExceptionNamingDuplicate)
+{
+    const std::vector<plug::plugin_load_spec> specs{ make_spec("base"), make_spec("base") };
+    try
+    {
+        const plug::plugin_dependency_graph graph(specs);
+        FAIL() << "A duplicate name was not detected.";
+    }
+    catch (const std::invalid_argument& exception)
+    {
+        ASSERT_NE(std::string_view(exception.what()).find("appears twice in the load specs"), std::string_view::npos)
+            << exception.what();
+    }
+}
+
+TEST(PluginDependencyGraphTest, Constructor_NameAlreadyLoaded_ExpectExceptionNamingLoadedPlugin)
+{
+    const std::vector<plug::plugin_load_spec> specs{ make_spec("base") };
+    const std::vector<std::string_view> loaded_names{ "base" };
+    try
+    {
+        const plug::plugin_dependency_graph graph(specs, loaded_names);
+        FAIL() << "A loaded name was not detected.";
+    }
+    catch (const std::invalid_argument& exception)
+    {
+        ASSERT_NE(std::string_view(exception.what()).find("is already loaded"), std::string_view::npos)
+            << exception.what();
+    }
+}
+
+TEST(PluginDependencyGraphTest, Constructor_Cycle_ExpectExceptionNamingCycle)
+{
+    const std::vector<plug::plugin_load_spec> specs{ make_spec("app", {}, { "a" }), make_spec("a", {}, { "b" }),
+                                                     make_spec("b", {}, { "a" }) };
+    try
+    {
+        const plug::plugin_dependency_graph graph(specs);
+        FAIL() << "A cycle was not detected.";
+    }
+    catch (const std::invalid_argument& exception)
+    {
+        ASSERT_NE(std::string_view(exception.what()).find("a -> b -> a"), std::string_view::npos) << exception.what();
+    }
+}
+
+// ReadPluginManifest
+
+TEST(PluginDependencyGraphTest, ReadPluginManifest_ValidFile_ReturnSpecs)
+{
+    const std::filesystem::path manifest_path = std::filesystem::temp_directory_path() / "arba_plug_manifest.txt";
+    {
+        std::ofstream stream(manifest_path);
+        stream << "# name path dependencies\n"
+                  "base libbase\n"
+                  "\n"
+                  "app  plugins/libapp  base other\n";
+    }
+    const std::vector<plug::plugin_load_spec> specs = plug::read_plugin_manifest(manifest_path);
+    std::filesystem::remove(manifest_path);
+    ASSERT_EQ(specs.size(), 2);
+    ASSERT_EQ(specs[0].name, "base");
+    ASSERT_EQ(specs[0].plugin_path, manifest_path.parent_path() / "libbase");
+    ASSERT_TRUE(specs[0].dependencies.empty());
+    ASSERT_EQ(specs[1].name, "app");
+    ASSERT_EQ(specs[1].plugin_path, manifest_path.parent_path() / "plugins/libapp");
+    ASSERT_EQ(specs[1].dependencies, (std::vector<std::string>{ "base", "other" }));
+}
+
+TEST(PluginDependencyGraphTest, ReadPluginManifest_MissingPath_ExpectException)
+{
+    const std::filesystem::path manifest_path = std::filesystem::temp_directory_path() / "arba_plug_bad_manifest.txt";
+    {
+        std::ofstream stream(manifest_path);
+        stream << "base\n";
+    }
+    ASSERT_THROW(std::ignore = plug::read_plugin_manifest(manifest_path), std::runtime_error);
+    std::filesystem::remove(manifest_path);
+}
+
+TEST(PluginDependencyGraphTest, ReadPluginManifest_UnfoundFile_ExpectException)
+{
+    ASSERT_THROW(std::ignore = plug::read_plugin_manifest(std::filesystem::current_path() / "unfound_manifest.txt"),
+                 std::runtime_error);
+}
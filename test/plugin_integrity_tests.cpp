@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/plugin_integrity.hpp>
+
+#include <arba/plug/exception.hpp>
+#include <arba/plug/plugin.hpp>
+
+#include <format>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "test_helpers.hpp"
+
+std::filesystem::path concat_plugin_fpath = CONCAT_PLUGIN_PATH;
+std::filesystem::path strgen_plugin_fpath = STRGEN_PLUGIN_PATH;
+
+namespace
+{
+using sum_function = int (*)(int, int);
+
+// A directory holding copies of the plugins and their manifest, removed at the end of the test.
+class plugin_directory
+{
+public:
+    explicit plugin_directory(std::string_view name)
+        : path_(std::filesystem::temp_directory_path() / "arba_plug_integrity_tests" / name)
+    {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+        concat_path_ = copy_plugin(concat_plugin_fpath, path_);
+        strgen_path_ = copy_plugin(strgen_plugin_fpath, path_);
+    }
+
+    ~plugin_directory() { std::filesystem::remove_all(path_); }
+
+    const std::filesystem::path& concat_path() const { return concat_path_; }
+    const std::filesystem::path& strgen_path() const { return strgen_path_; }
+    std::filesystem::path manifest_path() const { return path_ / "plugins.sha256"; }
+    std::filesystem::path cache_path() const { return path_ / "plugins.cache"; }
+
+    // Write the manifest of the plugins, with the digest of concat replaced if concat_digest is given.
+    void write_manifest(std::optional<std::string> concat_digest = std::nullopt) const
+    {
+        std::ofstream stream(manifest_path());
+        stream << "# Plugins of the test\n\n";
+        stream << std::format("{}  {}\n",
+                              concat_digest.value_or(plug::to_hex_string(plug::hash_plugin_file(concat_path_))),
+                              concat_path_.filename().string());
+        stream << std::format("{} *{}\n", plug::to_hex_string(plug::hash_plugin_file(strgen_path_)),
+                              strgen_path_.filename().string());
+    }
+
+private:
+    std::filesystem::path path_;
+    std::filesystem::path concat_path_;
+    std::filesystem::path strgen_path_;
+};
+// A digest which is not the one of a plugin.
+constexpr std::string_view wrong_digest = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+
+std::string hex_content_hash(std::string_view text)
+{
+    return plug::to_hex_string(plug::content_hash(std::as_bytes(std::span(text))));
+}
+} // namespace
+
+TEST(PluginIntegrityTest, ContentHash_ReferenceDigests_ExpectSameDigests)
+{
+    std::string bytes(768, '\0');
+    for (std::size_t i = 0; i < bytes.size(); ++i)
+        bytes[i] = static_cast<char>(i);
+    const std::string_view view = bytes;
+    ASSERT_EQ(hex_content_hash(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    ASSERT_EQ(hex_content_hash("a"), "ca978112ca1bbdcafac231b39a23dc4da786eff8147c4e72b9807785afee48bb");
+    ASSERT_EQ(hex_content_hash("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    ASSERT_EQ(hex_content_hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    // The padding fits in the last block, does not fit, and takes a block of its own.
+    ASSERT_EQ(hex_content_hash(view.substr(0, 55)), "463eb28e72f82e0a96c0a4cc53690c571281131f672aa229e0d45ae59b598b59");
+    ASSERT_EQ(hex_content_hash(view.substr(0, 56)), "da2ae4d6b36748f2a318f23e7ab1dfdf45acdc9d049bd80e59de82a60895f562");
+    ASSERT_EQ(hex_content_hash(view.substr(0, 64)), "fdeab9acf3710362bd2658cdc9a29e8f9c757fcf9811603a8c447cd1d9151108");
+    ASSERT_EQ(hex_content_hash(view.substr(0, 100)),
+              "bce0aff19cf5aa6a7469a30d61d04e4376e4bbf6381052ee9e7f33925c954d52");
+    ASSERT_EQ(hex_content_hash(view), "f3a25aa93aa2fbba28d79260535bbd6a5eb0fc1c24a8b0f04e12b484c1dfe363");
+    ASSERT_EQ(hex_content_hash(std::string(1'000'000, 'a')),
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+TEST(PluginIntegrityTest, Verify_ValidPlugin_ExpectHashedOnce)
+{
+    plugin_directory directory("valid");
+    directory.write_manifest();
+    plug::plugin_integrity_verifier verifier(directory.manifest_path());
+    ASSERT_EQ(verifier.manifest_size(), 2);
+    ASSERT_NO_THROW(verifier.verify(directory.concat_path()));
+    ASSERT_NO_THROW(verifier.verify(directory.concat_path()));
+    ASSERT_EQ(verifier.hashed_file_count(), 1);
+}
+
+TEST(PluginIntegrityTest, Verify_InvalidPlugins_ExpectException)
+{
+    plugin_directory directory("invalid");
+    directory.write_manifest(std::string(wrong_digest));
+    plug::plugin_integrity_verifier verifier(directory.manifest_path());
+    ASSERT_THROW(verifier.verify(directory.concat_path()), plug::plugin_integrity_error);
+    ASSERT_THROW(verifier.verify(concat_plugin_fpath.string() + std::string(plug::plugin_file_extension)),
+                 plug::plugin_integrity_error);
+    ASSERT_NO_THROW(verifier.verify(directory.strgen_path()));
+}
+
+TEST(PluginIntegrityTest, Constructor_InvalidManifest_ExpectException)
+{
+    plugin_directory directory("invalid_manifest");
+    std::ofstream(directory.manifest_path()) << "not_a_digest  plugin.so\n";
+    ASSERT_THROW(plug::plugin_integrity_verifier{ directory.manifest_path() }, plug::plugin_integrity_error);
+    ASSERT_THROW(plug::plugin_integrity_verifier{ directory.manifest_path() / "missing" },
+                 plug::plugin_integrity_error);
+}
+
+TEST(PluginIntegrityTest, VerifyAll_OneInvalidPlugin_ExpectAllVerified)
+{
+    plugin_directory directory("verify_all");
+    directory.write_manifest(std::string(wrong_digest));
+    plug::plugin_integrity_verifier verifier(directory.manifest_path());
+    const std::vector<std::filesystem::path> plugin_paths{ directory.concat_path(), directory.strgen_path() };
+    try
+    {
+        verifier.verify_all(plugin_paths, 2);
+        FAIL() << "The concat plugin is expected to be invalid.";
+    }
+    catch (const plug::plugin_integrity_error& error)
+    {
+        ASSERT_TRUE(std::string_view(error.what()).starts_with("1 plugin(s)"));
+    }
+    ASSERT_EQ(verifier.hashed_file_count(), 2);
+}
+
+TEST(PluginIntegrityTest, SaveCache_UnchangedPlugins_ExpectNoHashAtNextStart)
+{
+    plugin_directory directory("cache");
+    directory.write_manifest();
+    {
+        plug::plugin_integrity_verifier verifier(directory.manifest_path(), directory.cache_path());
+        const std::vector<std::filesystem::path> plugin_paths{ directory.concat_path(), directory.strgen_path() };
+        verifier.verify_all(plugin_paths);
+        ASSERT_EQ(verifier.hashed_file_count(), 2);
+        verifier.save_cache();
+    }
+    {
+        plug::plugin_integrity_verifier verifier(directory.manifest_path(), directory.cache_path());
+        verifier.verify(directory.concat_path());
+        verifier.verify(directory.strgen_path());
+        ASSERT_EQ(verifier.hashed_file_count(), 0);
+    }
+    std::ofstream(directory.concat_path(), std::ios::app) << "tampered";
+    {
+        plug::plugin_integrity_verifier verifier(directory.manifest_path(), directory.cache_path());
+        ASSERT_THROW(verifier.verify(directory.concat_path()), plug::plugin_integrity_error);
+        ASSERT_EQ(verifier.hashed_file_count(), 1);
+    }
+}
+
+#if !defined(WIN32) && !defined(__MINGW32__) && !defined(__MINGW64__)
+TEST(PluginIntegrityTest, Verify_RewrittenPluginWithSameModificationTime_ExpectHashedAgain)
+{
+    plugin_directory directory("rewritten");
+    directory.write_manifest();
+    plug::plugin_integrity_verifier verifier(directory.manifest_path());
+    ASSERT_NO_THROW(verifier.verify(directory.concat_path()));
+    // The content is replaced without changing the size, then the modification time is restored.
+    const auto modification_time = std::filesystem::last_write_time(directory.concat_path());
+    {
+        std::fstream stream(directory.concat_path(), std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekp(0);
+        stream.put('X');
+    }
+    std::filesystem::last_write_time(directory.concat_path(), modification_time);
+    ASSERT_THROW(verifier.verify(directory.concat_path()), plug::plugin_integrity_error);
+    ASSERT_EQ(verifier.hashed_file_count(), 2);
+}
+#endif
+
+TEST(PluginIntegrityTest, LoadFromFile_IntegrityVerifierOption_ExpectVerifiedLoad)
+{
+    plugin_directory directory("load");
+    directory.write_manifest();
+    plug::plugin_integrity_verifier verifier(directory.manifest_path());
+    plug::plugin plugin(directory.concat_path(), plug::plugin_load_options{ .integrity_verifier = &verifier });
+    ASSERT_EQ(plugin.find_function_ptr<sum_function>("sum")(2, 2), 4);
+    ASSERT_EQ(verifier.hashed_file_count(), 1);
+}
+
+TEST(PluginIntegrityTest, LoadFromFile_InvalidPlugin_ExpectNotLoaded)
+{
+    plugin_directory directory("load_invalid");
+    directory.write_manifest(std::string(wrong_digest));
+    plug::plugin_integrity_verifier verifier(directory.manifest_path());
+    plug::plugin plugin;
+    std::filesystem::path plugin_path = directory.concat_path();
+    plugin_path.replace_extension();
+    ASSERT_THROW(plugin.load_from_file(plugin_path, plug::plugin_load_options{ .integrity_verifier = &verifier }),
+                 plug::plugin_integrity_error);
+    ASSERT_FALSE(plugin.is_loaded());
+}
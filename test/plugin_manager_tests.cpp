@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/plugin_manager.hpp>
+
+#include <arba/plug/safe_plugin.hpp>
+
+#include <concat_interface/concat_interface.hpp>
+
+#include "test_helpers.hpp"
+
+std::filesystem::path concat_plugin_fpath = CONCAT_PLUGIN_PATH;
+std::filesystem::path strgen_plugin_fpath = STRGEN_PLUGIN_PATH;
+
+// Load
+
+TEST(PluginManagerTest, Load_ExistingLibraries_ExpectNoException)
+{
+    try
+    {
+        plug::plugin_manager manager;
+        plug::plugin& concat_plugin = manager.load("concat", concat_plugin_fpath);
+        manager.load("strgen", strgen_plugin_fpath);
+        ASSERT_TRUE(concat_plugin.is_loaded());
+        ASSERT_EQ(manager.size(), 2);
+        ASSERT_EQ(&manager.get("concat"), &concat_plugin);
+        ASSERT_EQ(manager.names(), (std::vector<std::string_view>{ "concat", "strgen" }));
+    }
+    catch (const std::exception& exception)
+    {
+        FAIL() << exception.what();
+    }
+}
+
+TEST(PluginManagerTest, Load_AlreadyUsedName_ExpectException)
+{
+    plug::plugin_manager manager;
+    manager.load("concat", concat_plugin_fpath);
+    ASSERT_THROW(manager.load("concat", strgen_plugin_fpath), std::invalid_argument);
+    ASSERT_EQ(manager.size(), 1);
+}
+
+TEST(PluginManagerTest, Load_UnfoundLibrary_ExpectException)
+{
+    plug::plugin_manager manager;
+    ASSERT_THROW(manager.load("unfound", std::filesystem::current_path() / "concat/libunfound"),
+                 plug::plugin_load_error);
+    ASSERT_TRUE(manager.empty());
+}
+
+TEST(PluginManagerTest, Load_SafePlugin_ExpectCheckedFunctions)
+{
+    plug::basic_plugin_manager<plug::safe_plugin> manager;
+    plug::safe_plugin& plugin = manager.load("concat", concat_plugin_fpath);
+    ASSERT_THROW(std::ignore = plugin.find_function_ptr<void (*)(float&)>("execute"), std::runtime_error);
+}
+
+// LoadAll
+
+TEST(PluginManagerTest, LoadAll_Dependencies_ExpectDependenciesLoadedFirst)
+{
+    plug::plugin_manager manager;
+    const std::vector<plug::plugin_load_spec> specs{
+        make_spec("app", concat_plugin_fpath, { "left", "right" }), make_spec("left", strgen_plugin_fpath, { "base" }),
+        make_spec("right", concat_plugin_fpath, { "base" }), make_spec("base", strgen_plugin_fpath)
+    };
+    manager.load_all(specs, 4);
+    ASSERT_EQ(manager.size(), 4);
+    const std::vector<std::string_view> names = manager.names();
+    const auto position = [&names](std::string_view name) { return std::ranges::find(names, name) - names.begin(); };
+    ASSERT_EQ(position("base"), 0);
+    ASSERT_EQ(position("app"), 3);
+    ASSERT_TRUE(manager.get("app").is_loaded());
+}
+
+TEST(PluginManagerTest, LoadAll_DependencyAlreadyManaged_ExpectNoException)
+{
+    plug::plugin_manager manager;
+    manager.load("base", strgen_plugin_fpath);
+    const std::vector<plug::plugin_load_spec> specs{ make_spec("app", concat_plugin_fpath, { "base" }) };
+    manager.load_all(specs, 1);
+    ASSERT_EQ(manager.names(), (std::vector<std::string_view>{ "base", "app" }));
+}
+
+TEST(PluginManagerTest, LoadAll_Cycle_ExpectExceptionAndNothingLoaded)
+{
+    plug::plugin_manager manager;
+    const std::vector<plug::plugin_load_spec> specs{ make_spec("a", concat_plugin_fpath, { "b" }),
+                                                     make_spec("b", strgen_plugin_fpath, { "a" }) };
+    ASSERT_THROW(manager.load_all(specs), std::invalid_argument);
+    ASSERT_TRUE(manager.empty());
+}
+
+TEST(PluginManagerTest, LoadAll_UnfoundLibrary_ExpectExceptionAndLoadedPluginsUnloaded)
+{
+    plug::plugin_manager manager;
+    manager.load("kept", strgen_plugin_fpath);
+    const std::vector<plug::plugin_load_spec> specs{
+        make_spec("base", concat_plugin_fpath), make_spec("unfound", std::filesystem::current_path() / "libunfound"),
+        make_spec("app", strgen_plugin_fpath, { "base", "unfound" })
+    };
+    ASSERT_THROW(manager.load_all(specs, 2), plug::plugin_load_error);
+    ASSERT_EQ(manager.names(), (std::vector<std::string_view>{ "kept" }));
+}
+
+// Unload & Get
+
+TEST(PluginManagerTest, Unload_ManagedName_ExpectPluginRemoved)
+{
+    plug::plugin_manager manager;
+    manager.load("concat", concat_plugin_fpath);
+    ASSERT_TRUE(manager.unload("concat"));
+    ASSERT_FALSE(manager.unload("concat"));
+    ASSERT_FALSE(manager.contains("concat"));
+    ASSERT_EQ(manager.find("concat"), nullptr);
+    ASSERT_THROW(std::ignore = manager.get("concat"), std::out_of_range);
+}
+
+// LoadReport
+
+TEST(PluginManagerTest, LoadReport_TwoPlugins_ReturnEntriesSortedByLoadDuration)
+{
+    plug::plugin_manager manager;
+    manager.load("concat", concat_plugin_fpath);
+    manager.load("strgen", strgen_plugin_fpath);
+    const std::vector<plug::plugin_load_report_entry> report = manager.load_report();
+    ASSERT_EQ(report.size(), 2);
+    ASSERT_GE(report[0].load_stats.load_duration, report[1].load_stats.load_duration);
+    for (const plug::plugin_load_report_entry& entry : report)
+    {
+        ASSERT_EQ(entry.plugin_path, manager.get(entry.name).plugin_path());
+        ASSERT_GT(entry.load_stats.load_duration.count(), 0);
+#if defined(__linux__)
+        ASSERT_GT(entry.load_stats.mapped_segment_count, 0);
+        ASSERT_GT(entry.load_stats.mapped_bytes, 0);
+#endif
+    }
+}
+
+// MemoryReport
+
+TEST(PluginManagerTest, MemoryReport_TwoPlugins_ReturnEntriesSortedByResidentBytes)
+{
+    plug::plugin_manager manager;
+    manager.load("concat", concat_plugin_fpath);
+    manager.load("strgen", strgen_plugin_fpath);
+    const std::vector<plug::plugin_memory_report_entry> report = manager.memory_report();
+    ASSERT_EQ(report.size(), 2);
+    ASSERT_GE(report[0].memory_footprint.resident_bytes(), report[1].memory_footprint.resident_bytes());
+#if defined(__linux__)
+    for (const plug::plugin_memory_report_entry& entry : report)
+        ASSERT_EQ(entry.memory_footprint.mapped_bytes(), manager.get(entry.name).load_stats().mapped_bytes);
+#endif
+}
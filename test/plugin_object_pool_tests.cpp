@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/plugin_object_pool.hpp>
+
+#include <arba/plug/plugin.hpp>
+#include <arba/plug/safe_plugin.hpp>
+
+#include <concat_interface/concat_interface.hpp>
+
+#include <thread>
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+using concat_pool = plug::plugin_object_pool<ConcatInterface, plug::plugin>;
+
+namespace
+{
+using count_function = int (*)();
+} // namespace
+
+// Constructors
+
+TEST(PluginObjectPoolTest, Constructor_ExistingFactory_ExpectNoException)
+{
+    try
+    {
+        plug::plugin plugin(plugin_fpath);
+        concat_pool pool(plugin);
+        ASSERT_TRUE(pool.has_reset_function());
+        ASSERT_EQ(pool.high_water_mark(), concat_pool::default_high_water_mark);
+        ASSERT_EQ(pool.local_size(), 0);
+    }
+    catch (const std::exception& exception)
+    {
+        FAIL() << exception.what();
+    }
+}
+
+TEST(PluginObjectPoolTest, Constructor_UnfoundResetFunction_ExpectNoResetFunction)
+{
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin, "make_unique_instance", "not_found_reset");
+    ASSERT_FALSE(pool.has_reset_function());
+}
+
+TEST(PluginObjectPoolTest, Constructor_UnfoundFactory_ExpectException)
+{
+    plug::plugin plugin(plugin_fpath);
+    ASSERT_THROW(concat_pool(plugin, "not_found_factory"), plug::plugin_find_symbol_error);
+}
+
+TEST(PluginObjectPoolTest, Constructor_SafePlugin_ExpectNoException)
+{
+    plug::safe_plugin plugin(plugin_fpath);
+    plug::plugin_object_pool<ConcatInterface, plug::safe_plugin> pool(plugin);
+    ASSERT_TRUE(pool.has_reset_function());
+    ASSERT_EQ(pool.acquire()->concat("a", "b"), "a-b");
+}
+
+// Acquire
+
+TEST(PluginObjectPoolTest, Acquire_AfterRelease_ReturnRecycledInstance)
+{
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin);
+    ConcatInterface* first_address = nullptr;
+    {
+        concat_pool::handle instance = pool.acquire();
+        ASSERT_EQ(instance->concat("a", "b"), "a-b");
+        first_address = instance.get();
+    }
+    ASSERT_EQ(pool.local_size(), 1);
+    concat_pool::handle instance = pool.acquire();
+    ASSERT_EQ(instance.get(), first_address);
+    ASSERT_EQ(pool.local_size(), 0);
+}
+
+TEST(PluginObjectPoolTest, Acquire_MoreThanHighWaterMark_ExpectBoundedFreeList)
+{
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin, "make_unique_instance", concat_pool::default_reset_func_name, 2);
+    {
+        concat_pool::handle first = pool.acquire();
+        concat_pool::handle second = pool.acquire();
+        concat_pool::handle third = pool.acquire();
+    }
+    ASSERT_EQ(pool.local_size(), 2);
+}
+
+TEST(PluginObjectPoolTest, Acquire_OtherThread_ExpectPerThreadFreeList)
+{
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin);
+    {
+        concat_pool::handle instance = pool.acquire();
+    }
+    ASSERT_EQ(pool.local_size(), 1);
+    std::size_t other_thread_size = 1;
+    std::thread thread([&] { other_thread_size = pool.local_size(); });
+    thread.join();
+    ASSERT_EQ(other_thread_size, 0);
+}
+
+TEST(PluginObjectPoolTest, Acquire_ReloadedPlugin_ExpectException)
+{
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin);
+    plugin.load_from_file(plugin_fpath);
+    ASSERT_THROW(std::ignore = pool.acquire(), plug::plugin_unloaded_error);
+}
+
+TEST(PluginObjectPoolTest, Release_ResetFunction_ExpectResetCalled)
+{
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin);
+    auto reset_instance_call_count = plugin.find_function_ptr<count_function>("reset_instance_call_count");
+    const int call_count = reset_instance_call_count();
+    {
+        concat_pool::handle first = pool.acquire();
+        concat_pool::handle second = pool.acquire();
+    }
+    ASSERT_EQ(reset_instance_call_count(), call_count + 2);
+}
+
+// Unload
+
+TEST(PluginObjectPoolTest, Unload_FreeInstances_ExpectInstancesDestroyed)
+{
+    // The other plugin keeps the library mapped, so its counter can be read after the unload.
+    plug::plugin other_plugin(plugin_fpath);
+    auto live_counted_instance_count = other_plugin.find_function_ptr<count_function>("live_counted_instance_count");
+    const int live_count = live_counted_instance_count();
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin, "make_counted_instance");
+    {
+        concat_pool::handle first = pool.acquire();
+        concat_pool::handle second = pool.acquire();
+    }
+    std::jthread([&pool] { std::ignore = pool.acquire(); }).join();
+    ASSERT_EQ(live_counted_instance_count(), live_count + 3);
+    plugin.unload();
+    ASSERT_EQ(live_counted_instance_count(), live_count);
+    ASSERT_EQ(pool.local_size(), 0);
+    ASSERT_THROW(std::ignore = pool.acquire(), plug::plugin_unloaded_error);
+}
+
+TEST(PluginObjectPoolTest, Release_AfterUnload_ExpectInstanceDropped)
+{
+    plug::plugin other_plugin(plugin_fpath);
+    auto live_counted_instance_count = other_plugin.find_function_ptr<count_function>("live_counted_instance_count");
+    const int live_count = live_counted_instance_count();
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin, "make_counted_instance");
+    concat_pool::handle instance = pool.acquire();
+    plugin.unload();
+    instance.reset();
+    ASSERT_EQ(live_counted_instance_count(), live_count + 1);
+    ASSERT_EQ(pool.local_size(), 0);
+}
+
+// Clear
+
+TEST(PluginObjectPoolTest, Clear_NominalCase_ExpectEmptyFreeList)
+{
+    plug::plugin plugin(plugin_fpath);
+    concat_pool pool(plugin);
+    {
+        concat_pool::handle instance = pool.acquire();
+    }
+    ASSERT_EQ(pool.local_size(), 1);
+    pool.clear();
+    ASSERT_EQ(pool.local_size(), 0);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/plugin_overlay.hpp>
+
+#include <array>
+
+#include "test_helpers.hpp"
+
+std::filesystem::path concat_plugin_fpath = CONCAT_PLUGIN_PATH;
+std::filesystem::path strgen_plugin_fpath = STRGEN_PLUGIN_PATH;
+
+namespace
+{
+using sum_function = int (*)(int, int);
+
+constexpr std::string_view shared_symbol_name = "arba_plug_safe_plugin_function_register_";
+
+// The overlay gives its plugins as const: their symbols are found with find_symbols().
+void* find_sum_pointer(const plug::plugin& plugin)
+{
+    constexpr std::array<std::string_view, 1> symbol_names{ "sum" };
+    std::array<void*, 1> symbol_pointers{};
+    plugin.find_symbols(symbol_names, symbol_pointers);
+    return symbol_pointers[0];
+}
+} // namespace
+
+TEST(PluginOverlayTest, FindSymbolPointer_DistinctSymbols_ExpectEachPluginSymbols)
+{
+    plug::plugin_overlay overlay;
+    const plug::plugin& concat = overlay.push_back("concat", concat_plugin_fpath);
+    const plug::plugin& strgen = overlay.push_back("strgen", strgen_plugin_fpath);
+    ASSERT_EQ(overlay.size(), 2);
+    ASSERT_GT(overlay.symbol_count(), 0);
+    ASSERT_EQ(reinterpret_cast<void*>(overlay.find_function_ptr<sum_function>("sum")), find_sum_pointer(concat));
+    ASSERT_EQ(overlay.find_provider("sum"), &concat);
+    ASSERT_EQ(overlay.find_provider("generate_str"), &strgen);
+    ASSERT_EQ(overlay.find_symbol_pointer("unknown_symbol"), nullptr);
+    ASSERT_EQ(overlay.find_provider("unknown_symbol"), nullptr);
+    ASSERT_THROW(std::ignore = overlay.find_function_ptr<sum_function>("unknown_symbol"),
+                 plug::plugin_find_symbol_error);
+}
+
+TEST(PluginOverlayTest, FindProvider_SharedSymbol_ExpectTopmostPlugin)
+{
+    plug::plugin_overlay overlay;
+    overlay.push_back("concat", concat_plugin_fpath);
+    const plug::plugin& strgen = overlay.push_back("strgen", strgen_plugin_fpath);
+    ASSERT_EQ(overlay.find_provider(shared_symbol_name), &strgen);
+}
+
+TEST(PluginOverlayTest, PushBack_OverridingPlugin_ExpectOverridingFunction)
+{
+    plug::plugin_overlay overlay;
+    overlay.push_back("base", concat_plugin_fpath);
+    const std::size_t symbol_count = overlay.symbol_count();
+    const plug::plugin& patch =
+        overlay.push_back("patch", make_plugin_copy(concat_plugin_fpath, "arba_plug_overlay_tests"));
+    ASSERT_EQ(overlay.symbol_count(), symbol_count);
+    ASSERT_EQ(overlay.find_provider("sum"), &patch);
+    ASSERT_EQ(overlay.find_symbol_pointer("sum"), find_sum_pointer(patch));
+    ASSERT_EQ(overlay.find_function_ptr<sum_function>("sum")(2, 3), 5);
+}
+
+TEST(PluginOverlayTest, Erase_OverridingPlugin_ExpectOverriddenFunctionBack)
+{
+    plug::plugin_overlay overlay;
+    const plug::plugin& base = overlay.push_back("base", concat_plugin_fpath);
+    overlay.push_back("patch", make_plugin_copy(concat_plugin_fpath, "arba_plug_overlay_tests"));
+    overlay.push_back("strgen", strgen_plugin_fpath);
+    ASSERT_TRUE(overlay.erase("patch"));
+    ASSERT_FALSE(overlay.erase("patch"));
+    ASSERT_EQ(overlay.find_provider("sum"), &base);
+    ASSERT_EQ(overlay.find_symbol_pointer("sum"), find_sum_pointer(base));
+    ASSERT_EQ(overlay.names(), (std::vector<std::string_view>{ "base", "strgen" }));
+    ASSERT_EQ(overlay.find_provider("generate_str"), overlay.find("strgen"));
+}
+
+TEST(PluginOverlayTest, Erase_OnlyProvider_ExpectSymbolRemoved)
+{
+    plug::plugin_overlay overlay;
+    const plug::plugin& concat = overlay.push_back("concat", concat_plugin_fpath);
+    overlay.push_back("strgen", strgen_plugin_fpath);
+    const std::size_t symbol_count = overlay.symbol_count();
+    ASSERT_TRUE(overlay.erase("strgen"));
+    ASSERT_EQ(overlay.find_symbol_pointer("generate_str"), nullptr);
+    ASSERT_EQ(overlay.find_provider(shared_symbol_name), &concat);
+    ASSERT_LT(overlay.symbol_count(), symbol_count);
+    ASSERT_NE(overlay.find_symbol_pointer("sum"), nullptr);
+}
+
+TEST(PluginOverlayTest, Clear_ExpectEmptyIndex)
+{
+    plug::plugin_overlay overlay;
+    overlay.push_back("concat", concat_plugin_fpath);
+    overlay.push_back("strgen", strgen_plugin_fpath);
+    overlay.clear();
+    ASSERT_TRUE(overlay.empty());
+    ASSERT_EQ(overlay.symbol_count(), 0);
+    ASSERT_EQ(overlay.find_symbol_pointer("sum"), nullptr);
+}
+
+TEST(PluginOverlayTest, PushBack_SameName_ExpectException)
+{
+    plug::plugin_overlay overlay;
+    overlay.push_back("concat", concat_plugin_fpath);
+    ASSERT_THROW(overlay.push_back("concat", strgen_plugin_fpath), std::invalid_argument);
+    ASSERT_EQ(overlay.size(), 1);
+}
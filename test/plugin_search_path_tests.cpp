@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/plugin_search_path.hpp>
+
+#include <arba/plug/plugin.hpp>
+
+#include <format>
+
+#include "test_helpers.hpp"
+
+std::filesystem::path concat_plugin_fpath = CONCAT_PLUGIN_PATH;
+std::filesystem::path strgen_plugin_fpath = STRGEN_PLUGIN_PATH;
+
+namespace
+{
+using sum_function = int (*)(int, int);
+
+// An empty directory, removed at the end of the test.
+class temporary_directory
+{
+public:
+    explicit temporary_directory(std::string_view name)
+        : path_(std::filesystem::temp_directory_path() / "arba_plug_search_path_tests" / name)
+    {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+
+    ~temporary_directory() { std::filesystem::remove_all(path_); }
+
+    const std::filesystem::path& path() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+std::string plugin_name(const std::filesystem::path& plugin_path)
+{
+    return plugin_path.filename().string();
+}
+} // namespace
+
+TEST(PluginSearchPathTest, Find_NameWithOrWithoutExtension_ExpectPluginFile)
+{
+    temporary_directory directory("find");
+    const std::filesystem::path concat_path = copy_plugin(concat_plugin_fpath, directory.path());
+    plug::plugin_search_path search_path({ directory.path() });
+    ASSERT_EQ(search_path.plugin_count(), 1);
+    ASSERT_EQ(search_path.find(plugin_name(concat_plugin_fpath)), concat_path);
+    ASSERT_EQ(search_path.find(plugin_name(concat_path)), concat_path);
+    ASSERT_EQ(search_path.find(plugin_name(strgen_plugin_fpath)), std::nullopt);
+    plug::plugin plugin(search_path.resolve(plugin_name(concat_plugin_fpath)));
+    ASSERT_EQ(plugin.find_function_ptr<sum_function>("sum")(1, 2), 3);
+}
+
+TEST(PluginSearchPathTest, Find_SeveralDirectories_ExpectFirstDirectoryWins)
+{
+    temporary_directory first_directory("first");
+    temporary_directory second_directory("second");
+    const std::filesystem::path first_path = copy_plugin(concat_plugin_fpath, first_directory.path());
+    copy_plugin(concat_plugin_fpath, second_directory.path());
+    const std::filesystem::path strgen_path = copy_plugin(strgen_plugin_fpath, second_directory.path());
+    const std::string directory_list = std::format("{}{}{}", first_directory.path().string(),
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+                                                   ";;",
+#else
+                                                   "::",
+#endif
+                                                   second_directory.path().string());
+    plug::plugin_search_path search_path(directory_list);
+    ASSERT_EQ(search_path.directories().size(), 2);
+    ASSERT_EQ(search_path.plugin_count(), 2);
+    ASSERT_EQ(search_path.find(plugin_name(concat_plugin_fpath)), first_path);
+    ASSERT_EQ(search_path.find(plugin_name(strgen_plugin_fpath)), strgen_path);
+}
+
+TEST(PluginSearchPathTest, Resolve_MissingPlugin_ExpectExceptionWithoutReindex)
+{
+    temporary_directory directory("missing");
+    plug::plugin_search_path search_path({ directory.path(), directory.path() / "not_a_directory" });
+    for (int i = 0; i < 3; ++i)
+        ASSERT_THROW(std::ignore = search_path.resolve("optional_plugin"), plug::plugin_load_error);
+    ASSERT_EQ(search_path.index_build_count(), 1);
+}
+
+TEST(PluginSearchPathTest, Find_PathWithDirectory_ExpectPathAsIs)
+{
+    plug::plugin_search_path search_path(std::vector<std::filesystem::path>{});
+    const std::string plugin_path = concat_plugin_fpath.generic_string();
+    ASSERT_EQ(search_path.find(plugin_path), std::filesystem::path(plugin_path));
+}
+
+TEST(PluginSearchPathTest, Refresh_AddedPlugin_ExpectPluginFound)
+{
+    temporary_directory directory("refresh");
+    plug::plugin_search_path search_path({ directory.path() });
+    ASSERT_EQ(search_path.find(plugin_name(concat_plugin_fpath)), std::nullopt);
+    const std::filesystem::path concat_path = copy_plugin(concat_plugin_fpath, directory.path());
+    search_path.refresh();
+    ASSERT_EQ(search_path.find(plugin_name(concat_plugin_fpath)), concat_path);
+}
+
+#if defined(__linux__)
+TEST(PluginSearchPathTest, Find_ChangedDirectory_ExpectIndexRebuilt)
+{
+    temporary_directory directory("watch");
+    plug::plugin_search_path search_path({ directory.path() });
+    ASSERT_EQ(search_path.find(plugin_name(concat_plugin_fpath)), std::nullopt);
+    const std::filesystem::path concat_path = copy_plugin(concat_plugin_fpath, directory.path());
+    ASSERT_EQ(search_path.find(plugin_name(concat_plugin_fpath)), concat_path);
+    ASSERT_EQ(search_path.index_build_count(), 2);
+    ASSERT_EQ(search_path.find(plugin_name(concat_plugin_fpath)), concat_path);
+    ASSERT_EQ(search_path.index_build_count(), 2);
+    std::filesystem::remove(concat_path);
+    ASSERT_EQ(search_path.find(plugin_name(concat_plugin_fpath)), std::nullopt);
+    ASSERT_EQ(search_path.plugin_count(), 0);
+}
+#endif
@@ -3,8 +3,11 @@
 // class to test
 #include <arba/plug/plugin.hpp>
 
+#include <concat_interface/concat_function_table.hpp>
 #include <concat_interface/concat_interface.hpp>
 
+#include <algorithm>
+#include <array>
 #include <format>
 
 std::filesystem::path plugin_fpath = PLUGIN_PATH;
@@ -88,6 +91,16 @@ TEST(PluginTest, LoadFromFile_ExistingLibraryNoExtension_ExpectNoException)
     }
 }
 
+TEST(PluginTest, LoadFromFile_AlreadyLoaded_ExpectReload)
+{
+    plug::plugin plugin(plugin_fpath);
+    plugin.load_from_file(plugin_fpath);
+    ASSERT_TRUE(plugin.is_loaded());
+    std::string res;
+    plugin.find_function_ptr<void (*)(std::string&, std::string_view, const std::string&)>("execute")(res, "a", "b");
+    ASSERT_EQ(res, "a-b");
+}
+
 TEST(PluginTest, LoadFromFile_UnfoundLibrary_ExpectException)
 {
     std::filesystem::path lib_path = std::filesystem::current_path() / "concat/libunfound";
@@ -109,6 +122,80 @@ TEST(PluginTest, LoadFromFile_UnfoundLibrary_ExpectException)
     }
 }
 
+// RemapTextToHugePages
+
+TEST(PluginTest, Constructor_RemapTextToHugePagesOption_ExpectWorkingPlugin)
+{
+    plug::plugin plugin(plugin_fpath, plug::plugin_load_options{ .remap_text_to_huge_pages = true });
+    ASSERT_LE(plugin.load_stats().huge_page_text_bytes, plugin.load_stats().mapped_bytes);
+    std::string res;
+    plugin.find_function_ptr<void (*)(std::string&, std::string_view, const std::string&)>("execute")(res, "a", "b");
+    ASSERT_EQ(res, "a-b");
+}
+
+// WarmUp
+
+TEST(PluginTest, Constructor_WarmUpOption_ExpectWarmUpFunctionCalled)
+{
+    plug::plugin plugin(plugin_fpath, plug::plugin_load_options{ .warm_up = true });
+    ASSERT_TRUE(plugin.find_function_ptr<bool (*)()>("is_warmed_up")());
+    ASSERT_GT(plugin.load_stats().warm_up_duration.count(), 0);
+}
+
+TEST(PluginTest, WarmUp_DefaultWarmUpFunction_ExpectWarmUpFunctionCalled)
+{
+    plug::plugin plugin(plugin_fpath);
+    std::ignore = plugin.warm_up();
+    ASSERT_TRUE(plugin.find_function_ptr<bool (*)()>("is_warmed_up")());
+}
+
+TEST(PluginTest, WarmUp_UnfoundWarmUpFunction_ExpectNoException)
+{
+    try
+    {
+        plug::plugin plugin(plugin_fpath);
+        ASSERT_EQ(plugin.load_stats().warm_up_duration.count(), 0);
+        const std::chrono::nanoseconds duration = plugin.warm_up("unfound_warmup");
+        ASSERT_EQ(duration, plugin.load_stats().warm_up_duration);
+    }
+    catch (const std::exception& exception)
+    {
+        FAIL() << exception.what();
+    }
+}
+
+// LoadStats
+
+TEST(PluginTest, LoadStats_LoadedLibrary_ReturnLoadCost)
+{
+    plug::plugin plugin(plugin_fpath);
+    const plug::plugin_load_stats& stats = plugin.load_stats();
+    ASSERT_GT(stats.load_duration.count(), 0);
+#if defined(__linux__)
+    ASSERT_GT(stats.mapped_segment_count, 0);
+    ASSERT_GE(stats.mapped_bytes, stats.mapped_segment_count);
+#endif
+    plugin.unload();
+    ASSERT_EQ(plugin.load_stats().load_duration.count(), 0);
+}
+
+// MemoryFootprint
+
+TEST(PluginTest, MemoryFootprint_LoadedLibrary_ReturnSegmentFootprints)
+{
+    plug::plugin plugin(plugin_fpath);
+    std::string res;
+    plugin.find_function_ptr<void (*)(std::string&, std::string_view, const std::string&)>("execute")(res, "a", "b");
+    const plug::plugin_memory_footprint footprint = plugin.memory_footprint();
+#if defined(__linux__)
+    ASSERT_EQ(footprint.segments.size(), plugin.load_stats().mapped_segment_count);
+    ASSERT_EQ(footprint.mapped_bytes(), plugin.load_stats().mapped_bytes);
+    ASSERT_GT(footprint.resident_bytes(), 0);
+    ASSERT_LE(footprint.resident_bytes(), footprint.mapped_bytes());
+    ASSERT_TRUE(std::ranges::any_of(footprint.segments, &plug::segment_footprint::executable));
+#endif
+}
+
 // Unload
 
 TEST(PluginTest, Unload_NomicalCase_ExpectNoException)
@@ -159,6 +246,95 @@ TEST(PluginTest, FindFunctionPtr_FunctionName_ExpectException)
     }
 }
 
+TEST(PluginTest, FindFunctionPtr_NotLoaded_ExpectException)
+{
+    plug::plugin plugin;
+    ASSERT_THROW(std::ignore = plugin.find_function_ptr<void (*)()>("execute"), plug::plugin_find_symbol_error);
+}
+
+// FindSymbols
+
+TEST(PluginTest, FindSymbols_ExistingSymbols_ReturnSameAddressesAsFindFunctionPtr)
+{
+    plug::plugin plugin(plugin_fpath);
+    const std::array<std::string_view, 3> names{ "execute", "default_concat", "make_unique_instance" };
+    std::array<void*, 3> pointers{};
+    plugin.find_symbols(names, pointers);
+    ASSERT_EQ(pointers[0], reinterpret_cast<void*>(plugin.find_function_ptr<void (*)()>("execute")));
+    ASSERT_EQ(pointers[1], reinterpret_cast<void*>(plugin.find_function_ptr<void (*)()>("default_concat")));
+    ASSERT_EQ(pointers[2], reinterpret_cast<void*>(plugin.find_function_ptr<void (*)()>("make_unique_instance")));
+}
+
+TEST(PluginTest, FindSymbols_MissingSymbols_ExpectExceptionListingAllMissingSymbols)
+{
+    plug::plugin plugin(plugin_fpath);
+    const std::array<std::string_view, 4> names{ "not_found_1", "execute", "not_found_2", "exec" };
+    std::array<void*, 4> pointers{};
+    try
+    {
+        plugin.find_symbols(names, pointers);
+        FAIL();
+    }
+    catch (const plug::plugin_find_symbol_error& exception)
+    {
+        std::string msg(exception.what());
+        ASSERT_EQ(msg.find("Exception occurred while looking for address of symbols"), 0);
+        ASSERT_NE(msg.find("not_found_1, not_found_2, exec"), std::string::npos);
+    }
+    ASSERT_EQ(pointers[0], nullptr);
+    ASSERT_NE(pointers[1], nullptr);
+    ASSERT_EQ(pointers[2], nullptr);
+    ASSERT_EQ(pointers[3], nullptr);
+}
+
+TEST(PluginTest, FindSymbols_SymbolOfDependency_ReturnDlsymAddress)
+{
+    plug::plugin plugin(plugin_fpath);
+    const std::array<std::string_view, 1> names{ "malloc" };
+    std::array<void*, 1> pointers{};
+    plugin.find_symbols(names, pointers);
+    ASSERT_NE(pointers[0], nullptr);
+}
+
+// FindFunctionTable
+
+namespace other_version
+{
+#define OTHER_CONCAT_FUNCTION_TABLE_FUNCTIONS(ENTRY)                                                                   \
+    ENTRY(execute, void (*)(std::string&, std::string_view, const std::string&))
+
+ARBA_PLUG_DECLARE_FUNCTION_TABLE(concat_function_table, 2, OTHER_CONCAT_FUNCTION_TABLE_FUNCTIONS)
+} // namespace other_version
+
+TEST(PluginTest, FindFunctionTable_TableExists_ReturnTableOfPluginFunctions)
+{
+    plug::plugin plugin(plugin_fpath);
+    const concat_function_table& functions = plugin.find_function_table<concat_function_table>();
+    ASSERT_EQ(functions.execute, plugin.find_function_ptr<decltype(functions.execute)>("execute"));
+    std::string res;
+    functions.execute(res, "a", "b");
+    ASSERT_EQ(res, "a-b");
+    std::unique_ptr<ConcatInterface> instance = functions.make_unique_instance();
+    ASSERT_EQ(instance->concat("a", "b"), "a-b");
+    ASSERT_EQ(&functions.default_concat(), &plugin.instance_ref<ConcatInterface>("default_concat"));
+}
+
+TEST(PluginTest, FindFunctionTable_OtherTableVersion_ExpectException)
+{
+    static_assert(other_version::concat_function_table::signature_hash != concat_function_table::signature_hash);
+    plug::plugin plugin(plugin_fpath);
+    try
+    {
+        std::ignore = plugin.find_function_table<other_version::concat_function_table>();
+        FAIL();
+    }
+    catch (const std::runtime_error& err)
+    {
+        ASSERT_EQ(std::string_view(err.what()), "Function table 'concat_function_table' of plugin (version 1) is not "
+                                                "the requested function table (version 2).");
+    }
+}
+
 // MakeUniqueInstance
 
 TEST(PluginTest, MakeUniqueInstance_FunctionExists_ReturnUniquePtr)
@@ -218,6 +394,45 @@ TEST(PluginTest, MakeSharedInstance_FunctionTakingArgsExists_ReturnSharedPtr)
     ASSERT_EQ(b, "((");
 }
 
+// MakeInstances
+
+TEST(PluginTest, MakeInstances_BatchMakerExists_ReturnContiguousInstances)
+{
+    plug::plugin plugin(plugin_fpath);
+    plug::instance_batch<ConcatInterface> batch = plugin.make_instances<ConcatInterface>(3);
+    ASSERT_EQ(batch.size(), 3);
+    for (const ConcatInterface* instance : batch.instances())
+        ASSERT_EQ(instance->concat("a", "b"), "a-b");
+    const std::byte* first = reinterpret_cast<const std::byte*>(&batch[0]);
+    const std::byte* second = reinterpret_cast<const std::byte*>(&batch[1]);
+    const std::byte* third = reinterpret_cast<const std::byte*>(&batch[2]);
+    ASSERT_EQ(third - second, second - first);
+}
+
+TEST(PluginTest, MakeInstances_BatchMakerNotFound_ReturnInstancesMadeOneByOne)
+{
+    plug::plugin plugin(plugin_fpath);
+    plug::instance_batch<ConcatInterface> batch = plugin.make_instances<ConcatInterface>(3, "not_found_batch_maker");
+    ASSERT_EQ(batch.size(), 3);
+    for (const ConcatInterface* instance : batch.instances())
+        ASSERT_EQ(instance->concat("a", "b"), "a-b");
+}
+
+TEST(PluginTest, MakeInstances_BatchMakerTakingArgsExists_ReturnInstances)
+{
+    plug::plugin plugin(plugin_fpath);
+    std::shared_ptr<ConcatInterface> instance;
+    {
+        plug::instance_batch<ConcatInterface> batch =
+            plugin.make_instances<ConcatInterface, std::string_view, std::string_view>(
+                2, "make_instances_from_args", "make_unique_instance", "(", ")");
+        ASSERT_EQ(batch.size(), 2);
+        ASSERT_EQ(batch[0].concat("a", "b"), "(a-b)");
+        instance = batch.shared_instance(1);
+    }
+    ASSERT_EQ(instance->concat("a", "b"), "(a-b)");
+}
+
 // InstanceRef & InstanceCref
 
 TEST(PluginTest, InstanceRef_FunctionExists_ReturnTypeRef)
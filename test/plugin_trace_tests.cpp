@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/plugin_trace.hpp>
+
+#include <arba/plug/plugin.hpp>
+#include <concat_interface/concat_interface.hpp>
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+namespace
+{
+using sum_function = int (*)(int, int);
+
+const plug::trace_event* find_event(const std::vector<plug::trace_event>& events, std::string_view category,
+                                    std::string_view name)
+{
+    auto iter = std::ranges::find_if(events, [&](const plug::trace_event& event) {
+        return event.category == category && event.name == name;
+    });
+    return iter != events.end() ? &*iter : nullptr;
+}
+} // namespace
+
+TEST(PluginTraceTest, Trace_NotStarted_ExpectNoEvent)
+{
+    plug::stop_tracing();
+    plug::clear_trace();
+    plug::plugin plugin(plugin_fpath);
+    ASSERT_EQ(plugin.find_function_ptr<sum_function>("sum")(1, 1), 2);
+    plugin.unload();
+    ASSERT_FALSE(plug::is_tracing());
+    ASSERT_TRUE(plug::snapshot_trace().empty());
+}
+
+TEST(PluginTraceTest, Trace_PluginActivity_ExpectEvents)
+{
+    plug::clear_trace();
+    plug::start_tracing();
+    {
+        plug::plugin plugin(plugin_fpath);
+        ASSERT_EQ(plugin.find_function_ptr<sum_function>("sum")(1, 2), 3);
+        std::unique_ptr<ConcatInterface> instance = plugin.make_unique_instance<ConcatInterface>();
+        ASSERT_NE(instance, nullptr);
+        instance.reset();
+        plugin.unload();
+    }
+    plug::stop_tracing();
+    const std::vector<plug::trace_event> events = plug::snapshot_trace();
+
+    const plug::trace_event* load_event = find_event(events, "load", "load_from_file");
+    ASSERT_NE(load_event, nullptr);
+    ASSERT_EQ(load_event->argument, plugin_fpath.generic_string());
+    const plug::trace_event* symbol_event = find_event(events, "symbol", "find_symbol_pointer");
+    ASSERT_NE(symbol_event, nullptr);
+    ASSERT_EQ(symbol_event->argument, "sum");
+    const plug::trace_event* factory_event = find_event(events, "factory", "make_unique_instance");
+    ASSERT_NE(factory_event, nullptr);
+    ASSERT_EQ(factory_event->argument, "make_unique_instance");
+    const plug::trace_event* unload_event = find_event(events, "unload", "unload");
+    ASSERT_NE(unload_event, nullptr);
+    ASSERT_GE(unload_event->start, load_event->start + load_event->duration);
+
+    plug::plugin plugin(plugin_fpath);
+    ASSERT_EQ(plug::snapshot_trace().size(), events.size());
+}
+
+TEST(PluginTraceTest, Trace_ManyEvents_ExpectAllEventsInOrder)
+{
+    constexpr std::size_t event_count = 3000;
+    plug::clear_trace();
+    plug::start_tracing();
+    for (std::size_t i = 0; i < event_count; ++i)
+        plug::trace_scope trace("test", "step", std::to_string(i % 10));
+    plug::stop_tracing();
+    const std::vector<plug::trace_event> events = plug::snapshot_trace();
+    ASSERT_EQ(events.size(), event_count);
+    for (std::size_t i = 0; i < event_count; ++i)
+        ASSERT_EQ(events[i].argument, std::to_string(i % 10));
+    ASSERT_TRUE(std::ranges::is_sorted(events, {}, &plug::trace_event::start));
+}
+
+TEST(PluginTraceTest, Trace_SeveralThreads_ExpectOneThreadIndexByThread)
+{
+    constexpr std::size_t thread_count = 4;
+    constexpr std::size_t event_count = 100;
+    plug::clear_trace();
+    plug::start_tracing();
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0; i < thread_count; ++i)
+            threads.emplace_back([] {
+                for (std::size_t j = 0; j < event_count; ++j)
+                    plug::trace_scope trace("test", "step");
+            });
+    }
+    plug::stop_tracing();
+    const std::vector<plug::trace_event> events = plug::snapshot_trace();
+    ASSERT_EQ(events.size(), thread_count * event_count);
+    std::set<std::uint32_t> thread_indexes;
+    for (const plug::trace_event& event : events)
+        thread_indexes.insert(event.thread_index);
+    ASSERT_EQ(thread_indexes.size(), thread_count);
+    plug::clear_trace();
+    ASSERT_TRUE(plug::snapshot_trace().empty());
+}
+
+TEST(PluginTraceTest, Trace_SameArgumentInSeveralThreads_ExpectSameInternedString)
+{
+    const std::filesystem::path path = "a//b/c";
+    plug::clear_trace();
+    plug::start_tracing();
+    {
+        plug::trace_scope trace("test", "step", path);
+    }
+    std::jthread([&path] {
+        for (int i = 0; i < 2; ++i)
+            plug::trace_scope trace("test", "step", path);
+    }).join();
+    plug::stop_tracing();
+    const std::vector<plug::trace_event> events = plug::snapshot_trace();
+    ASSERT_EQ(events.size(), 3);
+    for (const plug::trace_event& event : events)
+    {
+        ASSERT_EQ(event.argument, path.generic_string());
+        ASSERT_EQ(event.argument.data(), events.front().argument.data());
+    }
+}
+
+TEST(PluginTraceTest, WriteChromeTrace_Events_ExpectChromeTraceJson)
+{
+    plug::clear_trace();
+    plug::start_tracing();
+    {
+        plug::trace_scope trace("test", "quoted", "a \"quoted\"\\path");
+    }
+    plug::stop_tracing();
+    std::ostringstream stream;
+    plug::write_chrome_trace(stream);
+    const std::string trace = stream.str();
+    ASSERT_TRUE(trace.starts_with("{\"traceEvents\":["));
+    ASSERT_NE(trace.find("\"ph\":\"M\""), std::string::npos);
+    ASSERT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+    ASSERT_NE(trace.find("\"cat\":\"test\",\"name\":\"quoted\""), std::string::npos);
+    ASSERT_NE(trace.find(R"("args":{"detail":"a \"quoted\"\\path"})"), std::string::npos);
+    ASSERT_THROW(plug::write_chrome_trace(std::filesystem::path("/not/a/directory/trace.json")), std::runtime_error);
+}
+
+#ifdef ARBA_PLUG_ENABLE_INSTRUMENTATION
+TEST(PluginTraceTest, Trace_BoundFunctionCalls_ExpectCallEvents)
+{
+    plug::plugin plugin(plugin_fpath);
+    auto sum = plugin.bind_function<sum_function>("sum");
+    plug::clear_trace();
+    plug::start_tracing();
+    ASSERT_EQ(sum(2, 3), 5);
+    plug::stop_tracing();
+    ASSERT_EQ(sum(2, 3), 5);
+    const std::vector<plug::trace_event> events = plug::snapshot_trace();
+    ASSERT_EQ(events.size(), 1);
+    ASSERT_EQ(events.front().category, "call");
+    ASSERT_EQ(events.front().name, "sum");
+}
+#endif
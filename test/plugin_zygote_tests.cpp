@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/plugin_zygote.hpp>
+
+#include <unistd.h>
+
+std::filesystem::path concat_plugin_fpath = CONCAT_PLUGIN_PATH;
+std::filesystem::path strgen_plugin_fpath = STRGEN_PLUGIN_PATH;
+
+namespace
+{
+using sum_function = int (*)(int, int);
+using hook_call_count_function = int (*)();
+
+std::vector<plug::plugin_load_spec> make_specs()
+{
+    std::vector<plug::plugin_load_spec> specs(2);
+    specs[0].name = "concat";
+    specs[0].plugin_path = concat_plugin_fpath;
+    specs[0].dependencies = { "strgen" };
+    specs[1].name = "strgen";
+    specs[1].plugin_path = strgen_plugin_fpath;
+    return specs;
+}
+} // namespace
+
+TEST(PluginZygoteTest, Constructor_Specs_ExpectPluginsLoadedAndInitialized)
+{
+    plug::plugin_zygote zygote(make_specs());
+    ASSERT_EQ(zygote.manager().names(), (std::vector<std::string_view>{ "strgen", "concat" }));
+    ASSERT_TRUE(zygote.manager().get("concat").is_initialized());
+    ASSERT_TRUE(zygote.manager().get("strgen").is_initialized());
+}
+
+TEST(PluginZygoteTest, ForkWorker_CallPluginFunction_ExpectExitCode)
+{
+    plug::plugin_zygote zygote(make_specs());
+    const int worker_id = zygote.fork_worker([](plug::plugin_manager& manager) {
+        auto sum = manager.get("concat").find_function_ptr<sum_function>("sum");
+        return sum(20, 22);
+    });
+    ASSERT_EQ(zygote.worker_ids(), std::vector<int>{ worker_id });
+    ASSERT_EQ(zygote.wait_worker(worker_id), 42);
+    ASSERT_TRUE(zygote.worker_ids().empty());
+    ASSERT_THROW(std::ignore = zygote.wait_worker(worker_id), std::invalid_argument);
+}
+
+TEST(PluginZygoteTest, ForkWorker_Exception_ExpectExitCodeOne)
+{
+    plug::plugin_zygote zygote(make_specs());
+    const int worker_id =
+        zygote.fork_worker([](plug::plugin_manager&) -> int { throw std::runtime_error("worker failure"); });
+    ASSERT_EQ(zygote.wait_worker(worker_id), 1);
+}
+
+TEST(PluginZygoteTest, ForkWorker_NonStandardException_ExpectExitCodeOne)
+{
+    plug::plugin_zygote zygote(make_specs());
+    const int worker_id = zygote.fork_worker([](plug::plugin_manager&) -> int { throw 42; });
+    ASSERT_EQ(zygote.wait_worker(worker_id), 1);
+}
+
+TEST(PluginZygoteTest, ForkWorker_InheritedInitialization_ExpectLoadHookNotCalledAgain)
+{
+    plug::plugin_zygote zygote(make_specs());
+    auto load_hook_call_count =
+        zygote.manager().get("concat").find_function_ptr<hook_call_count_function>("load_hook_call_count");
+    const int worker_id = zygote.fork_worker([load_hook_call_count](plug::plugin_manager& manager) {
+        return manager.get("concat").initialize() ? 100 : load_hook_call_count();
+    });
+    ASSERT_EQ(zygote.wait_worker(worker_id), load_hook_call_count());
+}
+
+TEST(PluginZygoteTest, ForkWorker_UnloadAndReload_ExpectSuccess)
+{
+    plug::plugin_zygote zygote(make_specs());
+    // The background close starts the reaper thread, which the worker does not inherit.
+    plug::plugin extra(concat_plugin_fpath);
+    extra.unload_in_background();
+    const int worker_id = zygote.fork_worker([](plug::plugin_manager& manager) {
+        manager.unload("concat");
+        plug::plugin concat(concat_plugin_fpath);
+        auto sum = concat.find_function_ptr<sum_function>("sum");
+        concat.unload_in_background();
+        plug::wait_for_background_unloads();
+        return sum == nullptr ? 1 : 0;
+    });
+    ASSERT_EQ(zygote.wait_worker(worker_id), 0);
+    plug::wait_for_background_unloads();
+}
+
+TEST(PluginZygoteTest, MemoryReport_RunningWorker_ExpectSharedBytes)
+{
+    plug::plugin_zygote zygote(make_specs());
+    std::array<int, 2> ready_pipe;
+    std::array<int, 2> release_pipe;
+    ASSERT_EQ(pipe(ready_pipe.data()), 0);
+    ASSERT_EQ(pipe(release_pipe.data()), 0);
+    const int worker_id = zygote.fork_worker([&ready_pipe, &release_pipe](plug::plugin_manager&) {
+        char byte = 0;
+        const bool synchronized = write(ready_pipe[1], &byte, 1) == 1 && read(release_pipe[0], &byte, 1) == 1;
+        return synchronized ? 0 : 1;
+    });
+    char byte = 0;
+    ASSERT_EQ(read(ready_pipe[0], &byte, 1), 1);
+
+    const std::vector<plug::plugin_sharing_report_entry> report = zygote.memory_report(worker_id);
+    ASSERT_EQ(write(release_pipe[1], &byte, 1), 1);
+    ASSERT_EQ(zygote.wait_worker(worker_id), 0);
+    for (int fd : { ready_pipe[0], ready_pipe[1], release_pipe[0], release_pipe[1] })
+        close(fd);
+
+    ASSERT_EQ(report.size(), 2);
+    ASSERT_EQ(report[1].name, "concat");
+    ASSERT_EQ(report[1].plugin_path, zygote.manager().get("concat").plugin_path());
+#if defined(__linux__)
+    ASSERT_GT(report[1].memory_sharing.shared_bytes, 0);
+#endif
+}
@@ -272,6 +272,16 @@ TEST(SafePluginTest, MakeSharedInstance_FunctionTakingArgsExists_ReturnSharedPtr
     ASSERT_EQ(b, "((");
 }
 
+// MakeInstances
+
+TEST(SafePluginTest, MakeInstances_BatchMakerExists_ReturnInstances)
+{
+    plug::safe_plugin plugin(plugin_fpath);
+    plug::instance_batch<ConcatInterface> batch = plugin.make_instances<ConcatInterface>(3);
+    ASSERT_EQ(batch.size(), 3);
+    ASSERT_EQ(batch[2].concat("a", "b"), "a-b");
+}
+
 // InstanceRef & InstanceCref
 
 TEST(SafePluginTest, InstanceRef_FunctionExists_ReturnTypeRef)
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/service_registry.hpp>
+
+#include <arba/plug/plugin.hpp>
+#include <concat_interface/concat_interface.hpp>
+
+#include "test_helpers.hpp"
+
+std::filesystem::path concat_plugin_fpath = CONCAT_PLUGIN_PATH;
+std::filesystem::path strgen_plugin_fpath = STRGEN_PLUGIN_PATH;
+
+namespace
+{
+class UnprovidedInterface
+{
+public:
+    virtual ~UnprovidedInterface() = default;
+};
+} // namespace
+
+TEST(ServiceRegistryTest, ServiceId_ExpectCompileTimeDistinctIds)
+{
+    static_assert(plug::service_id<ConcatInterface>() != plug::service_id<UnprovidedInterface>());
+    ASSERT_EQ(plug::service_id<ConcatInterface>(), plug::service_id<ConcatInterface>());
+}
+
+TEST(ServiceRegistryTest, Add_PluginWithServices_ExpectProviders)
+{
+    plug::plugin concat(concat_plugin_fpath);
+    plug::service_registry registry;
+    ASSERT_EQ(registry.add(concat), 1);
+    ASSERT_EQ(registry.plugin_count(), 1);
+    ASSERT_EQ(registry.interface_count(), 1);
+    const std::span<const plug::service_provider> providers = registry.providers<ConcatInterface>();
+    ASSERT_EQ(providers.size(), 1);
+    ASSERT_EQ(providers.front().plugin, &concat);
+    ASSERT_EQ(providers.front().interface_name, "ConcatInterface");
+    ASSERT_EQ(registry.make_shared_instance<ConcatInterface>()->concat("a", "b"), "a-b");
+}
+
+TEST(ServiceRegistryTest, Add_PluginWithoutServices_ExpectNoProvider)
+{
+    plug::plugin strgen(strgen_plugin_fpath);
+    plug::service_registry registry;
+    ASSERT_EQ(registry.add(strgen), 0);
+    ASSERT_EQ(registry.plugin_count(), 1);
+    ASSERT_TRUE(registry.providers<ConcatInterface>().empty());
+    ASSERT_THROW(std::ignore = registry.make_shared_instance<ConcatInterface>(), std::out_of_range);
+}
+
+TEST(ServiceRegistryTest, Add_SamePluginTwice_ExpectException)
+{
+    plug::plugin concat(concat_plugin_fpath);
+    plug::service_registry registry;
+    registry.add(concat);
+    ASSERT_THROW(registry.add(concat), std::invalid_argument);
+    ASSERT_EQ(registry.providers<ConcatInterface>().size(), 1);
+}
+
+TEST(ServiceRegistryTest, MakeSharedInstances_SeveralProviders_ExpectOneInstancePerProvider)
+{
+    plug::plugin concat(concat_plugin_fpath);
+    plug::plugin concat_copy(make_plugin_copy(concat_plugin_fpath, "arba_plug_service_registry_tests"));
+    plug::plugin strgen(strgen_plugin_fpath);
+    plug::service_registry registry;
+    registry.add(concat);
+    registry.add(strgen);
+    registry.add(concat_copy);
+    const std::span<const plug::service_provider> providers = registry.providers<ConcatInterface>();
+    ASSERT_EQ(providers.size(), 2);
+    ASSERT_EQ(providers[0].plugin, &concat);
+    ASSERT_EQ(providers[1].plugin, &concat_copy);
+    const std::vector<std::shared_ptr<ConcatInterface>> instances = registry.make_shared_instances<ConcatInterface>();
+    ASSERT_EQ(instances.size(), 2);
+    for (const std::shared_ptr<ConcatInterface>& instance : instances)
+        ASSERT_EQ(instance->concat("x", "y"), "x-y");
+    ASSERT_TRUE(registry.providers<UnprovidedInterface>().empty());
+}
+
+TEST(ServiceRegistryTest, Remove_Provider_ExpectOtherProvidersKept)
+{
+    plug::plugin concat(concat_plugin_fpath);
+    plug::plugin concat_copy(make_plugin_copy(concat_plugin_fpath, "arba_plug_service_registry_tests"));
+    plug::service_registry registry;
+    registry.add(concat);
+    registry.add(concat_copy);
+    ASSERT_TRUE(registry.remove(concat));
+    ASSERT_FALSE(registry.remove(concat));
+    ASSERT_EQ(registry.providers<ConcatInterface>().size(), 1);
+    ASSERT_EQ(registry.providers<ConcatInterface>().front().plugin, &concat_copy);
+    ASSERT_TRUE(registry.remove(concat_copy));
+    ASSERT_EQ(registry.interface_count(), 0);
+    ASSERT_TRUE(registry.providers<ConcatInterface>().empty());
+}
+
+TEST(ServiceRegistryTest, Clear_ExpectEmptyRegistry)
+{
+    plug::plugin concat(concat_plugin_fpath);
+    plug::service_registry registry;
+    registry.add(concat);
+    registry.clear();
+    ASSERT_EQ(registry.plugin_count(), 0);
+    ASSERT_TRUE(registry.providers<ConcatInterface>().empty());
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/signed_plugin.hpp>
+
+#include <concat_interface/concat_interface.hpp>
+
+#include <format>
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+// SignatureHash
+
+static_assert(plug::signature_hash<void (*)(int)>() == plug::signature_hash<void (*)(int)>());
+static_assert(plug::signature_hash<void (*)(int)>() != plug::signature_hash<void (*)(int&)>());
+static_assert(plug::signature_hash<void (*)(int)>() != plug::signature_hash<int (*)(int)>());
+
+// FindFunctionPtr
+
+TEST(SignedPluginTest, FindFunctionPtr_FunctionName_ReturnNotNullFunctionPtr)
+{
+    std::string res;
+    plug::signed_plugin plugin(plugin_fpath);
+    auto execute = plugin.find_function_ptr<void (*)(std::string&, std::string_view, const std::string&)>("execute");
+    ASSERT_NE(execute, nullptr);
+    execute(res, "a", "b");
+    ASSERT_EQ(res, "a-b");
+}
+
+TEST(SignedPluginTest, FindFunctionPtr_BadFunctionType_ExpectException)
+{
+    try
+    {
+        plug::signed_plugin plugin(plugin_fpath);
+        std::ignore = plugin.find_function_ptr<void (*)(float&)>("execute");
+        FAIL();
+    }
+    catch (const std::runtime_error& err)
+    {
+        std::string err_str(err.what());
+        ASSERT_TRUE(err_str.find("Function type of 'execute' is not the requested type function") != std::string::npos);
+    }
+}
+
+TEST(SignedPluginTest, FindFunctionPtr_UnregisteredFunction_ExpectException)
+{
+    plug::signed_plugin plugin(plugin_fpath);
+    ASSERT_THROW(std::ignore = plugin.find_function_ptr<int (*)(std::string_view)>("unregistered_function"),
+                 plug::plugin_find_symbol_error);
+}
+
+// MakeUniqueInstance
+
+TEST(SignedPluginTest, MakeUniqueInstance_FunctionTakingArgsExists_ReturnUniquePtr)
+{
+    plug::signed_plugin plugin(plugin_fpath);
+    std::string second_left_decorator = "<";
+    std::unique_ptr<ConcatInterface> concat =
+        plugin.make_unique_instance<ConcatInterface, std::string_view, std::string&, const std::string&>(
+            "make_unique_instance_from_args", "<", second_left_decorator, ">");
+    ASSERT_NE(concat, nullptr);
+    ASSERT_EQ(concat->concat("a", "b"), "<<a-b>");
+}
+
+// InstanceRef
+
+TEST(SignedPluginTest, InstanceRef_BadInstanceType_ExpectException)
+{
+    plug::signed_plugin plugin(plugin_fpath);
+    ASSERT_NO_THROW(std::ignore = plugin.instance_ref<ConcatInterface>("default_concat"));
+    ASSERT_THROW(std::ignore = plugin.instance_ref<std::string>("default_concat"), std::runtime_error);
+}
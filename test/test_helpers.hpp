@@ -0,0 +1,47 @@
+#pragma once
+
+#include <arba/plug/plugin_base.hpp>
+#include <arba/plug/plugin_dependency_graph.hpp>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Helpers shared by the tests.
+
+/**
+ * @brief copy_plugin Copy a plugin file into a directory, so it is loaded as another library.
+ * @param plugin_path The path to the plugin, without its extension.
+ * @return The path to the copy, with its extension.
+ */
+inline std::filesystem::path copy_plugin(const std::filesystem::path& plugin_path,
+                                         const std::filesystem::path& directory)
+{
+    std::filesystem::path source_path = plugin_path;
+    source_path += plug::plugin_file_extension;
+    const std::filesystem::path copy_path = directory / source_path.filename();
+    std::filesystem::copy_file(source_path, copy_path, std::filesystem::copy_options::overwrite_existing);
+    return copy_path;
+}
+
+/**
+ * @brief make_plugin_copy Copy a plugin file into a directory of the temporary directory, which is created if needed.
+ */
+inline std::filesystem::path make_plugin_copy(const std::filesystem::path& plugin_path,
+                                              std::string_view directory_name)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / directory_name;
+    std::filesystem::create_directories(directory);
+    return copy_plugin(plugin_path, directory);
+}
+
+inline plug::plugin_load_spec make_spec(std::string name, std::filesystem::path plugin_path = {},
+                                        std::vector<std::string> dependencies = {})
+{
+    plug::plugin_load_spec spec;
+    spec.name = std::move(name);
+    spec.plugin_path = std::move(plugin_path);
+    spec.dependencies = std::move(dependencies);
+    return spec;
+}
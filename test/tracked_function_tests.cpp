@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/tracked_function.hpp>
+
+#include <arba/plug/plugin.hpp>
+#include <arba/plug/safe_plugin.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+namespace
+{
+using run_until_released_function = void (*)(std::atomic_bool&, const std::atomic_bool&);
+using execute_function = void (*)(std::string&, std::string_view, const std::string&);
+} // namespace
+
+// BindTrackedFunction
+
+TEST(TrackedFunctionTest, BindTrackedFunction_FunctionName_ReturnCallableFunction)
+{
+    std::string res;
+    plug::plugin plugin(plugin_fpath);
+    plug::tracked_function execute = plugin.bind_tracked_function<execute_function>("execute");
+    ASSERT_TRUE(execute.is_callable());
+    execute(res, "a", "b");
+    ASSERT_EQ(res, "a-b");
+}
+
+TEST(TrackedFunctionTest, BindTrackedFunction_SafePluginBadFunctionType_ExpectException)
+{
+    plug::safe_plugin plugin(plugin_fpath);
+    ASSERT_THROW(std::ignore = plugin.bind_tracked_function<void (*)(float&)>("execute"), std::runtime_error);
+}
+
+TEST(TrackedFunctionTest, BindTrackedFunction_NotLoaded_ExpectException)
+{
+    plug::plugin plugin;
+    ASSERT_THROW(std::ignore = plugin.bind_tracked_function<execute_function>("execute"),
+                 plug::plugin_find_symbol_error);
+}
+
+// Call
+
+TEST(TrackedFunctionTest, Call_PluginUnloaded_ExpectException)
+{
+    std::string res;
+    plug::plugin plugin(plugin_fpath);
+    plug::tracked_function execute = plugin.bind_tracked_function<execute_function>("execute");
+    plugin.unload();
+    ASSERT_FALSE(execute.is_callable());
+    ASSERT_THROW(execute(res, "a", "b"), plug::plugin_unloaded_error);
+}
+
+TEST(TrackedFunctionTest, Call_PluginReloaded_ExpectException)
+{
+    std::string res;
+    plug::plugin plugin(plugin_fpath);
+    plug::tracked_function execute = plugin.bind_tracked_function<execute_function>("execute");
+    plugin.load_from_file(plugin_fpath);
+    ASSERT_THROW(execute(res, "a", "b"), plug::plugin_unloaded_error);
+}
+
+// Unload
+
+TEST(TrackedFunctionTest, Unload_CallInFlight_ExpectUnloadWaitsForCall)
+{
+    plug::plugin plugin(plugin_fpath);
+    plug::tracked_function run = plugin.bind_tracked_function<run_until_released_function>("run_until_released");
+    std::atomic_bool started = false;
+    std::atomic_bool released = false;
+    std::atomic_bool unloaded = false;
+    std::thread caller([&] { run(started, released); });
+    while (!started)
+        std::this_thread::yield();
+
+    std::thread unloader([&] {
+        plugin.unload();
+        unloaded = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_FALSE(unloaded);
+    released = true;
+    caller.join();
+    unloader.join();
+    ASSERT_TRUE(unloaded);
+}
+
+TEST(TrackedFunctionTest, UnloadInBackground_CallInFlight_ExpectNoWait)
+{
+    plug::plugin plugin(plugin_fpath);
+    plug::tracked_function run = plugin.bind_tracked_function<run_until_released_function>("run_until_released");
+    std::atomic_bool started = false;
+    std::atomic_bool released = false;
+    std::thread caller([&] { run(started, released); });
+    while (!started)
+        std::this_thread::yield();
+
+    plugin.unload_in_background();
+    ASSERT_FALSE(plugin.is_loaded());
+    ASSERT_FALSE(run.is_callable());
+    released = true;
+    caller.join();
+    plug::wait_for_background_unloads();
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+// class to test
+#include <arba/plug/unload_policy.hpp>
+
+#include <arba/plug/plugin.hpp>
+#include <arba/plug/tracked_function.hpp>
+
+#include <cstdlib>
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "test_helpers.hpp"
+
+std::filesystem::path plugin_fpath = PLUGIN_PATH;
+
+namespace
+{
+using execute_function = void (*)(std::string&, std::string_view, const std::string&);
+
+class UnloadPolicyTest : public testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        plug::wait_for_background_unloads();
+        plug::set_default_unload_policy(plug::plugin_unload_policy::close);
+    }
+};
+
+#if defined(__linux__)
+// Once armed, ends the process with the result of the close of a library, checked after the destruction of the
+// plugin with static storage defined after it.
+struct static_plugin_close_checker
+{
+    std::string library_path;
+
+    ~static_plugin_close_checker()
+    {
+        if (!library_path.empty())
+            _exit(dlopen(library_path.c_str(), RTLD_LAZY | RTLD_NOLOAD) == nullptr ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+};
+
+// Constructed before the background reaper, so destroyed after it is stopped.
+static_plugin_close_checker static_plugin_checker;
+plug::plugin static_plugin;
+#endif
+} // namespace
+
+TEST_F(UnloadPolicyTest, DefaultUnloadPolicy_NoPolicySet_ReturnClose)
+{
+    ASSERT_EQ(plug::default_unload_policy(), plug::plugin_unload_policy::close);
+}
+
+TEST_F(UnloadPolicyTest, Unload_DefaultKeepMapped_ExpectFunctionStillCallable)
+{
+    plug::set_default_unload_policy(plug::plugin_unload_policy::keep_mapped);
+    std::string res;
+    plug::plugin plugin(plugin_fpath);
+    const std::string library_path = plugin.plugin_path().generic_string();
+    execute_function execute = plugin.find_function_ptr<execute_function>("execute");
+    plugin.unload();
+    ASSERT_FALSE(plugin.is_loaded());
+    execute(res, "a", "b");
+    ASSERT_EQ(res, "a-b");
+#if defined(__linux__)
+    void* handle = dlopen(library_path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+    ASSERT_NE(handle, nullptr);
+    dlclose(handle);
+#endif
+}
+
+TEST_F(UnloadPolicyTest, Unload_PluginCloseInBackground_ExpectCallsRefused)
+{
+    std::string res;
+    const plug::plugin_load_options options{ .unload_policy = plug::plugin_unload_policy::close_in_background };
+    plug::plugin plugin(plugin_fpath, options);
+    plug::tracked_function execute = plugin.bind_tracked_function<execute_function>("execute");
+    plugin.unload();
+    ASSERT_FALSE(plugin.is_loaded());
+    ASSERT_THROW(execute(res, "a", "b"), plug::plugin_unloaded_error);
+    plug::wait_for_background_unloads();
+}
+
+TEST_F(UnloadPolicyTest, Unload_PluginCloseWithDefaultKeepMapped_ExpectPluginPolicyUsed)
+{
+    plug::set_default_unload_policy(plug::plugin_unload_policy::keep_mapped);
+    plug::plugin plugin(plugin_fpath, plug::plugin_load_options{ .unload_policy = plug::plugin_unload_policy::close });
+    plug::tracked_function execute = plugin.bind_tracked_function<execute_function>("execute");
+    ASSERT_NO_THROW(plugin.unload());
+    ASSERT_FALSE(execute.is_callable());
+}
+
+TEST_F(UnloadPolicyTest, Destructor_DefaultCloseInBackground_ExpectCallsRefused)
+{
+    plug::set_default_unload_policy(plug::plugin_unload_policy::close_in_background);
+    std::string res;
+    plug::tracked_function<execute_function> execute;
+    {
+        plug::plugin plugin(plugin_fpath);
+        execute = plugin.bind_tracked_function<execute_function>("execute");
+        execute(res, "a", "b");
+    }
+    ASSERT_EQ(res, "a-b");
+    ASSERT_THROW(execute(res, "a", "b"), plug::plugin_unloaded_error);
+}
+
+TEST_F(UnloadPolicyTest, LoadFromFile_AlreadyLoadedKeepMapped_ExpectOldFunctionStillCallable)
+{
+    std::string res;
+    const plug::plugin_load_options options{ .unload_policy = plug::plugin_unload_policy::keep_mapped };
+    plug::plugin plugin(plugin_fpath, options);
+    execute_function execute = plugin.find_function_ptr<execute_function>("execute");
+    plugin.load_from_file(plugin_fpath);
+    plugin.unload();
+    execute(res, "a", "b");
+    ASSERT_EQ(res, "a-b");
+}
+
+#if defined(__linux__)
+TEST_F(UnloadPolicyTest, Destructor_StaticPluginCloseInBackgroundAtExit_ExpectLibraryClosed)
+{
+    // A copy of the plugin, so the library is only loaded by the static plugin.
+    const std::filesystem::path plugin_path = make_plugin_copy(plugin_fpath, "arba_plug_unload_policy_tests");
+    const pid_t process_id = fork();
+    ASSERT_NE(process_id, -1);
+    if (process_id == 0)
+    {
+        static_plugin.load_from_file(
+            plugin_path, plug::plugin_load_options{ .unload_policy = plug::plugin_unload_policy::close_in_background });
+        static_plugin_checker.library_path = plugin_path.string();
+        plug::wait_for_background_unloads();
+        std::exit(EXIT_SUCCESS);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(process_id, &status, 0), process_id);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+}
+#endif